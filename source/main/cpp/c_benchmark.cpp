@@ -12,7 +12,12 @@
 #include "cbenchmark/private/c_benchmark_run.h"
 #include "cbenchmark/private/c_benchmark_runner.h"
 #include "cbenchmark/private/c_benchmark_complexity.h"
+#include "cbenchmark/private/c_benchmark_scaling.h"
+#include "cbenchmark/private/c_benchmark_compare.h"
+#include "cbenchmark/private/c_benchmark_cache.h"
+#include "cbenchmark/private/c_benchmark_checkpoint.h"
 #include "cbenchmark/private/c_benchmark_unit.h"
+#include "cbenchmark/private/c_process.h"
 #include "cbenchmark/private/c_time_helpers.h"
 #include "cbenchmark/private/c_stringbuilder.h"
 #include "cbenchmark/private/c_stdout.h"
@@ -66,21 +71,289 @@ namespace BenchMark
         XorRandom rng(seed);
         for (int i = 0; i < indices.Size(); ++i)
         {
-            s32 j = i + ((s32)rng.next() % (indices.Size() - i));
+            s32 j = i + (s32)(rng.next() % (u64)(indices.Size() - i));
             std::swap(indices[i], indices[j]);
         }
     }
 
-    static void RunBenchMarkInstances(Allocator* main_allocator, ForwardAllocator* forward_allocator, ScratchAllocator* scratch_allocator, BenchMarkGlobals* globals, const Array<BenchMarkInstance*>& benchmark_instances, BenchMarkReporter* reporter)
+    // Sharding of the benchmark instances over processes, see 'benchmark_shard_count' and 'benchmark_shard_workers'.
+    // A worker runs the instances of its shard and sends the runs to the coordinator, the coordinator does not run
+    // anything itself, it receives the runs of all shards and reports them in registration order.
+    struct Shards
+    {
+        s32           index;
+        s32           count;
+        bool          is_worker;
+        bool          is_coordinator;
+        ChildProcess  coordinator;        // Worker: the pipe to the coordinator
+        ChildProcess* workers;            // Coordinator: the pipe to the worker of every shard
+        s32           num_cores;          // The cores of a process that runs instances, what a thread sweep resolves
+        s32           num_physical_cores; // against, the coordinator and all the workers resolve it the same way
+
+        inline bool Runs(s32 shard) const { return is_coordinator || count <= 1 || shard == index; }
+    };
+
+    // The shard of an instance only depends on its full name, so it is the same in every process and every run.
+    static s32 ShardOf(const BenchMarkInstance* bmi, s32 count, ScratchAllocator* scratch)
+    {
+        if (count <= 1)
+            return 0;
+
+        USE_SCRATCH(scratch);
+
+        const s32   len  = bmi->name().FullNameLen();
+        char*       name = scratch->Alloc<char>(len + 1);
+        const char* end  = bmi->name().FullName(name, name + len);
+
+        const u64 hash = gHash(kHashSeed, name, end - name);
+
+        scratch->Deallocate(name);
+        return (s32)(hash % (u64)count);
+    }
+
+    static void DestroyRunResults(ForwardAllocator* forward_allocator, RunResults* results)
+    {
+        // Destroy the reports
+        for (int i = 0; i < results->non_aggregates.Size(); ++i)
+        {
+            results->non_aggregates[i]->Reset();
+            forward_allocator->Destruct(results->non_aggregates[i]);
+        }
+        for (int i = 0; i < results->aggregates_only.Size(); ++i)
+        {
+            results->aggregates_only[i]->Reset();
+            forward_allocator->Destruct(results->aggregates_only[i]);
+        }
+        forward_allocator->Destruct(results);
+    }
+
+    // Runs the repetitions [begin, end) in a forked child process, every run is sent to the parent as soon as it is done.
+    static void RunRepetitionsInChild(ChildProcess& child, ForwardAllocator* forward_allocator, ScratchAllocator* scratch_allocator, const Array<BenchMarkRunner*>& runners, const Array<s32>& repetition_indices, s32 begin, s32 end)
+    {
+        for (s32 i = begin; i < end; ++i)
+        {
+            BenchMarkRunner* runner = runners[repetition_indices[i]];
+
+            BenchMarkRun report;
+            DoOneRepetition(runner, forward_allocator, scratch_allocator, &report, nullptr);
+            SendRepetition(child, scratch_allocator, &report);
+            report.Reset();
+        }
+        gExitChild(child);
+    }
+
+    // What the reports that follow a unit (scaling, latency curves) need of an instance, the runs of an
+    // instance are destroyed once they are reported.
+    struct InstanceSummary
+    {
+        double throughput;   // Iterations per second of real time
+        double latency_p50;  // Open loop, latency percentiles (seconds)
+        double latency_p99;  //
+        double latency_p999; //
+    };
+
+    // The mean over the repetitions of an instance, all 0 when none of them ran
+    static InstanceSummary Summarize(Array<BenchMarkRun*> const& runs)
+    {
+        InstanceSummary summary = {0.0, 0.0, 0.0, 0.0};
+        s32             n       = 0;
+        for (s32 i = 0; i < runs.Size(); ++i)
+        {
+            const BenchMarkRun* run = runs[i];
+            if (run->run_type != BenchMarkRun::RT_Iteration || run->skipped.IsSkipped() || run->real_accumulated_time <= 0.0)
+                continue;
+            summary.throughput += (double)run->iterations / run->real_accumulated_time;
+            summary.latency_p50 += run->latency_p50;
+            summary.latency_p99 += run->latency_p99;
+            summary.latency_p999 += run->latency_p999;
+            n += 1;
+        }
+        if (n > 1)
+        {
+            summary.throughput /= n;
+            summary.latency_p50 /= n;
+            summary.latency_p99 /= n;
+            summary.latency_p999 /= n;
+        }
+        return summary;
+    }
+
+    static bool SameArgs(Array<s64> const* a, Array<s64> const* b)
+    {
+        if (a->Size() != b->Size())
+            return false;
+        for (s32 i = 0; i < a->Size(); ++i)
+        {
+            if ((*a)[i] != (*b)[i])
+                return false;
+        }
+        return true;
+    }
+
+    // Instances 'i' and 'j' are of the same member of an A/B group (see BM_COMPARE), or there is no group
+    static bool SameMember(Array<s32> const* member, s32 i, s32 j) { return member == nullptr || (*member)[i] == (*member)[j]; }
+
+    static void ReportRows(ForwardAllocator* forward_allocator, ScratchAllocator* scratch_allocator, Array<BenchMarkRun*>& rows, BenchMarkReporter* reporter)
+    {
+        if (!rows.Empty())
+            reporter->ReportRuns(rows, forward_allocator, scratch_allocator);
+
+        for (s32 i = 0; i < rows.Size(); ++i)
+        {
+            rows[i]->Reset();
+            forward_allocator->Destruct(rows[i]);
+        }
+        rows.Clear();
+    }
+
+    // Report the scaling of every family of a unit, a family being the (closed loop) instances of a member with the same
+    // arguments and in-flight depth.
+    static void ReportScaling(ForwardAllocator* forward_allocator, ScratchAllocator* scratch_allocator, const Array<BenchMarkInstance*>& benchmark_instances, Array<s32> const* member, const Array<InstanceSummary>& summaries, BenchMarkReporter* reporter)
     {
         USE_SCRATCH(scratch_allocator);
 
-        // Note the file_reporter can be null.
-        BM_CHECK(reporter != nullptr);
+        const s32 num_instances = benchmark_instances.Size();
+
+        Array<BenchmarkName const*> names;
+        Array<s64>                  threads;
+        Array<double>               family_throughput;
+        names.Init(scratch_allocator, 0, num_instances);
+        threads.Init(scratch_allocator, 0, num_instances);
+        family_throughput.Init(scratch_allocator, 0, num_instances);
+
+        Array<BenchMarkRun*> rows;
+        rows.Init(scratch_allocator, 0, num_instances);
+
+        for (s32 i = 0; i < num_instances; ++i)
+        {
+            const BenchMarkInstance* first = benchmark_instances[i];
+            if (first->threads() != 1 || first->arrival_rate() > 0.0)
+                continue;
+
+            names.Clear();
+            threads.Clear();
+            family_throughput.Clear();
+            for (s32 j = 0; j < num_instances; ++j)
+            {
+                const BenchMarkInstance* instance = benchmark_instances[j];
+                if (instance->arrival_rate() <= 0.0 && instance->inflight() == first->inflight() && SameArgs(first->args(), instance->args()) && SameMember(member, i, j))
+                {
+                    names.PushBack(&instance->name());
+                    threads.PushBack(instance->threads());
+                    family_throughput.PushBack(summaries[j].throughput);
+                }
+            }
+            ComputeScaling(forward_allocator, scratch_allocator, names, threads, family_throughput, rows);
+        }
+
+        // The rows of the thread counts first and then the rows of the fits, so that each gets a single header
+        Array<BenchMarkRun*> fits;
+        fits.Init(scratch_allocator, 0, rows.Size());
+        s32 num_speedups = 0;
+        for (s32 i = 0; i < rows.Size(); ++i)
+        {
+            if (rows[i]->counters.Size() == 0)
+                rows[num_speedups++] = rows[i];
+            else
+                fits.PushBack(rows[i]);
+        }
+        for (s32 i = 0; i < fits.Size(); ++i)
+            rows[num_speedups + i] = fits[i];
+        fits.Release();
+
+        ReportRows(forward_allocator, scratch_allocator, rows, reporter);
+        rows.Release();
+        names.Release();
+        threads.Release();
+        family_throughput.Release();
+    }
 
+    // Report the throughput versus latency curve of every open loop family of a unit, a family being the instances
+    // of a member with the same arguments, thread count and in-flight depth. The curve has a row per arrival rate.
+    static void ReportLatencyCurves(ForwardAllocator* forward_allocator, ScratchAllocator* scratch_allocator, const Array<BenchMarkInstance*>& benchmark_instances, Array<s32> const* member, const Array<InstanceSummary>& summaries, BenchMarkReporter* reporter)
+    {
+        USE_SCRATCH(scratch_allocator);
+
+        const s32 num_instances = benchmark_instances.Size();
+
+        Array<bool> reported;
+        reported.Init(scratch_allocator, 0, num_instances);
+        for (s32 i = 0; i < num_instances; ++i)
+            reported.PushBack(false);
+
+        Array<BenchMarkRun*> rows;
+        rows.Init(scratch_allocator, 0, num_instances);
+
+        for (s32 i = 0; i < num_instances; ++i)
+        {
+            const BenchMarkInstance* first = benchmark_instances[i];
+            if (reported[i] || first->arrival_rate() <= 0.0)
+                continue;
+
+            // A single rate is not a curve
+            s32 rates = 0;
+            for (s32 j = 0; j < num_instances; ++j)
+            {
+                const BenchMarkInstance* instance = benchmark_instances[j];
+                if (instance->arrival_rate() > 0.0 && instance->threads() == first->threads() && instance->inflight() == first->inflight() && SameArgs(first->args(), instance->args()) && SameMember(member, i, j))
+                    ++rates;
+            }
+            if (rates < 2)
+                continue;
+
+            // The rates of the family in ascending order
+            for (;;)
+            {
+                s32 next = -1;
+                for (s32 j = 0; j < num_instances; ++j)
+                {
+                    const BenchMarkInstance* instance = benchmark_instances[j];
+                    if (reported[j] || instance->arrival_rate() <= 0.0 || instance->threads() != first->threads() || instance->inflight() != first->inflight() || !SameArgs(first->args(), instance->args()) || !SameMember(member, i, j))
+                        continue;
+                    if (next < 0 || instance->arrival_rate() < benchmark_instances[next]->arrival_rate())
+                        next = j;
+                }
+                if (next < 0)
+                    break;
+                reported[next] = true;
+
+                const BenchMarkInstance* instance = benchmark_instances[next];
+                const InstanceSummary&   summary  = summaries[next];
+
+                BenchMarkRun*& row    = rows.Alloc();
+                row                   = forward_allocator->Construct<BenchMarkRun>();
+                row->run_name         = instance->name();
+                row->run_type         = BenchMarkRun::RT_Aggregate;
+                row->aggregate_name   = "curve";
+                row->repetition_index = BenchMarkRun::no_repetition_index;
+                row->threads          = instance->threads();
+                row->iterations       = 0;
+                row->time_unit        = instance->time_unit();
+                row->report_curve     = true;
+
+                // Rates print as '/s', the latencies are times in the time unit of the instance
+                const double multiplier = instance->time_unit().GetTimeUnitMultiplier();
+                row->counters.Initialize(forward_allocator, 5);
+                row->counters.counters.PushBack({"offered", {CounterFlags::IsRate}, instance->arrival_rate()});
+                row->counters.counters.PushBack({"achieved", {CounterFlags::IsRate}, summary.throughput});
+                row->counters.counters.PushBack({"p50", {CounterFlags::Defaults}, summary.latency_p50 * multiplier});
+                row->counters.counters.PushBack({"p99", {CounterFlags::Defaults}, summary.latency_p99 * multiplier});
+                row->counters.counters.PushBack({"p99.9", {CounterFlags::Defaults}, summary.latency_p999 * multiplier});
+            }
+        }
+
+        ReportRows(forward_allocator, scratch_allocator, rows, reporter);
+        rows.Release();
+        reported.Release();
+    }
+
+    // The context of the table of the instances of a unit, 'table' is the table the runs are added to and the width
+    // of the name field is at least that.
+    static BenchMarkReporter::Context ContextOf(BenchMarkGlobals const* globals, const Array<BenchMarkInstance*>& benchmark_instances, BenchMarkReporter::Context const& table)
+    {
         // Determine the width of the name field using a minimum width of 10.
         bool might_have_aggregates = globals->benchmark_repetitions > 1;
-        s32  name_field_width      = 10;
+        s32  name_field_width      = max<s32>(10, table.name_field_width);
         s32  stat_field_width      = 0;
         for (int i = 0; i < benchmark_instances.Size(); ++i)
         {
@@ -98,9 +371,179 @@ namespace BenchMark
         if (might_have_aggregates)
             name_field_width += 1 + stat_field_width;
 
-        // Print header here
         BenchMarkReporter::Context context;
         context.name_field_width = name_field_width;
+        context.continue_table   = table.continue_table;
+        return context;
+    }
+
+    // The instance of the baseline (the first member) of an A/B group that instance 'i' is compared with, or -1
+    static s32 ComparedBaseline(const Array<BenchMarkInstance*>& benchmark_instances, Array<s32> const& member, s32 i)
+    {
+        if (member[i] == 0)
+            return i;
+
+        const BenchMarkInstance* instance = benchmark_instances[i];
+        for (s32 j = 0; j < benchmark_instances.Size(); ++j)
+        {
+            const BenchMarkInstance* baseline = benchmark_instances[j];
+            if (member[j] == 0 && baseline->threads() == instance->threads() && baseline->arrival_rate() == instance->arrival_rate() && baseline->inflight() == instance->inflight() && SameArgs(baseline->args(), instance->args()))
+                return j;
+        }
+        return -1;
+    }
+
+    // The repetitions of the instances of an A/B group that are compared run in rounds, one repetition of every
+    // member per round. The order of the members alternates every round (A B, B A, A B, ...), so that neither of
+    // them always runs first (warm caches, frequency ramp up). Instances without a counterpart run after that.
+    static void InterleaveComparedRepetitions(const Array<BenchMarkInstance*>& benchmark_instances, Array<s32> const& member, const Array<BenchMarkRunner*>& runners, Array<s32>& repetition_indices, ScratchAllocator* scratch_allocator)
+    {
+        USE_SCRATCH(scratch_allocator);
+
+        const s32 num_instances = benchmark_instances.Size();
+
+        Array<bool> placed;
+        placed.Init(scratch_allocator, 0, num_instances);
+        for (s32 i = 0; i < num_instances; ++i)
+            placed.PushBack(false);
+
+        Array<s32> group;
+        group.Init(scratch_allocator, 0, num_instances);
+
+        for (s32 b = 0; b < num_instances; ++b)
+        {
+            if (member[b] != 0)
+                continue;
+
+            // The instances are in the order of the members
+            group.Clear();
+            s64 rounds = 0;
+            for (s32 i = 0; i < num_instances; ++i)
+            {
+                if (!placed[i] && ComparedBaseline(benchmark_instances, member, i) == b)
+                {
+                    group.PushBack(i);
+                    placed[i] = true;
+                    rounds    = max<s64>(rounds, GetNumRepeats(runners[i]));
+                }
+            }
+
+            for (s64 r = 0; r < rounds; ++r)
+            {
+                for (s32 k = 0; k < group.Size(); ++k)
+                {
+                    const s32 i = group[(r & 1) == 0 ? k : group.Size() - 1 - k];
+                    if (r < GetNumRepeats(runners[i]))
+                        repetition_indices.PushBack(i);
+                }
+            }
+        }
+
+        for (s32 i = 0; i < num_instances; ++i)
+        {
+            if (placed[i])
+                continue;
+            s64 n = GetNumRepeats(runners[i]);
+            while (n--)
+                repetition_indices.PushBack(i);
+        }
+
+        group.Release();
+        placed.Release();
+    }
+
+    // Report the comparison of every instance of an A/B group with its baseline, see ComputeComparison
+    static void ReportComparison(ForwardAllocator* forward_allocator, ScratchAllocator* scratch_allocator, const Array<BenchMarkInstance*>& benchmark_instances, Array<s32> const& member, Array<s32> const& repetition_offsets, Array<double> const& repetition_times, const Array<BenchMarkRunner*>& runners, BenchMarkReporter* reporter)
+    {
+        USE_SCRATCH(scratch_allocator);
+
+        const s32 num_instances = benchmark_instances.Size();
+
+        Array<BenchMarkRun*> rows;
+        rows.Init(scratch_allocator, 0, num_instances);
+
+        for (s32 i = 0; i < num_instances; ++i)
+        {
+            const s32 b = ComparedBaseline(benchmark_instances, member, i);
+            if (b < 0 || b == i)
+                continue;
+
+            const double* baseline  = &repetition_times[repetition_offsets[b]];
+            const double* candidate = &repetition_times[repetition_offsets[i]];
+            ComputeComparison(forward_allocator, benchmark_instances[i]->name(), baseline, (s32)GetNumRepeats(runners[b]), candidate, (s32)GetNumRepeats(runners[i]), rows);
+        }
+
+        ReportRows(forward_allocator, scratch_allocator, rows, reporter);
+        rows.Release();
+    }
+
+    // The runs of an instance from the result cache, they complete the runner as if its repetitions ran.
+    // Returns false if the cache does not have (all) the runs of the instance.
+    static bool RunFromCache(ResultCache* cache, u64 key, ForwardAllocator* forward_allocator, ScratchAllocator* scratch_allocator, BenchMarkRunner* runner, RunResults* results, BenchMarkReporter::PerFamilyRunReports* reports_for_family)
+    {
+        if (cache == nullptr || key == 0)
+            return false;
+        if (!cache->Load(key, forward_allocator, scratch_allocator, GetNumRepeats(runner), results->non_aggregates))
+            return false;
+
+        for (s32 r = 0; r < results->non_aggregates.Size(); ++r)
+            ReplayRepetition(runner, forward_allocator, results->non_aggregates[r], reports_for_family);
+
+        AggregateResults(runner, forward_allocator, scratch_allocator, results->non_aggregates, results->aggregates_only);
+        for (s32 r = 0; r < results->aggregates_only.Size(); ++r)
+            results->aggregates_only[r]->cached = true;
+        return true;
+    }
+
+    // Reports the instances before 'end' with their runs from the result cache, 'next' is the first instance that was
+    // not looked at yet. A cached instance is reported where it would have completed if it ran, so that the rows of a
+    // run with a result cache are in the same order as those of a run without.
+    // With 'keep_runs' the runs are not destroyed, the complexity is computed over them at the end of the unit.
+    static void ReportCached(BenchMarkReporter* reporter, ForwardAllocator* forward_allocator, ScratchAllocator* scratch_allocator, const Array<BenchMarkRunner*>& runners, Array<RunResults*>& run_results, const Array<bool>& cached, Array<InstanceSummary>& summaries, bool keep_runs, s32& next, s32 end)
+    {
+        for (; next < end && next < cached.Size(); ++next)
+        {
+            if (!cached[next])
+                continue;
+
+            BenchMarkRunner* runner = runners[next];
+            reporter->ReportRunsConfig(GetMinTime(runner), HasExplicitIters(runner), GetIters(runner), forward_allocator, scratch_allocator);
+            Report(reporter, run_results[next], forward_allocator, scratch_allocator);
+            summaries[next] = Summarize(run_results[next]->non_aggregates);
+            if (!keep_runs)
+            {
+                DestroyRunResults(forward_allocator, run_results[next]);
+                run_results[next] = nullptr;
+            }
+        }
+    }
+
+    // Stores the runs of an instance that completed in the result cache, unless one of its repetitions was skipped
+    static void StoreInCache(ResultCache* cache, u64 key, ScratchAllocator* scratch_allocator, RunResults const* results)
+    {
+        if (cache == nullptr || key == 0)
+            return;
+        for (s32 r = 0; r < results->non_aggregates.Size(); ++r)
+        {
+            if (!results->non_aggregates[r]->skipped.IsNotSkipped())
+                return;
+        }
+        cache->Store(key, scratch_allocator, results->non_aggregates);
+    }
+
+    // 'table' is the context of the table the runs are added to, see ContextOf.
+    // 'compare' is not null for the units of an A/B group, it holds the member of the group of every instance.
+    // 'cache' is not null when there is a result cache, the runs of A/B groups are not cached.
+    // 'checkpoint' is not null when the session is checkpointed, see Checkpoint.
+    static void RunBenchMarkInstances(Allocator* main_allocator, ForwardAllocator* forward_allocator, ScratchAllocator* scratch_allocator, BenchMarkGlobals* globals, Shards* shards, ResultCache* cache, Checkpoint* checkpoint, const Array<BenchMarkInstance*>& benchmark_instances, BenchMarkReporter::Context const& table, Array<s32> const* compare, BenchMarkReporter* reporter)
+    {
+        USE_SCRATCH(scratch_allocator);
+
+        // Note the file_reporter can be null.
+        BM_CHECK(reporter != nullptr);
+
+        // Print header here
+        const BenchMarkReporter::Context context = ContextOf(globals, benchmark_instances, table);
 
         BenchMarkReporter::PerFamilyRunReports* reports_for_family = nullptr;
         if (!benchmark_instances[0]->complexity().Is(BigO::O_None))
@@ -108,7 +551,8 @@ namespace BenchMark
             reports_for_family = scratch_allocator->Construct<BenchMarkReporter::PerFamilyRunReports>();
         }
 
-        if (reporter->ReportBegin(context, forward_allocator, scratch_allocator))
+        // A worker does not report, it sends its runs to the coordinator
+        if (shards->is_worker || reporter->ReportBegin(context, forward_allocator, scratch_allocator))
         {
             USE_SCRATCH(scratch_allocator);
 
@@ -119,6 +563,13 @@ namespace BenchMark
             Array<RunResults*> run_results;
             run_results.Init(scratch_allocator, 0, benchmark_instances.Size());
 
+            Array<s32> runner_shards;
+            runner_shards.Init(scratch_allocator, 0, benchmark_instances.Size());
+
+            // What the reports after the unit need of every instance, see InstanceSummary
+            Array<InstanceSummary> summaries;
+            summaries.Init(scratch_allocator, 0, benchmark_instances.Size());
+
             // Count the number of benchmark_instances with threads to warn the user in case
             // performance counters are used.
             s64 num_repetitions_total   = 0;
@@ -146,86 +597,247 @@ namespace BenchMark
                 InitRunResults(runner, globals, results);
 
                 run_results.PushBack(results);
+                summaries.PushBack({0.0, 0.0, 0.0, 0.0});
+                // The members of an A/B group run in the shard of their baseline, so that the pairs run on the same cores
+                const s32 baseline = compare != nullptr ? ComparedBaseline(benchmark_instances, *compare, i) : i;
+                runner_shards.PushBack(ShardOf(benchmark_instances[baseline >= 0 ? baseline : i], shards->count, scratch_allocator));
             }
             ASSERTS(runners.Size() == benchmark_instances.Size(), "Unexpected runner count.");
 
+            // The complexity is computed over the runs of all the instances
+            if (reports_for_family)
+                reports_for_family->runs.Init(forward_allocator, 0, reports_for_family->num_runs_total);
+
+            // Instances with their runs in the result cache do not run, they are reported in between the others in
+            // instance order (see ReportCached)
+            Array<u64>  cache_keys;
+            Array<bool> cached;
+            s32         next_cached = 0;
+            if (cache != nullptr && compare == nullptr)
+            {
+                cache_keys.Init(scratch_allocator, 0, runners.Size());
+                cached.Init(scratch_allocator, 0, runners.Size());
+                for (s32 i = 0; i < runners.Size(); ++i)
+                {
+                    cache_keys.PushBack(cache->KeyOf(scratch_allocator, globals, benchmark_instances[i]));
+                    cached.PushBack(RunFromCache(cache, cache_keys[i], forward_allocator, scratch_allocator, runners[i], run_results[i], reports_for_family));
+                    if (cached[i])
+                        num_repetitions_total -= GetNumRepeats(runners[i]);
+                }
+            }
+
             Array<s32> repetition_indices;
             repetition_indices.Init(scratch_allocator, 0, num_repetitions_total);
 
-            for (s32 runner_index = 0, num_runners = runners.Size(); runner_index != num_runners; ++runner_index)
+            if (compare != nullptr)
+            {
+                InterleaveComparedRepetitions(benchmark_instances, *compare, runners, repetition_indices, scratch_allocator);
+            }
+            else
             {
-                const BenchMarkRunner* runner = runners[runner_index];
-                s32                    i      = GetNumRepeats(runner);
-                while (i--)
-                    repetition_indices.PushBack(runner_index);
+                for (s32 runner_index = 0, num_runners = runners.Size(); runner_index != num_runners; ++runner_index)
+                {
+                    const BenchMarkRunner* runner = runners[runner_index];
+                    s32                    i      = HasRepeatsRemaining(runner) ? GetNumRepeats(runner) : 0;
+                    while (i--)
+                        repetition_indices.PushBack(runner_index);
+                }
             }
             ASSERTS(repetition_indices.Size() == num_repetitions_total, "Unexpected number of repetition indexes.");
 
-            if (globals->benchmark_enable_random_interleaving)
+            s32 isolation = globals->benchmark_isolation;
+            if (!gCanForkProcess() || shards->is_coordinator)
+                isolation = BenchMarkIsolation::None;
+
+            // The repetitions of an A/B group are interleaved, so they can only share a process with all the others
+            if (compare != nullptr && isolation == BenchMarkIsolation::Instance)
+                isolation = BenchMarkIsolation::Unit;
+
+            // When every instance runs in its own process the repetitions of an instance have to stay together
+            if (globals->benchmark_enable_random_interleaving && isolation != BenchMarkIsolation::Instance && compare == nullptr)
             {
                 RandomShuffle(repetition_indices, (u64)globals->benchmark_random_interleaving_seed);
             }
 
+            // A/B group, the time per iteration of every repetition of every instance (see ComputeComparison)
+            Array<s32>    repetition_offsets;
+            Array<double> repetition_times;
+            if (compare != nullptr)
+            {
+                repetition_offsets.Init(scratch_allocator, 0, runners.Size());
+                repetition_times.Init(scratch_allocator, (s32)num_repetitions_total, (s32)num_repetitions_total);
+                s32 offset = 0;
+                for (s32 i = 0; i < runners.Size(); ++i)
+                {
+                    repetition_offsets.PushBack(offset);
+                    offset += (s32)GetNumRepeats(runners[i]);
+                }
+                for (s32 i = 0; i < repetition_times.Size(); ++i)
+                    repetition_times[i] = 0.0;
+            }
+
+            // A/B group, single threaded instances all run on the same core (the child processes inherit this)
+            bool pinned = false;
+            if (compare != nullptr && !shards->is_coordinator)
+            {
+                bool single_threaded = true;
+                for (s32 i = 0; i < benchmark_instances.Size(); ++i)
+                    single_threaded = single_threaded && benchmark_instances[i]->threads() == 1;
+                pinned = single_threaded && gPinThread(0);
+            }
+
+            // Drop the repetitions of instances that are run by another shard, this is done after the shuffle
+            // so that the coordinator and the workers see the repetitions of a shard in the same order.
+            if (shards->count > 1 && !shards->is_coordinator)
+            {
+                s32 n = 0;
+                for (s32 i = 0; i < repetition_indices.Size(); ++i)
+                {
+                    if (shards->Runs(runner_shards[repetition_indices[i]]))
+                        repetition_indices[n++] = repetition_indices[i];
+                }
+                while (repetition_indices.Size() > n)
+                    repetition_indices.PopBack();
+            }
+
+            ChildProcess child;
+            child.pid = -1;
+            child.fd  = -1;
+
             for (s32 i = 0; i < repetition_indices.Size(); ++i)
             {
                 const s32        repetition_index = repetition_indices[i];
                 BenchMarkRunner* runner           = runners[repetition_index];
                 RunResults*      results          = run_results[repetition_index];
 
+                ReportCached(reporter, forward_allocator, scratch_allocator, runners, run_results, cached, summaries, reports_for_family != nullptr, next_cached, repetition_index);
+
                 BenchMarkRun*& report = results->non_aggregates.Alloc();
                 report                = forward_allocator->Construct<BenchMarkRun>();
 
-                DoOneRepetition(runner, forward_allocator, scratch_allocator, report, reports_for_family);
+                // A repetition that completed before the session was interrupted
+                const bool replayed = checkpoint != nullptr && checkpoint->Replay(forward_allocator, scratch_allocator, benchmark_instances[repetition_index], report);
+
+                if (!replayed && isolation != BenchMarkIsolation::None && child.pid < 0)
+                {
+                    // The child runs the rest of the unit, or the rest of this instance
+                    s32 end = i + 1;
+                    if (isolation == BenchMarkIsolation::Unit)
+                        end = repetition_indices.Size();
+                    else
+                        while (end < repetition_indices.Size() && repetition_indices[end] == repetition_index)
+                            ++end;
+
+                    if (gForkProcess(child) == 0)
+                        RunRepetitionsInChild(child, forward_allocator, scratch_allocator, runners, repetition_indices, i, end);
+                }
+
+                if (replayed)
+                {
+                    ReplayRepetition(runner, forward_allocator, report, reports_for_family);
+                }
+                else if (shards->is_coordinator)
+                {
+                    ReceiveRepetition(runner, shards->workers[runner_shards[repetition_index]], forward_allocator, scratch_allocator, report, reports_for_family);
+                }
+                else if (child.pid < 0)
+                {
+                    // Not isolated, or the child process could not be created
+                    DoOneRepetition(runner, forward_allocator, scratch_allocator, report, reports_for_family);
+                }
+                else
+                {
+                    // A child that crashed only fails the repetition it was running, the repetitions it did not get
+                    // to are run by a new child
+                    const bool received = ReceiveRepetition(runner, child, forward_allocator, scratch_allocator, report, reports_for_family);
+                    if (!received || (isolation == BenchMarkIsolation::Instance && !HasRepeatsRemaining(runner)))
+                        gWaitForChild(child);
+                }
+
+                if (shards->is_worker)
+                    SendRepetition(shards->coordinator, scratch_allocator, report);
+                if (checkpoint != nullptr && !replayed)
+                    checkpoint->Record(scratch_allocator, benchmark_instances[repetition_index], report);
+
                 if (HasRepeatsRemaining(runner))
                     continue;
 
-                reporter->ReportRunsConfig(GetMinTime(runner), HasExplicitIters(runner), GetIters(runner), forward_allocator, scratch_allocator);
+                if (!shards->is_worker)
+                {
+                    reporter->ReportRunsConfig(GetMinTime(runner), HasExplicitIters(runner), GetIters(runner), forward_allocator, scratch_allocator);
 
-                AggregateResults(runner, forward_allocator, scratch_allocator, results->non_aggregates, results->aggregates_only);
+                    AggregateResults(runner, forward_allocator, scratch_allocator, results->non_aggregates, results->aggregates_only);
+                    if (!cache_keys.Empty())
+                        StoreInCache(cache, cache_keys[repetition_index], scratch_allocator, results);
 
-                // Maybe calculate complexity report
-                if (reports_for_family != nullptr)
-                {
-                    if (reports_for_family->num_runs_done == reports_for_family->num_runs_total)
-                    {
-                        USE_SCRATCH(scratch_allocator);
+                    Report(reporter, results, forward_allocator, scratch_allocator);
 
-                        Array<BenchMarkRun*> additional_run_stats;
-                        additional_run_stats.Init(scratch_allocator, 0, 2);
-                        ComputeBigO(forward_allocator, scratch_allocator, reports_for_family->runs, additional_run_stats);
+                    summaries[repetition_index] = Summarize(results->non_aggregates);
 
-                        // run_results->aggregates_only.insert(run_results->aggregates_only.end(), additional_run_stats.begin(), additional_run_stats.end());
-                        for (int i = 0; i < additional_run_stats.Size(); ++i)
-                            results->aggregates_only.PushBack(additional_run_stats[i]);
+                    if (compare != nullptr)
+                    {
+                        double*   times = &repetition_times[repetition_offsets[repetition_index]];
+                        const s32 count = (s32)GetNumRepeats(runner);
+                        for (s32 r = 0; r < results->non_aggregates.Size() && r < count; ++r)
+                        {
+                            const BenchMarkRun* run = results->non_aggregates[r];
+                            if (run->run_type == BenchMarkRun::RT_Iteration && run->skipped.IsNotSkipped() && run->iterations > 0)
+                                times[r] = run->real_accumulated_time / (double)run->iterations;
+                        }
                     }
                 }
 
-                Report(reporter, results, forward_allocator, scratch_allocator);
-
-                // Destroy the reports
-                for (int i = 0; i < results->non_aggregates.Size(); ++i)
+                // The complexity of the unit is computed over the runs of all its instances, they are kept until the end
+                if (reports_for_family == nullptr)
                 {
-                    results->non_aggregates[i]->Reset();
-                    forward_allocator->Destruct(results->non_aggregates[i]);
+                    DestroyRunResults(forward_allocator, results);
+                    run_results[repetition_index] = nullptr;
                 }
-                for (int i = 0; i < results->aggregates_only.Size(); ++i)
-                {
-                    results->aggregates_only[i]->Reset();
-                    forward_allocator->Destruct(results->aggregates_only[i]);
-                }
-                forward_allocator->Destruct(results);
             }
 
-            reporter->ReportEnd(forward_allocator);
+            ReportCached(reporter, forward_allocator, scratch_allocator, runners, run_results, cached, summaries, reports_for_family != nullptr, next_cached, runners.Size());
 
-            // Destroy the run results array
-            run_results.Release();
+            // The complexity over the runs of all the instances, run or from the result cache, after the last of them
+            if (reports_for_family != nullptr && !shards->is_worker && reports_for_family->num_runs_done == reports_for_family->num_runs_total)
+            {
+                USE_SCRATCH(scratch_allocator);
+
+                Array<BenchMarkRun*> additional_run_stats;
+                additional_run_stats.Init(scratch_allocator, 0, 2);
+                ComputeBigO(forward_allocator, scratch_allocator, reports_for_family->runs, additional_run_stats);
+                ReportRows(forward_allocator, scratch_allocator, additional_run_stats, reporter);
+                additional_run_stats.Release();
+            }
+
+            // Instances that were run by another shard never complete, or their runs were kept for the complexity
+            for (s32 i = 0; i < run_results.Size(); ++i)
+            {
+                if (run_results[i] != nullptr)
+                    DestroyRunResults(forward_allocator, run_results[i]);
+            }
+
+            if (child.pid >= 0)
+                gWaitForChild(child);
+            if (pinned)
+                gUnpinThread();
 
-            // Destroy the reports for family
-            if (reports_for_family != nullptr)
+            if (!shards->is_worker)
             {
-                scratch_allocator->Destruct(reports_for_family);
+                ReportScaling(forward_allocator, scratch_allocator, benchmark_instances, compare, summaries, reporter);
+                ReportLatencyCurves(forward_allocator, scratch_allocator, benchmark_instances, compare, summaries, reporter);
+                if (compare != nullptr)
+                    ReportComparison(forward_allocator, scratch_allocator, benchmark_instances, *compare, repetition_offsets, repetition_times, runners, reporter);
+                reporter->ReportEnd(forward_allocator);
             }
+            repetition_offsets.Release();
+            repetition_times.Release();
+            cached.Release();
+            cache_keys.Release();
+
+            // Destroy the run results array
+            run_results.Release();
+            runner_shards.Release();
+            summaries.Release();
 
             // Destroy all runners
             for (int i = 0; i < runners.Size(); ++i)
@@ -234,6 +846,12 @@ namespace BenchMark
             }
             runners.Release();
         }
+
+        // Destroy the reports for family, in the scope it was constructed in
+        if (reports_for_family != nullptr)
+        {
+            scratch_allocator->Destruct(reports_for_family);
+        }
     }
 
     // Permutations is determined by the number of inputs to repeat a benchmark on.
@@ -250,28 +868,69 @@ namespace BenchMark
         benchmark_instances.Release();
     }
 
-    static bool CreateBenchMarkInstances(ForwardAllocator* forward_allocator, ScratchAllocator* scratch_allocator, BenchMarkUnit* benchmark, Array<BenchMarkInstance*>& benchmark_instances)
+    // The thread counts of a ThreadSweep, resolved against the cores of the process that runs the instances
+    static void ResolveThreadSweep(s32 sweep, Shards const* shards, Array<s32>& thread_counts)
+    {
+        const s32 limit = (sweep & ThreadSweep::PhysicalCores) ? shards->num_physical_cores : shards->num_cores;
+        const s32 step  = (sweep & ThreadSweep::LinearSteps) ? max<s32>(1, sweep >> ThreadSweep::StepShift) : 0;
+
+        thread_counts.PushBack(1);
+        s32 t = step > 0 ? step : 2;
+        while (t < limit && thread_counts.Size() < thread_counts.Capacity() - 1)
+        {
+            if (t > 1)
+                thread_counts.PushBack(t);
+            t = step > 0 ? t + step : t * 2;
+        }
+        if (limit > 1)
+            thread_counts.PushBack(limit);
+    }
+
+    static bool CreateBenchMarkInstances(ForwardAllocator* forward_allocator, ScratchAllocator* scratch_allocator, Shards const* shards, BenchMarkUnit* benchmark, void const* suite_data, void const* fixture_data, Array<BenchMarkInstance*>& benchmark_instances)
     {
         USE_SCRATCH(scratch_allocator);
 
-        const Array<s32>& thread_counts     = benchmark->thread_counts_;
+        Array<s32> sweep;
+        if (benchmark->thread_sweep_ != ThreadSweep::None)
+        {
+            sweep.Init(scratch_allocator, 0, 64);
+            ResolveThreadSweep(benchmark->thread_sweep_, shards, sweep);
+        }
+
+        const Array<s32>& thread_counts     = sweep.Empty() ? benchmark->thread_counts_ : sweep;
         const s32         num_thread_counts = thread_counts.Empty() ? 1 : thread_counts.Size();
 
+        // An open loop has an instance per arrival rate, a closed loop has no rate
+        const Array<double>& arrival_rates     = benchmark->arrival_rates_;
+        const s32            num_arrival_rates = arrival_rates.Empty() ? 1 : arrival_rates.Size();
+
+        // An asynchronous unit has an instance per in-flight depth, a synchronous unit has no depth
+        const Array<s32>& inflight     = benchmark->inflight_;
+        const s32         num_inflight = inflight.Empty() ? 1 : inflight.Size();
+
         // Have BenchMarkUnit create the arguments for the instances
-        Array<Array<s32>> args;
+        Array<Array<s64>> args;
         const s32          perms = benchmark->BuildArgs(scratch_allocator, args);
-        benchmark_instances.Init(forward_allocator, 0, perms * num_thread_counts);
+        benchmark_instances.Init(forward_allocator, 0, perms * num_thread_counts * num_arrival_rates * num_inflight);
 
         for (s32 i = 0; i < num_thread_counts; ++i)
         {
-            for (s32 arg_index = 0; arg_index < perms; ++arg_index)
+            for (s32 r = 0; r < num_arrival_rates; ++r)
             {
-                const s32 num_threads = thread_counts.Empty() ? 1 : thread_counts[i];
+                for (s32 d = 0; d < num_inflight; ++d)
+                {
+                    for (s32 arg_index = 0; arg_index < perms; ++arg_index)
+                    {
+                        const s32    num_threads  = thread_counts.Empty() ? 1 : thread_counts[i];
+                        const double arrival_rate = arrival_rates.Empty() ? 0.0 : arrival_rates[r];
+                        const s32    depth        = inflight.Empty() ? 0 : inflight[d];
 
-                BenchMarkInstance* instance = forward_allocator->Construct<BenchMarkInstance>();
-                instance->initialize(forward_allocator, benchmark, args[arg_index], num_threads);
+                        BenchMarkInstance* instance = forward_allocator->Construct<BenchMarkInstance>();
+                        instance->initialize(forward_allocator, benchmark, args[arg_index], num_threads, arrival_rate, depth, suite_data, fixture_data);
 
-                benchmark_instances.PushBack(instance);
+                        benchmark_instances.PushBack(instance);
+                    }
+                }
             }
         }
 
@@ -280,6 +939,7 @@ namespace BenchMark
         for (s32 i = 0; i < args.Size(); ++i)
             args[i].Release();
         args.Release();
+        sweep.Release();
 
         return true;
     }
@@ -321,68 +981,638 @@ namespace BenchMark
         }
     }
 
-    // A benchmark-suite has a list of benchmark-fixtures where every fixture has a list of benchmark-units.
-    static void RunBenchMarkSuite(Allocator* main_allocator, ForwardAllocator* forward_allocator, ScratchAllocator* scratch_allocator, BenchMarkGlobals* globals, BenchMarkSuite* suite, BenchMarkReporter* reporter)
+    // The instantiations of a BM_UNIT_TEMPLATE are reported in one table. Their instance names only differ in the
+    // name of the type, the name field is made wide enough for the longest one.
+    static BenchMarkReporter::Context TableOf(BenchMarkFixture const* fixture, BenchMarkUnit const* unit, BenchMarkUnit const* previous, const Array<BenchMarkInstance*>& benchmark_instances)
     {
-        // Report the details of this benchmark suite ?
-        // - name / filename / line number
-        // - list
-        //   - fixture name(num units)
+        BenchMarkReporter::Context table;
+        if (unit->family == nullptr)
+            return table;
 
-        BenchMarkFixture* fixture = suite->head;
-        while (fixture != nullptr)
+        s32 longest = 0;
+        for (BenchMarkUnit const* u = fixture->head; u != nullptr; u = u->next)
         {
-            // Report the details of this fixture ?
-            // - name / filename / line number / num units
+            if (u->family == unit->family && !u->IsDisabled())
+                longest = max<s32>(longest, gStringLength(u->name));
+        }
 
-            if (fixture->disabled)
-            {
+        s32 width = 0;
+        for (s32 i = 0; i < benchmark_instances.Size(); ++i)
+            width = max<s32>(width, benchmark_instances[i]->name().FullNameLen());
+
+        table.name_field_width = width + longest - gStringLength(unit->name);
+        table.continue_table   = previous != nullptr && previous->family == unit->family;
+        return table;
+    }
+
+    static bool HasEnabledUnits(BenchMarkFixture const* fixture)
+    {
+        if (fixture->disabled)
+            return false;
+        for (BenchMarkUnit const* unit = fixture->head; unit != nullptr; unit = unit->next)
+        {
+            if (!unit->IsDisabled())
+                return true;
+        }
+        return false;
+    }
+
+    // Run the (suite or fixture) setup and report the time it took, this time is not part of any benchmark.
+    static void* RunSharedSetup(Allocator* main_allocator, ForwardAllocator* forward_allocator, ScratchAllocator* scratch_allocator, shared_setup_function setup, const char* name, BenchMarkReporter* reporter)
+    {
+        void* data = nullptr;
+        if (setup != nullptr)
+        {
+            const double start = RealTimeNow();
+            setup(main_allocator, data);
+            if (reporter != nullptr)
+                reporter->ReportSetup(name, RealTimeNow() - start, forward_allocator, scratch_allocator);
+        }
+        return data;
+    }
+
+    // Apply the settings for a benchmark unit, from Suite, Fixture and Unit, in two passes
+    static void ApplyUnitSettings(ForwardAllocator* forward_allocator, BenchMarkSuite const* suite, BenchMarkFixture const* fixture, BenchMarkUnit* unit)
+    {
+        for (s32 i = 0; i < 2; ++i)
+        {
+            switch (i)
+            {
+                case 0: unit->PrepareSettings(); break;
+                case 1: unit->ApplySettings(forward_allocator); break;
+            }
+            suite->settings(unit);
+            fixture->settings(unit);
+            unit->settings_(unit);
+        }
+    }
+
+    // The A/B group of a unit (see BM_COMPARE), only the first pass of the settings is needed for this
+    static const char* CompareGroupOf(BenchMarkSuite const* suite, BenchMarkFixture const* fixture, BenchMarkUnit* unit)
+    {
+        unit->PrepareSettings();
+        suite->settings(unit);
+        fixture->settings(unit);
+        unit->settings_(unit);
+        const char* group = unit->compare_;
+        unit->ReleaseSettings();
+        return group;
+    }
+
+    static s32 CountUnits(BenchMarkFixture const* fixture)
+    {
+        s32 count = 0;
+        for (BenchMarkUnit const* unit = fixture->head; unit != nullptr; unit = unit->next)
+            ++count;
+        return count;
+    }
+
+    // Run a unit, or when it is the first unit of an A/B group (see BM_COMPARE), run all the units of that group.
+    // 'grouped' collects the other units of the group, they do not run on their own anymore.
+    static void RunUnit(Allocator* main_allocator, ForwardAllocator* forward_allocator, ScratchAllocator* scratch_allocator, BenchMarkGlobals* globals, Shards* shards, ResultCache* cache, Checkpoint* checkpoint, BenchMarkSuite const* suite, BenchMarkFixture const* fixture, BenchMarkUnit* unit, BenchMarkUnit const* previous, Array<BenchMarkUnit const*>& grouped, void const* suite_data, void const* fixture_data, BenchMarkReporter* reporter)
+    {
+        USE_SCRATCH(scratch_allocator);
+
+        forward_allocator->Reset();
+
+        // The units of a fixture in the same A/B group run together, this unit is the baseline
+        Array<BenchMarkUnit*> members;
+        members.Init(scratch_allocator, 0, grouped.Capacity());
+        members.PushBack(unit);
+        if (const char* group = CompareGroupOf(suite, fixture, unit))
+        {
+            for (BenchMarkUnit* other = unit->next; other != nullptr; other = other->next)
+            {
+                const char* other_group = other->IsDisabled() ? nullptr : CompareGroupOf(suite, fixture, other);
+                if (other_group != nullptr && gCompareStrings(group, other_group) == 0)
+                {
+                    members.PushBack(other);
+                    grouped.PushBack(other);
+                }
+            }
+        }
+
+        // The instances of all the members, 'member' tells to which member an instance belongs
+        Array<BenchMarkInstance*> benchmark_instances;
+        Array<s32>                member;
+        s32                       num_baseline_instances = 0;
+        bool                      same_instances         = true;
+        for (s32 m = 0; m < members.Size(); ++m)
+        {
+            ApplyUnitSettings(forward_allocator, suite, fixture, members[m]);
+
+            Array<BenchMarkInstance*> instances;
+            CreateBenchMarkInstances(forward_allocator, scratch_allocator, shards, members[m], suite_data, fixture_data, instances);
+            if (m == 0)
+            {
+                // The members should have the same arguments, so the same number of instances
+                num_baseline_instances = instances.Size();
+                benchmark_instances.Init(forward_allocator, 0, num_baseline_instances * members.Size());
+                if (members.Size() > 1)
+                    member.Init(forward_allocator, 0, benchmark_instances.Capacity());
+            }
+            else if (instances.Size() != num_baseline_instances)
+            {
+                same_instances = false;
+            }
+
+            if (same_instances)
+            {
+                for (s32 i = 0; i < instances.Size(); ++i)
+                {
+                    benchmark_instances.PushBack(instances[i]);
+                    if (members.Size() > 1)
+                        member.PushBack(m);
+                    if (m > 0 && ComparedBaseline(benchmark_instances, member, benchmark_instances.Size() - 1) < 0)
+                        same_instances = false;
+                }
+                instances.Release();
+            }
+            else
+            {
+                DestroyBenchMarkInstances(forward_allocator, instances);
+            }
+
+            if (!same_instances)
+            {
+                // A member without a counterpart for every instance of the baseline cannot be compared, the group is not run
+                char message[256];
+                Stdout::StringFormat(message, sizeof(message), "Error: the units of A/B group '%s' do not have the same instances ('%s' versus baseline '%s'), the group is not run\n", members[0]->compare_, members[m]->name, members[0]->name);
+                Stdout::Trace(message);
+                break;
+            }
+        }
+
+        if (!same_instances)
+            DestroyBenchMarkInstances(forward_allocator, benchmark_instances);
+
+        if (!benchmark_instances.Empty())
+        {
+            // Report the details of this benchmark unit ?
+            // - name / filename / line number
+
+            const BenchMarkReporter::Context table = members.Size() > 1 ? BenchMarkReporter::Context() : TableOf(fixture, unit, previous, benchmark_instances);
+            RunBenchMarkInstances(main_allocator, forward_allocator, scratch_allocator, globals, shards, cache, checkpoint, benchmark_instances, table, members.Size() > 1 ? &member : nullptr, reporter);
+        }
+
+        // Destroy the benchmark instances
+        DestroyBenchMarkInstances(forward_allocator, benchmark_instances);
+        member.Release();
+
+        // Reset the settings for the benchmark units (release memory)
+        for (s32 m = 0; m < members.Size(); ++m)
+            members[m]->ReleaseSettings();
+        members.Release();
+    }
+
+    // A benchmark-suite has a list of benchmark-fixtures where every fixture has a list of benchmark-units.
+    static void RunBenchMarkSuite(Allocator* main_allocator, ForwardAllocator* forward_allocator, ScratchAllocator* scratch_allocator, BenchMarkGlobals* globals, Shards* shards, ResultCache* cache, Checkpoint* checkpoint, BenchMarkSuite* suite, BenchMarkReporter* reporter)
+    {
+        // Report the details of this benchmark suite ?
+        // - name / filename / line number
+        // - list
+        //   - fixture name(num units)
+
+        bool has_enabled_units = false;
+        for (BenchMarkFixture const* fixture = suite->head; fixture != nullptr && !has_enabled_units; fixture = fixture->next)
+            has_enabled_units = HasEnabledUnits(fixture);
+        if (!has_enabled_units)
+            return;
+
+        // The suite and fixture setup build their data once, all units (with all their args
+        // and thread counts) get to use that same data. The coordinator of the shards does not
+        // run any benchmark so it does not need the data, and workers do not report.
+        const bool                runs_setup     = !shards->is_coordinator;
+        BenchMarkReporter* const  setup_reporter = shards->is_worker ? nullptr : reporter;
+
+        void* suite_data = runs_setup ? RunSharedSetup(main_allocator, forward_allocator, scratch_allocator, suite->setup, suite->name, setup_reporter) : nullptr;
+
+        BenchMarkFixture* fixture = suite->head;
+        while (fixture != nullptr)
+        {
+            // Report the details of this fixture ?
+            // - name / filename / line number / num units
+
+            if (!HasEnabledUnits(fixture))
+            {
                 // Report this fixture as disabled?
                 fixture = fixture->next;
                 continue;
             }
 
-            BenchMarkUnit* unit = fixture->head;
+            void* fixture_data = runs_setup ? RunSharedSetup(main_allocator, forward_allocator, scratch_allocator, fixture->setup, fixture->name, setup_reporter) : nullptr;
+
+            // The units of an A/B group that already ran together with the first unit of their group
+            USE_SCRATCH(scratch_allocator);
+            Array<BenchMarkUnit const*> grouped;
+            grouped.Init(scratch_allocator, 0, CountUnits(fixture));
+
+            BenchMarkUnit const* previous = nullptr;
+            BenchMarkUnit*       unit     = fixture->head;
             while (unit != nullptr)
             {
-                if (!unit->IsDisabled())
+                if (!unit->IsDisabled() && grouped.Find(unit) < 0)
                 {
-                    forward_allocator->Reset();
+                    RunUnit(main_allocator, forward_allocator, scratch_allocator, globals, shards, cache, checkpoint, suite, fixture, unit, previous, grouped, suite_data, fixture_data, reporter);
+                    previous = unit;
+                }
 
-                    // Apply the settings for this benchmark unit, from Suite, Fixture and Unit
-                    // Two passes
-                    for (s32 i = 0; i < 2; ++i)
-                    {
-                        switch (i)
-                        {
-                            case 0: unit->PrepareSettings(); break;
-                            case 1: unit->ApplySettings(forward_allocator); break;
-                        }
-                        suite->settings(unit);
-                        fixture->settings(unit);
-                        unit->settings_(unit);
-                    }
+                unit = unit->next;
+            }
+            grouped.Release();
 
-                    Array<BenchMarkInstance*> benchmark_instances;
-                    if (CreateBenchMarkInstances(forward_allocator, scratch_allocator, unit, benchmark_instances))
-                    {
-                        // Report the details of this benchmark unit ?
-                        // - name / filename / line number
+            if (runs_setup && fixture->teardown != nullptr)
+                fixture->teardown(main_allocator, fixture_data);
 
-                        RunBenchMarkInstances(main_allocator, forward_allocator, scratch_allocator, globals, benchmark_instances, reporter);
-                    }
+            fixture = fixture->next;
+        }
+
+        if (runs_setup && suite->teardown != nullptr)
+            suite->teardown(main_allocator, suite_data);
+    }
+
+    // The built-in suites, referencing them here also keeps the linker from dropping them
+    namespace nsBMSmemory_hierarchy { extern BenchMarkSuite __suite; }
+    namespace nsBMSconcurrency { extern BenchMarkSuite __suite; }
+
+    struct BuiltinSuiteEntry
+    {
+        BenchMarkSuite* suite;
+        u32             flag;
+        const char*     name; // As given to --builtin=
+    };
+
+    static const BuiltinSuiteEntry kBuiltinSuites[] = {
+        {&nsBMSmemory_hierarchy::__suite, BuiltinSuite::Memory, "memory"},
+        {&nsBMSconcurrency::__suite, BuiltinSuite::Concurrency, "concurrency"},
+    };
+    static const s32 kNumBuiltinSuites = (s32)(sizeof(kBuiltinSuites) / sizeof(kBuiltinSuites[0]));
+
+    static bool IsSuiteEnabled(BenchMarkGlobals const* globals, BenchMarkSuite const* suite)
+    {
+        // User suites always run, built-in suites only when asked for
+        for (s32 i = 0; i < kNumBuiltinSuites; ++i)
+        {
+            if (kBuiltinSuites[i].suite == suite)
+                return (globals->benchmark_builtin_suites & kBuiltinSuites[i].flag) != 0;
+        }
+        return true;
+    }
+
+    // Global interleaving (see 'benchmark_global_interleaving'), a unit of an enabled suite together with the data
+    // of its suite and fixture.
+    struct ScheduledUnit
+    {
+        BenchMarkSuite*   suite;
+        BenchMarkFixture* fixture;
+        BenchMarkUnit*    unit;
+        void*             suite_data;
+        void*             fixture_data;
+        bool              compared; // Member of an A/B group, these run group by group (see RunUnit)
+    };
+
+    // Global interleaving, a unit of the current window with the runners and the runs of its instances. The runs
+    // are kept until the last repetition of the unit ran, then the unit is reported as a whole.
+    struct WindowUnit
+    {
+        WindowUnit()
+            : entry(nullptr)
+            , reports_for_family(nullptr)
+            , remaining(0)
+        {
+        }
+
+        ScheduledUnit const*                    entry;
+        Array<BenchMarkInstance*>               instances;
+        Array<BenchMarkRunner*>                 runners;
+        Array<RunResults*>                      results;
+        Array<u64>                              cache_keys; // The key of every instance in the result cache
+        BenchMarkReporter::PerFamilyRunReports* reports_for_family;
+        s32                                     remaining; // Instances that still have repetitions to run
+    };
+
+    // What a single repetition takes of the forward allocator (its run, counters and statistics), an estimate on
+    // the safe side that decides how many units fit in a window.
+    static const s64 kRepetitionSize = 2048;
+
+    static void ReportWindowUnit(ForwardAllocator* forward_allocator, ScratchAllocator* scratch_allocator, BenchMarkGlobals const* globals, WindowUnit* wu, BenchMarkUnit const* previous, BenchMarkReporter* reporter)
+    {
+        USE_SCRATCH(scratch_allocator);
+
+        const s32 num_instances = wu->instances.Size();
+
+        const BenchMarkReporter::Context context = ContextOf(globals, wu->instances, TableOf(wu->entry->fixture, wu->entry->unit, previous, wu->instances));
+        if (reporter->ReportBegin(context, forward_allocator, scratch_allocator))
+        {
+            Array<InstanceSummary> summaries;
+            summaries.Init(scratch_allocator, 0, num_instances);
+            for (s32 i = 0; i < num_instances; ++i)
+            {
+                const BenchMarkRunner* runner = wu->runners[i];
+                reporter->ReportRunsConfig(GetMinTime(runner), HasExplicitIters(runner), GetIters(runner), forward_allocator, scratch_allocator);
+                Report(reporter, wu->results[i], forward_allocator, scratch_allocator);
+                summaries.PushBack(Summarize(wu->results[i]->non_aggregates));
+            }
+
+            // The complexity over all the instances of the unit, as a table of its own like in RunBenchMarkInstances
+            if (wu->reports_for_family != nullptr && wu->reports_for_family->num_runs_done == wu->reports_for_family->num_runs_total)
+            {
+                Array<BenchMarkRun*> additional_run_stats;
+                additional_run_stats.Init(scratch_allocator, 0, 2);
+                ComputeBigO(forward_allocator, scratch_allocator, wu->reports_for_family->runs, additional_run_stats);
+                ReportRows(forward_allocator, scratch_allocator, additional_run_stats, reporter);
+                additional_run_stats.Release();
+            }
+
+            ReportScaling(forward_allocator, scratch_allocator, wu->instances, nullptr, summaries, reporter);
+            ReportLatencyCurves(forward_allocator, scratch_allocator, wu->instances, nullptr, summaries, reporter);
+            reporter->ReportEnd(forward_allocator);
+            summaries.Release();
+        }
+    }
+
+    // Global interleaving, run the repetitions of all the instances of the units of a window in a random order. A unit
+    // is reported once the last of its repetitions ran.
+    static void RunWindow(Allocator* main_allocator, ForwardAllocator* forward_allocator, ScratchAllocator* scratch_allocator, BenchMarkGlobals* globals, ResultCache* cache, Checkpoint* checkpoint, Array<WindowUnit*>& window, s64 num_repetitions, u64 seed, BenchMarkUnit const*& previous, BenchMarkReporter* reporter)
+    {
+        USE_SCRATCH(scratch_allocator);
 
-                    // Destroy the benchmark instances
-                    DestroyBenchMarkInstances(forward_allocator, benchmark_instances);
+        s32 num_instances = 0;
+        for (s32 w = 0; w < window.Size(); ++w)
+            num_instances += window[w]->instances.Size();
 
-                    // Reset the settings for this benchmark unit (release memory)
-                    unit->ReleaseSettings();
+        // Every runner has a slot, the unit (in the window) and instance of the runner
+        Array<s32> slot_unit;
+        Array<s32> slot_instance;
+        slot_unit.Init(scratch_allocator, 0, num_instances);
+        slot_instance.Init(scratch_allocator, 0, num_instances);
+
+        Array<s32> repetition_indices;
+        repetition_indices.Init(scratch_allocator, 0, (s32)num_repetitions);
+
+        for (s32 w = 0; w < window.Size(); ++w)
+        {
+            WindowUnit* wu = window[w];
+            const s32   n  = wu->instances.Size();
+            wu->runners.Init(forward_allocator, 0, n);
+            wu->results.Init(forward_allocator, 0, n);
+            wu->cache_keys.Init(forward_allocator, 0, n);
+            wu->remaining = n;
+            if (n > 0 && !wu->instances[0]->complexity().Is(BigO::O_None))
+                wu->reports_for_family = forward_allocator->Construct<BenchMarkReporter::PerFamilyRunReports>();
+
+            for (s32 i = 0; i < n; ++i)
+            {
+                BenchMarkRunner* runner = CreateRunner(forward_allocator);
+                InitRunner(runner, main_allocator, scratch_allocator, globals, wu->instances[i]);
+                wu->runners.PushBack(runner);
+
+                const s32   repeats = GetNumRepeats(runner);
+                RunResults* results = forward_allocator->Construct<RunResults>();
+                results->non_aggregates.Init(forward_allocator, 0, repeats);
+                results->aggregates_only.Init(forward_allocator, 0, repeats);
+                InitRunResults(runner, globals, results);
+                wu->results.PushBack(results);
+                if (wu->reports_for_family != nullptr)
+                    wu->reports_for_family->num_runs_total += repeats;
+            }
+
+            // The runs of all the instances are known now, the complexity is computed over all of them
+            if (wu->reports_for_family != nullptr)
+                wu->reports_for_family->runs.Init(forward_allocator, 0, wu->reports_for_family->num_runs_total);
+
+            for (s32 i = 0; i < n; ++i)
+            {
+                // An instance with its runs in the result cache does not get a slot
+                wu->cache_keys.PushBack(cache != nullptr ? cache->KeyOf(scratch_allocator, globals, wu->instances[i]) : 0);
+                if (RunFromCache(cache, wu->cache_keys[i], forward_allocator, scratch_allocator, wu->runners[i], wu->results[i], wu->reports_for_family))
+                {
+                    --wu->remaining;
+                    continue;
                 }
 
-                unit = unit->next;
+                const s32 slot    = slot_unit.Size();
+                const s32 repeats = GetNumRepeats(wu->runners[i]);
+                slot_unit.PushBack(w);
+                slot_instance.PushBack(i);
+                for (s32 r = 0; r < repeats; ++r)
+                    repetition_indices.PushBack(slot);
             }
-            fixture = fixture->next;
         }
+
+        // Units that came from the result cache as a whole
+        for (s32 w = 0; w < window.Size(); ++w)
+        {
+            WindowUnit* wu = window[w];
+            if (wu->remaining == 0 && !wu->instances.Empty())
+            {
+                ReportWindowUnit(forward_allocator, scratch_allocator, globals, wu, previous, reporter);
+                previous = wu->entry->unit;
+            }
+        }
+
+        RandomShuffle(repetition_indices, seed);
+
+        for (s32 i = 0; i < repetition_indices.Size(); ++i)
+        {
+            WindowUnit*      wu       = window[slot_unit[repetition_indices[i]]];
+            const s32        instance = slot_instance[repetition_indices[i]];
+            BenchMarkRunner* runner   = wu->runners[instance];
+            RunResults*      results  = wu->results[instance];
+
+            BenchMarkRun*& report = results->non_aggregates.Alloc();
+            report                = forward_allocator->Construct<BenchMarkRun>();
+            if (checkpoint != nullptr && checkpoint->Replay(forward_allocator, scratch_allocator, wu->instances[instance], report))
+            {
+                ReplayRepetition(runner, forward_allocator, report, wu->reports_for_family);
+            }
+            else
+            {
+                DoOneRepetition(runner, forward_allocator, scratch_allocator, report, wu->reports_for_family);
+                if (checkpoint != nullptr)
+                    checkpoint->Record(scratch_allocator, wu->instances[instance], report);
+            }
+
+            if (HasRepeatsRemaining(runner))
+                continue;
+
+            AggregateResults(runner, forward_allocator, scratch_allocator, results->non_aggregates, results->aggregates_only);
+            StoreInCache(cache, wu->cache_keys[instance], scratch_allocator, results);
+            if (--wu->remaining == 0)
+            {
+                ReportWindowUnit(forward_allocator, scratch_allocator, globals, wu, previous, reporter);
+                previous = wu->entry->unit;
+            }
+        }
+
+        for (s32 w = 0; w < window.Size(); ++w)
+        {
+            WindowUnit* wu = window[w];
+            for (s32 i = 0; i < wu->results.Size(); ++i)
+                DestroyRunResults(forward_allocator, wu->results[i]);
+            for (s32 i = 0; i < wu->runners.Size(); ++i)
+                DestroyRunner(wu->runners[i], forward_allocator);
+            wu->results.Release();
+            wu->runners.Release();
+            wu->cache_keys.Release();
+            if (wu->reports_for_family != nullptr)
+                forward_allocator->Destruct(wu->reports_for_family);
+        }
+
+        repetition_indices.Release();
+        slot_instance.Release();
+        slot_unit.Release();
+    }
+
+    // Global interleaving, the repetitions of all the units of all the suites are run in a random order, so that a
+    // slow drift of the machine (thermals, background load) is spread over all of them instead of biasing the units
+    // that happen to run last. The setup of every suite and fixture runs up front and their teardown at the end.
+    // The runners of all the units that are interleaved together exist at the same time, the units are taken in
+    // windows so that the memory the runners hold on to stays within 'benchmark_interleaving_memory' and their runs
+    // fit in the forward allocator. Usually all the units fit in a single window. The exception is a unit whose runners
+    // alone hold more than that, it still runs, in a window of its own, and a warning says so.
+    static void RunBenchMarksInterleaved(Allocator* main_allocator, ForwardAllocator* forward_allocator, ScratchAllocator* scratch_allocator, BenchMarkGlobals* globals, Shards* shards, ResultCache* cache, Checkpoint* checkpoint, BenchMarkReporter* reporter)
+    {
+        USE_SCRATCH(scratch_allocator);
+
+        s32 num_units = 0;
+        for (BenchMarkSuite* suite = BenchMarkSuiteList::head; suite != nullptr; suite = suite->next)
+        {
+            for (BenchMarkFixture const* fixture = suite->head; fixture != nullptr; fixture = fixture->next)
+                num_units += CountUnits(fixture);
+        }
+
+        Array<ScheduledUnit> schedule;
+        schedule.Init(scratch_allocator, 0, num_units);
+
+        for (BenchMarkSuite* suite = BenchMarkSuiteList::head; suite != nullptr; suite = suite->next)
+        {
+            if (suite->disabled || !IsSuiteEnabled(globals, suite))
+                continue;
+
+            bool has_enabled_units = false;
+            for (BenchMarkFixture const* fixture = suite->head; fixture != nullptr && !has_enabled_units; fixture = fixture->next)
+                has_enabled_units = HasEnabledUnits(fixture);
+            if (!has_enabled_units)
+                continue;
+
+            void* suite_data = RunSharedSetup(main_allocator, forward_allocator, scratch_allocator, suite->setup, suite->name, reporter);
+            for (BenchMarkFixture* fixture = suite->head; fixture != nullptr; fixture = fixture->next)
+            {
+                if (!HasEnabledUnits(fixture))
+                    continue;
+
+                void* fixture_data = RunSharedSetup(main_allocator, forward_allocator, scratch_allocator, fixture->setup, fixture->name, reporter);
+                for (BenchMarkUnit* unit = fixture->head; unit != nullptr; unit = unit->next)
+                {
+                    if (unit->IsDisabled())
+                        continue;
+
+                    ScheduledUnit& entry = schedule.Alloc();
+                    entry.suite          = suite;
+                    entry.fixture        = fixture;
+                    entry.unit           = unit;
+                    entry.suite_data     = suite_data;
+                    entry.fixture_data   = fixture_data;
+                    entry.compared       = CompareGroupOf(suite, fixture, unit) != nullptr;
+                }
+            }
+        }
+
+        BenchMarkUnit const* previous = nullptr;
+        u64                  seed     = globals->benchmark_random_interleaving_seed;
+
+        s32 begin = 0;
+        while (begin < schedule.Size())
+        {
+            USE_SCRATCH(scratch_allocator);
+
+            forward_allocator->Reset();
+
+            Array<WindowUnit*> window;
+            window.Init(scratch_allocator, 0, schedule.Size() - begin);
+
+            // Take units until the memory of their runners, or their runs, would not fit anymore
+            s64 memory_held     = 0;
+            s64 num_repetitions = 0;
+            s32 end             = begin;
+            for (; end < schedule.Size(); ++end)
+            {
+                ScheduledUnit const& entry = schedule[end];
+                if (entry.compared)
+                    continue;
+
+                ApplyUnitSettings(forward_allocator, entry.suite, entry.fixture, entry.unit);
+                WindowUnit* wu = forward_allocator->Construct<WindowUnit>();
+                wu->entry      = &entry;
+                CreateBenchMarkInstances(forward_allocator, scratch_allocator, shards, entry.unit, entry.suite_data, entry.fixture_data, wu->instances);
+
+                s64 held    = 0;
+                s64 repeats = 0;
+                for (s32 i = 0; i < wu->instances.Size(); ++i)
+                {
+                    const BenchMarkInstance* instance = wu->instances[i];
+                    held += GetMemoryHeld(instance);
+                    repeats += instance->repetitions() != 0 ? instance->repetitions() : globals->benchmark_repetitions;
+                }
+
+                const bool fits = memory_held + held <= globals->benchmark_interleaving_memory && (num_repetitions + repeats) * kRepetitionSize <= forward_allocator->Available();
+                if (!fits && !window.Empty())
+                {
+                    // This unit starts the next window
+                    DestroyBenchMarkInstances(forward_allocator, wu->instances);
+                    forward_allocator->Destruct(wu);
+                    entry.unit->ReleaseSettings();
+                    break;
+                }
+
+                if (window.Empty() && held > globals->benchmark_interleaving_memory)
+                {
+                    char message[256];
+                    Stdout::StringFormat(message, sizeof(message), "Warning: the runners of a unit hold %d MB, more than the interleaving memory, unit '%s' runs in a window of its own\n", (int)(held >> 20), entry.unit->name);
+                    Stdout::Trace(message);
+                }
+
+                memory_held += held;
+                num_repetitions += repeats;
+                window.PushBack(wu);
+            }
+
+            RunWindow(main_allocator, forward_allocator, scratch_allocator, globals, cache, checkpoint, window, num_repetitions, seed++, previous, reporter);
+
+            for (s32 w = 0; w < window.Size(); ++w)
+            {
+                WindowUnit* wu = window[w];
+                DestroyBenchMarkInstances(forward_allocator, wu->instances);
+                wu->entry->unit->ReleaseSettings();
+                forward_allocator->Destruct(wu);
+            }
+            window.Release();
+
+            begin = end;
+        }
+
+        // The units of the A/B groups, their repetitions are interleaved within the group
+        Array<BenchMarkUnit const*> grouped;
+        grouped.Init(scratch_allocator, 0, num_units);
+        for (s32 i = 0; i < schedule.Size(); ++i)
+        {
+            ScheduledUnit const& entry = schedule[i];
+            if (entry.compared && grouped.Find(entry.unit) < 0)
+                RunUnit(main_allocator, forward_allocator, scratch_allocator, globals, shards, cache, checkpoint, entry.suite, entry.fixture, entry.unit, nullptr, grouped, entry.suite_data, entry.fixture_data, reporter);
+        }
+        grouped.Release();
+
+        for (s32 i = 0; i < schedule.Size(); ++i)
+        {
+            ScheduledUnit const& entry = schedule[i];
+            const bool           last  = i + 1 == schedule.Size();
+            if ((last || schedule[i + 1].fixture != entry.fixture) && entry.fixture->teardown != nullptr)
+                entry.fixture->teardown(main_allocator, entry.fixture_data);
+            if ((last || schedule[i + 1].suite != entry.suite) && entry.suite->teardown != nullptr)
+                entry.suite->teardown(main_allocator, entry.suite_data);
+        }
+        schedule.Release();
     }
 
     static bool RunBenchMarks(Allocator* main_allocator, BenchMarkGlobals* globals, BenchMarkReporter* reporter)
@@ -395,18 +1625,249 @@ namespace BenchMark
         ScratchAllocator* scratch_allocator = &_scratch_allocator;
         ForwardAllocator* forward_allocator = &_forward_allocator;
 
-        BenchMarkSuite* suite = BenchMarkSuiteList::head;
-        while (suite != nullptr)
+        Shards shards;
+        shards.index              = globals->benchmark_shard_index;
+        shards.count              = max<s32>(1, globals->benchmark_shard_count);
+        shards.is_worker          = false;
+        shards.is_coordinator     = false;
+        shards.coordinator.pid    = -1;
+        shards.coordinator.fd     = -1;
+        shards.workers            = nullptr;
+        shards.num_cores          = gNumCores();
+        shards.num_physical_cores = gNumPhysicalCores();
+
+        if (globals->benchmark_shard_workers > 1 && gCanForkProcess())
+        {
+            // Launch a worker for every shard, each worker gets its own set of cores
+            s32       num_workers = globals->benchmark_shard_workers;
+            const s32 num_cores   = gNumCores();
+            if (num_workers > num_cores)
+            {
+                // Workers pinned to the same cores would disturb each other's measurements
+                char message[160];
+                Stdout::StringFormat(message, sizeof(message), "Warning: %d shard workers for %d cores, the number of workers is reduced to the number of cores\n", num_workers, num_cores);
+                Stdout::Trace(message);
+                num_workers = num_cores;
+            }
+            const s32 cores_per_worker = max<s32>(1, num_cores / num_workers);
+
+            // A worker is pinned to its own cores, its thread sweeps resolve against those instead of all the cores
+            shards.num_physical_cores = max<s32>(1, min<s32>(cores_per_worker, (shards.num_physical_cores * cores_per_worker) / num_cores));
+            shards.num_cores          = cores_per_worker;
+
+            shards.count   = num_workers;
+            shards.workers = main_allocator->Alloc<ChildProcess>(sizeof(ChildProcess) * num_workers);
+            for (s32 w = 0; w < num_workers; ++w)
+            {
+                if (gForkProcess(shards.workers[w]) == 0)
+                {
+                    shards.index       = w;
+                    shards.is_worker   = true;
+                    shards.coordinator = shards.workers[w];
+                    gPinToCores((w * cores_per_worker) % num_cores, cores_per_worker);
+                    break;
+                }
+            }
+            shards.is_coordinator = !shards.is_worker;
+        }
+
+        // A checkpoint restores the interleaving seed of the session it continues, so this comes before the schedule.
+        // The checkpoint and the result cache are not used with shards.
+        Checkpoint  session_checkpoint;
+        Checkpoint* checkpoint = nullptr;
+        if (globals->benchmark_checkpoint_file != nullptr && shards.count <= 1 && session_checkpoint.Open(main_allocator, globals->benchmark_checkpoint_file, globals->benchmark_resume, globals->benchmark_random_interleaving_seed))
+            checkpoint = &session_checkpoint;
+
+        // With a checkpoint the result cache is not used, the runs it holds would change the schedule on resume
+        ResultCache  result_cache;
+        ResultCache* cache = nullptr;
+        if (globals->benchmark_cache_file != nullptr && checkpoint == nullptr && shards.count <= 1 && result_cache.Open(main_allocator, globals->benchmark_cache_file, globals->benchmark_cache_max_age))
+            cache = &result_cache;
+
+        // Global interleaving needs all the runners in this process, it does not combine with shards or isolation
+        const bool interleave_globally = globals->benchmark_enable_random_interleaving && globals->benchmark_global_interleaving && shards.count <= 1 && globals->benchmark_isolation == BenchMarkIsolation::None;
+        if (interleave_globally)
+        {
+            RunBenchMarksInterleaved(main_allocator, forward_allocator, scratch_allocator, globals, &shards, cache, checkpoint, reporter);
+        }
+        else
+        {
+            BenchMarkSuite* suite = BenchMarkSuiteList::head;
+            while (suite != nullptr)
+            {
+                if (!suite->disabled && IsSuiteEnabled(globals, suite))
+                {
+                    RunBenchMarkSuite(main_allocator, forward_allocator, scratch_allocator, globals, &shards, cache, checkpoint, suite, reporter);
+                }
+                suite = suite->next;
+            }
+        }
+
+        if (cache != nullptr)
+            cache->Close();
+        if (checkpoint != nullptr)
+            checkpoint->Close();
+
+        if (shards.is_worker)
+            gExitChild(shards.coordinator);
+
+        if (shards.is_coordinator)
         {
-            if (!suite->disabled)
+            for (s32 w = 0; w < shards.count; ++w)
             {
-                RunBenchMarkSuite(main_allocator, forward_allocator, scratch_allocator, globals, suite, reporter);
+                if (shards.workers[w].pid >= 0)
+                    gWaitForChild(shards.workers[w]);
             }
-            suite = suite->next;
+            main_allocator->Deallocate(shards.workers);
         }
         return true;
     }
 
+    static bool ParseBuiltinSuites(const char* str, u32& suites)
+    {
+        // A comma separated list of names, e.g. "memory,concurrency"
+        suites = BuiltinSuite::None;
+        while (*str != '\0')
+        {
+            s32 i = 0;
+            for (; i < kNumBuiltinSuites; ++i)
+            {
+                const s32 length = gStringLength(kBuiltinSuites[i].name);
+                if (gStringFind(str, kBuiltinSuites[i].name) == str && (str[length] == ',' || str[length] == '\0'))
+                {
+                    suites |= kBuiltinSuites[i].flag;
+                    str += length;
+                    break;
+                }
+            }
+            if (i == kNumBuiltinSuites)
+                return false;
+            if (*str == ',')
+                ++str;
+        }
+        return true;
+    }
+
+    static bool ParseInt(const char*& str, s32& value)
+    {
+        const char* begin = str;
+        value             = 0;
+        while (*str >= '0' && *str <= '9')
+            value = value * 10 + (*str++ - '0');
+        return str != begin;
+    }
+
+    bool gParseArguments(BenchMarkGlobals* globals, int argc, char** argv)
+    {
+        bool ok = true;
+        for (int i = 1; i < argc; ++i)
+        {
+            const char* arg = argv[i];
+            if (gStringFind(arg, "--shard=") == arg)
+            {
+                // --shard=i/N, run only the instances of shard 'i' of 'N'
+                const char* str   = arg + gStringLength("--shard=");
+                s32         index = 0;
+                s32         count = 0;
+                if (ParseInt(str, index) && *str++ == '/' && ParseInt(str, count) && *str == '\0' && count > 0 && index < count)
+                {
+                    globals->benchmark_shard_index = index;
+                    globals->benchmark_shard_count = count;
+                }
+                else
+                {
+                    ok = false;
+                }
+            }
+            else if (gStringFind(arg, "--shard_workers=") == arg)
+            {
+                // --shard_workers=N, run the shards in N worker processes and merge their results
+                const char* str     = arg + gStringLength("--shard_workers=");
+                s32         workers = 0;
+                if (ParseInt(str, workers) && *str == '\0')
+                    globals->benchmark_shard_workers = workers;
+                else
+                    ok = false;
+            }
+            else if (gStringFind(arg, "--interleave=") == arg)
+            {
+                // --interleave=unit|global, run the repetitions in a random order within every unit, or over all units
+                const char* str = arg + gStringLength("--interleave=");
+                if (gCompareStrings(str, "unit") == 0 || gCompareStrings(str, "global") == 0)
+                {
+                    globals->benchmark_enable_random_interleaving = true;
+                    globals->benchmark_global_interleaving        = gCompareStrings(str, "global") == 0;
+                }
+                else
+                {
+                    ok = false;
+                }
+            }
+            else if (gStringFind(arg, "--isolation=") == arg)
+            {
+                // --isolation=unit|instance, run every unit or every instance in a child process of its own
+                const char* str = arg + gStringLength("--isolation=");
+                if (gCompareStrings(str, "unit") == 0)
+                    globals->benchmark_isolation = BenchMarkIsolation::Unit;
+                else if (gCompareStrings(str, "instance") == 0)
+                    globals->benchmark_isolation = BenchMarkIsolation::Instance;
+                else
+                    ok = false;
+            }
+            else if (gStringFind(arg, "--cache=") == arg)
+            {
+                // --cache=path, skip the instances with fresh runs in this result cache and add the new runs to it
+                const char* str = arg + gStringLength("--cache=");
+                if (*str != '\0')
+                    globals->benchmark_cache_file = str;
+                else
+                    ok = false;
+            }
+            else if (gStringFind(arg, "--checkpoint=") == arg)
+            {
+                // --checkpoint=path, write every repetition that completes to this file
+                const char* str = arg + gStringLength("--checkpoint=");
+                if (*str != '\0')
+                    globals->benchmark_checkpoint_file = str;
+                else
+                    ok = false;
+            }
+            else if (gCompareStrings(arg, "--resume") == 0)
+            {
+                // --resume, continue the session of the checkpoint, the repetitions in it do not run again
+                globals->benchmark_resume = true;
+            }
+            else if (gStringFind(arg, "--builtin=") == arg)
+            {
+                // --builtin=memory, also run these built-in suites
+                if (!ParseBuiltinSuites(arg + gStringLength("--builtin="), globals->benchmark_builtin_suites))
+                    ok = false;
+            }
+        }
+
+        // A session can only be resumed from a checkpoint
+        if (globals->benchmark_resume && globals->benchmark_checkpoint_file == nullptr)
+        {
+            Stdout::Trace("Error: --resume needs --checkpoint=path\n");
+            ok = false;
+        }
+
+        // A checkpoint is of the session of one process, it is not used with shards
+        if (globals->benchmark_checkpoint_file != nullptr && (globals->benchmark_shard_count > 1 || globals->benchmark_shard_workers > 1))
+        {
+            Stdout::Trace("Error: --checkpoint does not combine with --shard or --shard_workers\n");
+            ok = false;
+        }
+
+        // The result cache is not used with shards, nor with a checkpoint whose schedule its runs would change
+        if (globals->benchmark_cache_file != nullptr && (globals->benchmark_shard_count > 1 || globals->benchmark_shard_workers > 1 || globals->benchmark_checkpoint_file != nullptr))
+        {
+            Stdout::Trace("Error: --cache does not combine with --shard, --shard_workers or --checkpoint\n");
+            ok = false;
+        }
+        return ok;
+    }
+
     bool gRunBenchMark(MainAllocator* allocator, BenchMarkGlobals* globals, BenchMark::BenchMarkReporter& reporter) { return BenchMark::RunBenchMarks(allocator, globals, &reporter); }
 
 } // namespace BenchMark
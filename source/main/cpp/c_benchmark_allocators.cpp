@@ -4,6 +4,7 @@
 
 #include "cbenchmark/private/c_config.h"
 #include "cbenchmark/private/c_benchmark_allocators.h"
+#include "cbenchmark/private/c_memory.h"
 
 #include <cstdlib>
 
@@ -14,6 +15,8 @@ namespace BenchMark
         ASSERT(num_allocations_ >= 0);
         num_allocations_++;
 #if defined(TARGET_MAC)
+        // aligned_alloc requires the size to be a multiple of the alignment
+        size = (size + alignment - 1) & ~((s64)alignment - 1);
         return aligned_alloc(alignment, size);
 #elif defined(TARGET_PC)
         return _aligned_malloc(alignment, size);
@@ -33,6 +36,32 @@ namespace BenchMark
 
     typedef unsigned char u8;
 
+    // The size of the allocation and of its pages are kept in front of the pointer that is handed out
+    static const s64 kPageAllocationHeader = 64;
+
+    void* PageAllocator::v_Allocate(s64 size, unsigned int alignment)
+    {
+        ASSERT(alignment <= kPageAllocationHeader);
+        const s64 total     = size + kPageAllocationHeader;
+        s64       page_size = 0;
+        u8*       pages     = (u8*)gAllocatePages(total, pages_, page_size);
+        if (pages == nullptr)
+            return nullptr;
+        gPlacePages(pages, total, numa_policy_, numa_node_);
+        gTouchPages(pages, total);
+        ((s64*)pages)[0] = total;
+        ((s64*)pages)[1] = page_size;
+        return pages + kPageAllocationHeader;
+    }
+
+    void PageAllocator::v_Deallocate(void* ptr)
+    {
+        if (ptr == nullptr)
+            return;
+        u8* pages = (u8*)ptr - kPageAllocationHeader;
+        gReleasePages(pages, ((s64*)pages)[0], ((s64*)pages)[1]);
+    }
+
     ScratchAllocator::ScratchAllocator()
         : main_(nullptr)
         , buffer_begin_(nullptr)
@@ -161,9 +190,15 @@ namespace BenchMark
         num_allocations_ = 0;
     }
 
+    void ForwardAllocator::Prefault()
+    {
+        if (buffer_begin_ != nullptr)
+            gTouchPages(buffer_begin_, buffer_end_ - buffer_begin_);
+    }
+
     void ForwardAllocator::Reset()
     {
-        ASSERT(buffer_ == buffer_begin_);
+        ASSERT(checkout_ == 0);
         buffer_          = buffer_begin_;
         checkout_        = 0;
         num_allocations_ = 0;
@@ -186,15 +221,23 @@ namespace BenchMark
         s64 size;
     };
 
+    s64 ForwardAllocator::Available(unsigned int alignment) const
+    {
+        u8 const* p = ncore::g_align_ptr(buffer_ + sizeof(ForwardAllocationHeader), alignment);
+        if (p >= buffer_end_)
+            return 0;
+        return (s64)(buffer_end_ - p);
+    }
+
     void* ForwardAllocator::v_Checkout(s64 size, unsigned int alignment)
     {
         ASSERT(checkout_ >= 0);
-        u8* p = ncore::g_align_ptr(buffer_, alignment);
+        // The header sits right in front of the (aligned) pointer that we hand out
+        u8* p = ncore::g_align_ptr(buffer_ + sizeof(ForwardAllocationHeader), alignment);
         if ((p + size) > buffer_end_)
             return nullptr;
 
-        header_       = (ForwardAllocationHeader*)p;
-        p             = (u8*)(header_ + 1);
+        header_       = (ForwardAllocationHeader*)p - 1;
         header_->magic = 0XDEADBEEFDEADBEEFULL;
         header_->ptr  = (void*)(p);
         header_->size = size;
@@ -219,7 +262,7 @@ namespace BenchMark
         header_->size = (u8*)ptr - (u8*)(header_->ptr);
         buffer_       = (u8*)ptr;
         --checkout_;
-        ASSERT(buffer_ < buffer_end_);
+        ASSERT(buffer_ <= buffer_end_);
         ASSERT(checkout_ == 0);
     }
 
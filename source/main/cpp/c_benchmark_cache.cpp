@@ -0,0 +1,299 @@
+#include "ccore/c_debug.h"
+
+#include "cbenchmark/private/c_benchmark_cache.h"
+#include "cbenchmark/private/c_benchmark_instance.h"
+#include "cbenchmark/private/c_benchmark_run.h"
+#include "cbenchmark/private/c_benchmark_name.h"
+#include "cbenchmark/private/c_file.h"
+#include "cbenchmark/private/c_process.h"
+#include "cbenchmark/private/c_stdout.h"
+#include "cbenchmark/private/c_utils.h"
+
+#include <cstring>
+#include <ctime>
+
+namespace BenchMark
+{
+    static const u32 kRecordMagic   = 0x52435242; // 'BRCR'
+    static const u64 kCacheVersion  = 3;          // Part of every key, a change of the record format misses all
+    static const s64 kMaxRecordSize = 16 * 1024 * 1024;
+
+    struct CacheRecordHeader
+    {
+        u32 magic;
+        u32 size; // Of the payload that follows the header
+        u64 key;
+        s64 time; // Seconds since the epoch
+    };
+
+    template <typename T> static u64 sHashValue(u64 hash, T const& value) { return gHash(hash, &value, sizeof(T)); }
+
+    ResultCache::ResultCache()
+        : allocator_(nullptr)
+        , file_(-1)
+        , file_size_(0)
+        , machine_(0)
+        , max_age_(0.0)
+        , keys_(nullptr)
+        , offsets_(nullptr)
+        , times_(nullptr)
+        , capacity_(0)
+        , count_(0)
+    {
+    }
+
+    bool ResultCache::Open(Allocator* allocator, const char* path, double max_age)
+    {
+        // The key of an instance hashes the code of its benchmark function, without the symbols (a stripped
+        // executable) no function has known code and nothing could be cached
+        u8 const* code_begin = nullptr;
+        u8 const* code_end   = nullptr;
+        if (!gFunctionCode((void const*)&gMachineFingerprint, code_begin, code_end))
+        {
+            Stdout::Trace("Warning: --cache is ignored, the code of the benchmark functions is not known (the executable has no symbols)\n");
+            return false;
+        }
+
+        allocator_ = allocator;
+        max_age_   = max_age;
+        machine_   = gMachineFingerprint();
+        file_      = gOpenFile(path);
+        file_size_ = gFileSize(file_);
+        if (file_ < 0 || file_size_ < 0)
+        {
+            Close();
+            return false;
+        }
+
+        // Index the records, a record that was cut short (the process was killed while appending) is skipped by
+        // looking for the magic of the next one
+        s64 offset = 0;
+        while (offset + (s64)sizeof(CacheRecordHeader) <= file_size_)
+        {
+            CacheRecordHeader header;
+            if (!gReadFile(file_, offset, &header, sizeof(header)))
+                break;
+            if (header.magic == kRecordMagic && header.key != 0 && offset + (s64)sizeof(header) + header.size <= file_size_)
+            {
+                Insert(header.key, offset, header.time);
+                offset += sizeof(header) + header.size;
+            }
+            else
+            {
+                offset += 1;
+            }
+        }
+        return true;
+    }
+
+    void ResultCache::Close()
+    {
+        gCloseFile(file_);
+        file_ = -1;
+        if (keys_ != nullptr)
+        {
+            allocator_->Deallocate(keys_);
+            allocator_->Deallocate(offsets_);
+            allocator_->Deallocate(times_);
+        }
+        keys_     = nullptr;
+        offsets_  = nullptr;
+        times_    = nullptr;
+        capacity_ = 0;
+        count_    = 0;
+    }
+
+    u64 ResultCache::KeyOf(ScratchAllocator* scratch, BenchMarkGlobals const* globals, BenchMarkInstance const* instance) const
+    {
+        u8 const* code_begin = nullptr;
+        u8 const* code_end   = nullptr;
+        if (file_ < 0 || !gFunctionCode(instance->code(), code_begin, code_end))
+            return 0;
+
+        USE_SCRATCH(scratch);
+
+        u64 hash = kHashSeed;
+        hash     = sHashValue(hash, kCacheVersion);
+        hash     = sHashValue(hash, machine_);
+        hash     = gHash(hash, code_begin, code_end - code_begin);
+
+        // The full name holds the arguments, the thread count and most of the settings
+        const s32   length   = instance->name().FullNameLen();
+        char*       name     = scratch->Alloc<char>(length + 1);
+        const char* name_end = instance->name().FullName(name, name + length);
+        hash                 = gHash(hash, name, name_end - name);
+        scratch->Deallocate(name);
+
+        hash = sHashValue(hash, instance->threads());
+        hash = sHashValue(hash, instance->arrival_rate());
+        hash = sHashValue(hash, instance->arrival());
+        hash = sHashValue(hash, instance->inflight());
+        hash = sHashValue(hash, instance->time_unit().flags);
+        hash = sHashValue(hash, instance->use_real_time());
+        hash = sHashValue(hash, instance->use_manual_time());
+        hash = sHashValue(hash, instance->measure_process_cpu_time());
+        hash = sHashValue(hash, instance->iterations());
+        hash = sHashValue(hash, instance->repetitions());
+        hash = sHashValue(hash, instance->min_time());
+        hash = sHashValue(hash, instance->min_warmup_time());
+        hash = sHashValue(hash, instance->memory_required());
+        hash = sHashValue(hash, instance->shared_memory_required());
+        hash = sHashValue(hash, instance->seed());
+        hash = sHashValue(hash, instance->numa_policy());
+        hash = sHashValue(hash, instance->numa_node());
+        hash = sHashValue(hash, instance->pages());
+        hash = sHashValue(hash, instance->cache());
+        for (s32 i = 0; i < instance->args()->Size(); ++i)
+            hash = sHashValue(hash, (*instance->args())[i]);
+
+        hash = sHashValue(hash, globals->benchmark_min_time);
+        hash = sHashValue(hash, globals->benchmark_min_warmup_time);
+        hash = sHashValue(hash, globals->benchmark_repetitions);
+        hash = sHashValue(hash, globals->benchmark_random_interleaving_seed);
+
+        return hash != 0 ? hash : 1;
+    }
+
+    bool ResultCache::Load(u64 key, ForwardAllocator* allocator, ScratchAllocator* scratch, s32 count, Array<BenchMarkRun*>& runs)
+    {
+        const s32 slot = Find(key);
+        if (slot < 0 || (double)((s64)std::time(nullptr) - times_[slot]) > max_age_ || runs.Size() + count > runs.Capacity())
+            return false;
+
+        USE_SCRATCH(scratch);
+
+        CacheRecordHeader header;
+        if (!gReadFile(file_, offsets_[slot], &header, sizeof(header)) || header.key != key || header.size < sizeof(s32) || header.size > kMaxRecordSize)
+            return false;
+
+        u8* payload = scratch->Alloc<u8>(header.size);
+        if (!gReadFile(file_, offsets_[slot] + sizeof(header), payload, header.size))
+        {
+            scratch->Deallocate(payload);
+            return false;
+        }
+
+        u8 const* src = payload;
+        u8 const* end = payload + header.size;
+
+        s32 num_runs = 0;
+        memcpy(&num_runs, src, sizeof(s32));
+        src += sizeof(s32);
+
+        const s32 first = runs.Size();
+        bool      ok    = num_runs == count;
+        for (s32 i = 0; i < num_runs && ok; ++i)
+        {
+            BenchMarkRun* run = allocator->Construct<BenchMarkRun>();
+            runs.PushBack(run);
+            src         = run->Restore(allocator, src, end);
+            run->cached = true;
+            ok          = src != nullptr;
+        }
+
+        scratch->Deallocate(payload);
+
+        if (!ok)
+        {
+            while (runs.Size() > first)
+            {
+                runs[runs.Size() - 1]->Reset();
+                allocator->Destruct(runs[runs.Size() - 1]);
+                runs.PopBack();
+            }
+        }
+        return ok;
+    }
+
+    void ResultCache::Store(u64 key, ScratchAllocator* scratch, Array<BenchMarkRun*> const& runs)
+    {
+        if (file_ < 0 || key == 0)
+            return;
+
+        USE_SCRATCH(scratch);
+
+        s64 size = sizeof(s32);
+        for (s32 i = 0; i < runs.Size(); ++i)
+            size += runs[i]->PersistedSize();
+        if (size > kMaxRecordSize)
+            return;
+
+        u8*                buffer = scratch->Alloc<u8>(sizeof(CacheRecordHeader) + size);
+        CacheRecordHeader* header = (CacheRecordHeader*)buffer;
+        header->magic             = kRecordMagic;
+        header->size              = (u32)size;
+        header->key               = key;
+        header->time              = (s64)std::time(nullptr);
+
+        u8*       dst     = buffer + sizeof(CacheRecordHeader);
+        u8 const* dst_end = dst + size;
+        const s32 count   = runs.Size();
+        memcpy(dst, &count, sizeof(s32));
+        dst += sizeof(s32);
+        for (s32 i = 0; i < runs.Size() && dst != nullptr; ++i)
+            dst = runs[i]->Persist(dst, dst_end);
+
+        // The whole record in a single append
+        const s64 offset = file_size_;
+        if (dst == dst_end && gAppendFile(file_, buffer, sizeof(CacheRecordHeader) + size))
+        {
+            file_size_ += sizeof(CacheRecordHeader) + size;
+            Insert(key, offset, header->time);
+        }
+        scratch->Deallocate(buffer);
+    }
+
+    s32 ResultCache::Find(u64 key) const
+    {
+        if (capacity_ == 0)
+            return -1;
+        for (s32 i = (s32)(key & (u64)(capacity_ - 1));; i = (i + 1) & (capacity_ - 1))
+        {
+            if (keys_[i] == key)
+                return i;
+            if (keys_[i] == 0)
+                return -1;
+        }
+    }
+
+    void ResultCache::Insert(u64 key, s64 offset, s64 time)
+    {
+        // Keep the index at most half full
+        if ((count_ + 1) * 2 > capacity_)
+        {
+            u64* const keys     = keys_;
+            s64* const offsets  = offsets_;
+            s64* const times    = times_;
+            const s32  capacity = capacity_;
+
+            capacity_ = capacity_ == 0 ? 64 : capacity_ * 2;
+            keys_     = allocator_->Alloc<u64>(sizeof(u64) * capacity_);
+            offsets_  = allocator_->Alloc<s64>(sizeof(s64) * capacity_);
+            times_    = allocator_->Alloc<s64>(sizeof(s64) * capacity_);
+            memset(keys_, 0, sizeof(u64) * capacity_);
+            count_ = 0;
+
+            for (s32 i = 0; i < capacity; ++i)
+            {
+                if (keys[i] != 0)
+                    Insert(keys[i], offsets[i], times[i]);
+            }
+            if (keys != nullptr)
+            {
+                allocator_->Deallocate(keys);
+                allocator_->Deallocate(offsets);
+                allocator_->Deallocate(times);
+            }
+        }
+
+        s32 i = (s32)(key & (u64)(capacity_ - 1));
+        while (keys_[i] != 0 && keys_[i] != key)
+            i = (i + 1) & (capacity_ - 1);
+        if (keys_[i] == 0)
+            ++count_;
+        keys_[i]    = key;
+        offsets_[i] = offset;
+        times_[i]   = time;
+    }
+
+} // namespace BenchMark
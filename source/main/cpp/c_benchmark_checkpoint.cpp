@@ -0,0 +1,222 @@
+#include "ccore/c_debug.h"
+
+#include "cbenchmark/private/c_benchmark_checkpoint.h"
+#include "cbenchmark/private/c_benchmark_instance.h"
+#include "cbenchmark/private/c_benchmark_run.h"
+#include "cbenchmark/private/c_benchmark_name.h"
+#include "cbenchmark/private/c_file.h"
+#include "cbenchmark/private/c_utils.h"
+
+#include <cstring>
+
+namespace BenchMark
+{
+    static const u32 kCheckpointMagic   = 0x50435242; // 'BRCP'
+    static const u64 kCheckpointVersion = 3;
+    static const s64 kMaxRecordSize     = 16 * 1024 * 1024;
+
+    // The first record is that of the session, its position is -1, 'name' is the version and it holds the seed.
+    // Then follows a record for every position, with the hash of the full name of the instance and its run.
+    struct CheckpointRecordHeader
+    {
+        u32 magic;
+        u32 size; // Of the payload that follows the header
+        s64 position;
+        u64 name;
+    };
+
+    // The hash of the full name of an instance, a replayed run has to be of the instance at the position
+    static u64 sNameHash(ScratchAllocator* scratch, BenchMarkInstance const* instance)
+    {
+        USE_SCRATCH(scratch);
+
+        const s32   len  = instance->name().FullNameLen();
+        char*       name = scratch->Alloc<char>(len + 1);
+        const char* end  = instance->name().FullName(name, name + len);
+
+        const u64 hash = gHash(kHashSeed, name, end - name);
+
+        scratch->Deallocate(name);
+        return hash;
+    }
+
+    Checkpoint::Checkpoint()
+        : allocator_(nullptr)
+        , file_(-1)
+        , file_size_(0)
+        , offsets_(nullptr)
+        , count_(0)
+        , position_(0)
+    {
+    }
+
+    bool Checkpoint::Open(Allocator* allocator, const char* path, bool resume, u64& seed)
+    {
+        allocator_ = allocator;
+        position_  = 0;
+        count_     = 0;
+
+        if (resume)
+        {
+            file_      = gOpenFile(path);
+            file_size_ = gFileSize(file_);
+            if (file_ < 0 || file_size_ < 0)
+            {
+                Close();
+                return false;
+            }
+
+            // The records of the positions 0, 1, 2 .. up to the first that is missing or was cut short (the process
+            // was killed while appending), the file is cut there.
+            s64 offset   = 0;
+            s64 valid    = 0;
+            s64 capacity = 0;
+            while (offset + (s64)sizeof(CheckpointRecordHeader) <= file_size_)
+            {
+                CheckpointRecordHeader header;
+                if (!gReadFile(file_, offset, &header, sizeof(header)) || header.magic != kCheckpointMagic || offset + (s64)sizeof(header) + header.size > file_size_)
+                    break;
+
+                if (offset == 0)
+                {
+                    u64 session_seed = 0;
+                    if (header.position != -1 || header.name != kCheckpointVersion || header.size != sizeof(u64) || !gReadFile(file_, sizeof(header), &session_seed, sizeof(u64)))
+                        break;
+                    seed = session_seed;
+                }
+                else
+                {
+                    if (header.position != count_)
+                        break;
+                    if (count_ == capacity)
+                    {
+                        s64* const offsets = offsets_;
+                        capacity           = capacity == 0 ? 1024 : capacity * 2;
+                        offsets_           = allocator_->Alloc<s64>(sizeof(s64) * capacity);
+                        if (offsets != nullptr)
+                        {
+                            memcpy(offsets_, offsets, sizeof(s64) * count_);
+                            allocator_->Deallocate(offsets);
+                        }
+                    }
+                    offsets_[count_++] = offset;
+                }
+
+                offset += sizeof(header) + header.size;
+                valid = offset;
+            }
+
+            if (valid > 0)
+                return valid == file_size_ || Truncate(valid);
+
+            // Not a checkpoint (or an empty one), start a new one
+            gCloseFile(file_);
+            file_ = -1;
+        }
+
+        file_      = gCreateFile(path);
+        file_size_ = 0;
+        if (file_ < 0)
+            return false;
+
+        u8                      record[sizeof(CheckpointRecordHeader) + sizeof(u64)];
+        CheckpointRecordHeader* header = (CheckpointRecordHeader*)record;
+        header->magic                  = kCheckpointMagic;
+        header->size                   = sizeof(u64);
+        header->position               = -1;
+        header->name                   = kCheckpointVersion;
+        memcpy(record + sizeof(CheckpointRecordHeader), &seed, sizeof(u64));
+        if (!gAppendFile(file_, record, sizeof(record)))
+        {
+            Close();
+            return false;
+        }
+        file_size_ = sizeof(record);
+        return true;
+    }
+
+    void Checkpoint::Close()
+    {
+        gCloseFile(file_);
+        file_ = -1;
+        if (offsets_ != nullptr)
+            allocator_->Deallocate(offsets_);
+        offsets_ = nullptr;
+        count_   = 0;
+    }
+
+    bool Checkpoint::Replay(ForwardAllocator* allocator, ScratchAllocator* scratch, BenchMarkInstance const* instance, BenchMarkRun* run)
+    {
+        if (position_ >= count_)
+            return false;
+
+        USE_SCRATCH(scratch);
+
+        bool                   ok = false;
+        CheckpointRecordHeader header;
+        if (gReadFile(file_, offsets_[position_], &header, sizeof(header)) && header.name == sNameHash(scratch, instance) && header.size <= kMaxRecordSize)
+        {
+            u8* payload = scratch->Alloc<u8>(header.size);
+            ok          = gReadFile(file_, offsets_[position_] + sizeof(header), payload, header.size) && run->Restore(allocator, payload, payload + header.size) == payload + header.size;
+            scratch->Deallocate(payload);
+        }
+
+        if (!ok)
+        {
+            // The schedule is not the one of the checkpoint anymore (the benchmarks or the settings changed), the
+            // rest of the checkpoint is of no use
+            run->Reset();
+            Truncate(offsets_[position_]);
+            count_ = position_;
+            return false;
+        }
+
+        ++position_;
+        return true;
+    }
+
+    void Checkpoint::Record(ScratchAllocator* scratch, BenchMarkInstance const* instance, BenchMarkRun const* run)
+    {
+        // The position moves on also when the record cannot be written, a resume stops at the missing record
+        const s64 position = position_++;
+        if (file_ < 0)
+            return;
+
+        USE_SCRATCH(scratch);
+
+        if (position < count_)
+        {
+            Truncate(offsets_[position]);
+            count_ = position;
+        }
+
+        const s64 size = run->PersistedSize();
+        if (size > kMaxRecordSize)
+            return;
+
+        u8*                     buffer = scratch->Alloc<u8>(sizeof(CheckpointRecordHeader) + size);
+        CheckpointRecordHeader* header = (CheckpointRecordHeader*)buffer;
+        header->magic                  = kCheckpointMagic;
+        header->size                   = (u32)size;
+        header->position               = position;
+        header->name                   = sNameHash(scratch, instance);
+
+        // The whole record in a single append, a record that was cut short is dropped on resume
+        u8 const* end = run->Persist(buffer + sizeof(CheckpointRecordHeader), buffer + sizeof(CheckpointRecordHeader) + size);
+        if (end == buffer + sizeof(CheckpointRecordHeader) + size && gAppendFile(file_, buffer, sizeof(CheckpointRecordHeader) + size))
+        {
+            file_size_ += sizeof(CheckpointRecordHeader) + size;
+        }
+        scratch->Deallocate(buffer);
+    }
+
+    bool Checkpoint::Truncate(s64 size)
+    {
+        // In place, a kill while truncating keeps the seed and the records before 'size'
+        if (!gTruncateFile(file_, size))
+            return false;
+        file_size_ = size;
+        return true;
+    }
+
+} // namespace BenchMark
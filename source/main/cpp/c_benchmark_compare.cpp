@@ -0,0 +1,76 @@
+#include "ccore/c_debug.h"
+
+#include "cbenchmark/private/c_benchmark_compare.h"
+#include "cbenchmark/private/c_benchmark_run.h"
+#include "cbenchmark/private/c_benchmark_name.h"
+#include "cbenchmark/private/c_benchmark_types.h"
+
+#include <cmath>
+
+namespace BenchMark
+{
+    // Two-sided 95% quantile of Student's t distribution with 'df' degrees of freedom
+    static double StudentT95(s32 df)
+    {
+        static const double kTable[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228, 2.201, 2.179, 2.160, 2.145, 2.131,
+                                        2.120,  2.110, 2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+        if (df < 1)
+            return 0.0;
+        if (df <= 30)
+            return kTable[df - 1];
+        // Close to the exact quantile (within 0.005) for more degrees of freedom
+        return 1.960 + 2.4 / (double)df;
+    }
+
+    void ComputeComparison(Allocator* alloc, BenchmarkName const& name, double const* baseline, s32 baseline_size, double const* candidate, s32 candidate_size, Array<BenchMarkRun*>& comparison)
+    {
+        // The log ratio of every pair, a pair where one of the two did not run is dropped
+        double sum   = 0.0;
+        double sumsq = 0.0;
+        s32    n     = 0;
+        for (s32 i = 0; i < baseline_size && i < candidate_size; ++i)
+        {
+            if (baseline[i] <= 0.0 || candidate[i] <= 0.0)
+                continue;
+            const double r = std::log(candidate[i] / baseline[i]);
+            sum += r;
+            sumsq += r * r;
+            n += 1;
+        }
+        if (n == 0)
+            return;
+
+        const double mean     = sum / (double)n;
+        const double variance = n > 1 ? std::fmax((sumsq - sum * mean) / (double)(n - 1), 0.0) : 0.0;
+        const double margin   = n > 1 ? StudentT95(n - 1) * std::sqrt(variance / (double)n) : 0.0;
+        const double ratio    = std::exp(mean);
+        const double lo       = std::exp(mean - margin);
+        const double hi       = std::exp(mean + margin);
+
+        BenchMarkRun*& row         = comparison.Alloc();
+        row                        = alloc->Construct<BenchMarkRun>();
+        row->run_name              = name;
+        row->run_type              = BenchMarkRun::RT_Aggregate;
+        row->aggregate_name        = "compare";
+        row->repetition_index      = BenchMarkRun::no_repetition_index;
+        row->iterations            = 0;
+        row->real_accumulated_time = ratio;
+        row->cpu_accumulated_time  = ratio - 1.0;
+        row->report_compare        = true;
+        row->counters.Initialize(alloc, 3);
+        row->counters.counters.PushBack({"ratio lo", {CounterFlags::Defaults}, lo});
+        row->counters.counters.PushBack({"ratio hi", {CounterFlags::Defaults}, hi});
+        row->counters.counters.PushBack({"pairs", {CounterFlags::Defaults}, (double)n});
+
+        // The verdict, the candidate takes more (or less) time per iteration than the baseline
+        if (n < 2)
+            row->report_format = "too few pairs";
+        else if (lo > 1.0)
+            row->report_format = "slower";
+        else if (hi < 1.0)
+            row->report_format = "faster";
+        else
+            row->report_format = "no significant difference";
+    }
+
+} // namespace BenchMark
@@ -44,19 +44,27 @@ namespace BenchMark
         return result;
     }
 
+    // The fitting curves have the two sizes of a run, 'm' is only used by the two-variable forms
+    typedef double(FittingFunc)(IterationCount n, IterationCount m);
+
     // Internal function to calculate the different scalability forms
-    BigO::Func* FittingCurve(BigO complexity)
+    FittingFunc* FittingCurve(BigO complexity)
     {
         static const double kLog2E = 1.44269504088896340736;
         switch (complexity.bigo)
         {
-            case BigO::O_N: return [](IterationCount n) -> double { return static_cast<double>(n); };
-            case BigO::O_N_Squared: return [](IterationCount n) -> double { return (double)ipow(n, 2); };
-            case BigO::O_N_Cubed: return [](IterationCount n) -> double { return (double)ipow(n, 3); };
-            case BigO::O_Log_N: return [](IterationCount n) { return kLog2E * log(static_cast<double>(n)); };
-            case BigO::O_N_Log_N: return [](IterationCount n) { return kLog2E * n * log(static_cast<double>(n)); };
+            case BigO::O_N: return [](IterationCount n, IterationCount) -> double { return static_cast<double>(n); };
+            case BigO::O_N_Squared: return [](IterationCount n, IterationCount) -> double { return (double)ipow(n, 2); };
+            case BigO::O_N_Cubed: return [](IterationCount n, IterationCount) -> double { return (double)ipow(n, 3); };
+            case BigO::O_Log_N: return [](IterationCount n, IterationCount) { return kLog2E * log(static_cast<double>(n)); };
+            case BigO::O_N_Log_N: return [](IterationCount n, IterationCount) { return kLog2E * n * log(static_cast<double>(n)); };
+            case BigO::O_Exponential: return [](IterationCount n, IterationCount) { return exp2(static_cast<double>(n)); };
+            case BigO::O_Sqrt_N: return [](IterationCount n, IterationCount) { return sqrt(static_cast<double>(n)); };
+            case BigO::O_N_M: return [](IterationCount n, IterationCount m) { return static_cast<double>(n) * static_cast<double>(m); };
+            case BigO::O_N_Log_M: return [](IterationCount n, IterationCount m) { return kLog2E * n * log(static_cast<double>(m)); };
+            case BigO::O_N_Plus_M: return [](IterationCount n, IterationCount m) { return static_cast<double>(n) + static_cast<double>(m); };
             case BigO::O_1:
-            default: return [](IterationCount) { return 1.0; };
+            default: return [](IterationCount, IterationCount) { return 1.0; };
         }
     }
 
@@ -65,57 +73,197 @@ namespace BenchMark
         LeastSq()
             : coef(0.0)
             , rms(0.0)
+            , r2(0.0)
+            , max_residual(0.0)
+            , exponent_n(0.0)
+            , exponent_m(0.0)
             , complexity(BigO::O_None)
         {
         }
 
         double coef;
-        double rms;
-        BigO   complexity;
+        double rms;          // Normalized by the mean of the observed times
+        double r2;           // Coefficient of determination, near 1 is a good fit, near (or below) 0 is meaningless
+        double max_residual; // The largest difference between a fitted and an observed time, relative to the latter
+        double exponent_n;   // The power-law fits
+        double exponent_m;   //
+        BigO   complexity;   // O_None when the fit is not possible (e.g. a zero or negative size)
     };
 
+    // The quality of a fit, 'fit' is the fitted time of every run.
+    void EvaluateFit(const Array<double>& time, const Array<double>& fit, LeastSq& result)
+    {
+        double sigma_time = 0.0;
+        for (s32 i = 0; i < time.Size(); ++i)
+            sigma_time += time[i];
+        const double mean = sigma_time / time.Size();
+
+        double rms          = 0.0;
+        double total        = 0.0;
+        double max_residual = 0.0;
+        for (s32 i = 0; i < time.Size(); ++i)
+        {
+            rms += dpow((time[i] - fit[i]), 2);
+            total += dpow((time[i] - mean), 2);
+            if (time[i] > 0.0)
+                max_residual = std::max(max_residual, fabs(time[i] - fit[i]) / time[i]);
+        }
+
+        // Normalized RMS by the mean of the observed values
+        result.rms          = sqrt(rms / time.Size()) / mean;
+        result.r2           = total > 0.0 ? 1.0 - rms / total : (rms > 0.0 ? 0.0 : 1.0);
+        result.max_residual = max_residual;
+    }
+
     // Find the coefficient for the high-order term in the running time, by
     // minimizing the sum of squares of relative error, for the fitting curve
-    // given by the lambda expression.
-    //   - n             : Vector containing the size of the benchmark tests.
-    //   - time          : Vector containing the times for the benchmark tests.
-    //   - fitting_curve : lambda expression (e.g. [](s64 n) {return n; };).
+    // evaluated at the size of every run.
+    //   - gn   : Vector containing the fitting curve at the size of the benchmark tests.
+    //   - time : Vector containing the times for the benchmark tests.
 
     // For a deeper explanation on the algorithm logic, please refer to
     // https://en.wikipedia.org/wiki/Least_squares#Least_squares,_regression_analysis_and_statistics
 
-    LeastSq MinimalLeastSq(const Array<s64>& n, const Array<double>& time, BigO::Func* fitting_curve)
+    LeastSq MinimalLeastSq(ScratchAllocator* scratch, const Array<double>& gn, const Array<double>& time)
     {
         double sigma_gn_squared = 0.0;
-        double sigma_time       = 0.0;
         double sigma_time_gn    = 0.0;
 
         // Calculate least square fitting parameter
-        for (s32 i = 0; i < n.Size(); ++i)
+        for (s32 i = 0; i < gn.Size(); ++i)
         {
-            double gn_i = fitting_curve(n[i]);
-            sigma_gn_squared += gn_i * gn_i;
-            sigma_time += time[i];
-            sigma_time_gn += time[i] * gn_i;
+            sigma_gn_squared += gn[i] * gn[i];
+            sigma_time_gn += time[i] * gn[i];
         }
 
         LeastSq result;
+        if (!(sigma_gn_squared > 0.0) || !std::isfinite(sigma_gn_squared))
+            return result;
+
         result.complexity = BigO::O_Lambda;
 
         // Calculate complexity.
         result.coef = sigma_time_gn / sigma_gn_squared;
 
-        // Calculate RMS
-        double rms = 0.0;
+        USE_SCRATCH(scratch);
+
+        Array<double> fit;
+        fit.Init(scratch, 0, gn.Size());
+        for (s32 i = 0; i < gn.Size(); ++i)
+            fit.PushBack(result.coef * gn[i]);
+        EvaluateFit(time, fit, result);
+        fit.Release();
+
+        return result;
+    }
+
+    // Solves the normal equations 'a' * x = 'b' of 'k' unknowns, Gaussian elimination with partial pivoting.
+    // Returns false when they are singular (e.g. all the runs have the same size).
+    bool SolveNormalEquations(double a[3][3], double b[3], s32 k, double x[3])
+    {
+        for (s32 c = 0; c < k; ++c)
+        {
+            s32 pivot = c;
+            for (s32 r = c + 1; r < k; ++r)
+                if (fabs(a[r][c]) > fabs(a[pivot][c]))
+                    pivot = r;
+            if (!(fabs(a[pivot][c]) > 1e-12))
+                return false;
+
+            for (s32 j = 0; j < k; ++j)
+                std::swap(a[c][j], a[pivot][j]);
+            std::swap(b[c], b[pivot]);
+
+            for (s32 r = c + 1; r < k; ++r)
+            {
+                const double f = a[r][c] / a[c][c];
+                for (s32 j = c; j < k; ++j)
+                    a[r][j] -= f * a[c][j];
+                b[r] -= f * b[c];
+            }
+        }
+
+        for (s32 c = k - 1; c >= 0; --c)
+        {
+            double sum = b[c];
+            for (s32 j = c + 1; j < k; ++j)
+                sum -= a[c][j] * x[j];
+            x[c] = sum / a[c][c];
+        }
+        return true;
+    }
+
+    // The power law c * N^a (or c * N^a * M^b), a straight line in log-log space:
+    //   log(time) = log(c) + a * log(N) + b * log(M)
+    // All the sizes and times have to be positive.
+    LeastSq PowerLawLeastSq(ScratchAllocator* scratch, const Array<s64>& n, const Array<s64>& m, const Array<double>& time, bool two_variable)
+    {
+        LeastSq   result;
+        const s32 k = two_variable ? 3 : 2;
+
+        // The normal equations of the linear fit, the variables are {1, log(N), log(M)}
+        double a[3][3] = {{0.0}};
+        double b[3]    = {0.0};
         for (s32 i = 0; i < n.Size(); ++i)
         {
-            double fit = result.coef * fitting_curve(n[i]);
-            rms += dpow((time[i] - fit), 2);
+            if (n[i] <= 0 || time[i] <= 0.0 || (two_variable && m[i] <= 0))
+                return result;
+
+            const double v[3] = {1.0, log(static_cast<double>(n[i])), two_variable ? log(static_cast<double>(m[i])) : 0.0};
+            const double y    = log(time[i]);
+            for (s32 r = 0; r < k; ++r)
+            {
+                for (s32 c = 0; c < k; ++c)
+                    a[r][c] += v[r] * v[c];
+                b[r] += v[r] * y;
+            }
         }
 
-        // Normalized RMS by the mean of the observed values
-        double mean = sigma_time / n.Size();
-        result.rms  = sqrt(rms / n.Size()) / mean;
+        double x[3] = {0.0};
+        if (!SolveNormalEquations(a, b, k, x))
+            return result;
+
+        result.complexity = two_variable ? BigO::O_N_M_Power : BigO::O_N_Power;
+        result.coef       = exp(x[0]);
+        result.exponent_n = x[1];
+        result.exponent_m = two_variable ? x[2] : 0.0;
+
+        USE_SCRATCH(scratch);
+
+        // The quality of the fit is that of the times, not of their logarithms
+        Array<double> fit;
+        fit.Init(scratch, 0, n.Size());
+        for (s32 i = 0; i < n.Size(); ++i)
+        {
+            double t = result.coef * pow(static_cast<double>(n[i]), result.exponent_n);
+            if (two_variable)
+                t *= pow(static_cast<double>(m[i]), result.exponent_m);
+            fit.PushBack(t);
+        }
+        EvaluateFit(time, fit, result);
+        fit.Release();
+
+        return result;
+    }
+
+    // Fits 'complexity' to the runs, a fitting curve or a power law
+    LeastSq FitComplexity(ScratchAllocator* scratch, const Array<s64>& n, const Array<s64>& m, const Array<double>& time, const BigO complexity)
+    {
+        if (complexity.Is(BigO::O_N_Power) || complexity.Is(BigO::O_N_M_Power))
+            return PowerLawLeastSq(scratch, n, m, time, complexity.Is(BigO::O_N_M_Power));
+
+        USE_SCRATCH(scratch);
+
+        FittingFunc*  fitting_curve = FittingCurve(complexity);
+        Array<double> gn;
+        gn.Init(scratch, 0, n.Size());
+        for (s32 i = 0; i < n.Size(); ++i)
+            gn.PushBack(fitting_curve(n[i], m[i]));
+
+        LeastSq result = MinimalLeastSq(scratch, gn, time);
+        if (!result.complexity.Is(BigO::O_None))
+            result.complexity = complexity;
+        gn.Release();
 
         return result;
     }
@@ -123,11 +271,13 @@ namespace BenchMark
     // Find the coefficient for the high-order term in the running time, by
     // minimizing the sum of squares of relative error.
     //   - n          : Vector containing the size of the benchmark tests.
+    //   - m          : Vector containing the second size of the benchmark tests (0 if there is none).
     //   - time       : Vector containing the times for the benchmark tests.
     //   - complexity : If different than O_Auto, the fitting curve will stick to
     //                  this one. If it is O_Auto, it will be calculated the best
-    //                  fitting curve.
-    LeastSq MinimalLeastSq(const Array<s64>& n, const Array<double>& time, const BigO complexity)
+    //                  fitting curve, the two-variable ones are candidates when
+    //                  every run has a second size.
+    LeastSq MinimalLeastSq(ScratchAllocator* scratch, const Array<s64>& n, const Array<s64>& m, const Array<double>& time, const BigO complexity)
     {
         BM_CHECK_EQ(n.Size(), time.Size());
         BM_CHECK_GE(n.Size(), 2); // Do not compute fitting curve is less than two
@@ -138,27 +288,34 @@ namespace BenchMark
 
         if (complexity.Is(BigO::O_Auto))
         {
-            u32 const fit_curves[] = {BigO::O_Log_N, BigO::O_N, BigO::O_N_Log_N, BigO::O_N_Squared, BigO::O_N_Cubed};
+            // The power laws always fit at least as well as the curves with a fixed exponent, they are not candidates
+            u32 const fit_curves[] = {BigO::O_Log_N, BigO::O_Sqrt_N, BigO::O_N, BigO::O_N_Log_N, BigO::O_N_Squared, BigO::O_N_Cubed};
+            u32 const fit_curves_nm[] = {BigO::O_N_M, BigO::O_N_Log_M, BigO::O_N_Plus_M};
+
+            bool two_variable = true;
+            for (s32 i = 0; i < m.Size(); ++i)
+                two_variable = two_variable && m[i] > 0;
 
             // Take O(1) as default best fitting curve
-            best_fit            = MinimalLeastSq(n, time, FittingCurve(BigO::O_1));
-            best_fit.complexity = BigO::O_1;
+            best_fit = FitComplexity(scratch, n, m, time, BigO::O_1);
 
             // Compute all possible fitting curves and stick to the best one
             for (const auto& fit : fit_curves)
             {
-                LeastSq current_fit = MinimalLeastSq(n, time, FittingCurve(fit));
-                if (current_fit.rms < best_fit.rms)
-                {
-                    best_fit            = current_fit;
-                    best_fit.complexity = fit;
-                }
+                LeastSq current_fit = FitComplexity(scratch, n, m, time, fit);
+                if (!current_fit.complexity.Is(BigO::O_None) && current_fit.rms < best_fit.rms)
+                    best_fit = current_fit;
+            }
+            for (s32 i = 0; two_variable && i < (s32)(sizeof(fit_curves_nm) / sizeof(fit_curves_nm[0])); ++i)
+            {
+                LeastSq current_fit = FitComplexity(scratch, n, m, time, fit_curves_nm[i]);
+                if (!current_fit.complexity.Is(BigO::O_None) && current_fit.rms < best_fit.rms)
+                    best_fit = current_fit;
             }
         }
         else
         {
-            best_fit            = MinimalLeastSq(n, time, FittingCurve(complexity));
-            best_fit.complexity = complexity;
+            best_fit = FitComplexity(scratch, n, m, time, complexity);
         }
 
         return best_fit;
@@ -174,20 +331,26 @@ namespace BenchMark
 
         // Accumulators.
         Array<s64>    n;
+        Array<s64>    m;
         Array<double> real_time;
         Array<double> cpu_time;
 
         n.Init(scratch, 0, reports.Size());
+        m.Init(scratch, 0, reports.Size());
         real_time.Init(scratch, 0, reports.Size());
         cpu_time.Init(scratch, 0, reports.Size());
 
+        const BenchMarkRun* run0 = reports[0];
+
         // Populate the accumulators.
         for (s32 i = 0; i < reports.Size(); ++i)
         {
             const BenchMarkRun* run = reports[i];
 
             ASSERTS(run->complexity_n != 0, "Did you forget to call SetComplexityN?");
+            ASSERTS(run->complexity_m != 0 || !run0->complexity.IsTwoVariable(), "Did you forget to call SetComplexityN(n, m)?");
             n.PushBack(run->complexity_n);
+            m.PushBack(run->complexity_m);
             real_time.PushBack(run->real_accumulated_time / run->iterations);
             cpu_time.PushBack(run->cpu_accumulated_time / run->iterations);
         }
@@ -195,18 +358,30 @@ namespace BenchMark
         LeastSq result_cpu;
         LeastSq result_real;
 
-        const BenchMarkRun* run0 = reports[0];
         if (run0->complexity.Is(BigO::O_Lambda))
         {
-            result_cpu  = MinimalLeastSq(n, cpu_time, run0->complexity_lambda);
-            result_real = MinimalLeastSq(n, real_time, run0->complexity_lambda);
+            USE_SCRATCH(scratch);
+
+            Array<double> gn;
+            gn.Init(scratch, 0, n.Size());
+            for (s32 i = 0; i < n.Size(); ++i)
+                gn.PushBack(run0->complexity_lambda(n[i]));
+            result_cpu  = MinimalLeastSq(scratch, gn, cpu_time);
+            result_real = MinimalLeastSq(scratch, gn, real_time);
+            gn.Release();
         }
         else
         {
-            result_cpu  = MinimalLeastSq(n, cpu_time, run0->complexity);
-            result_real = MinimalLeastSq(n, real_time, result_cpu.complexity);
+            result_cpu  = MinimalLeastSq(scratch, n, m, cpu_time, run0->complexity);
+            result_real = MinimalLeastSq(scratch, n, m, real_time, result_cpu.complexity.Is(BigO::O_None) ? run0->complexity : result_cpu.complexity);
         }
 
+        // The fitted exponent, next to the chosen curve it shows how far off its exponent is
+        bool two_variable = true;
+        for (s32 i = 0; i < m.Size(); ++i)
+            two_variable = two_variable && m[i] > 0;
+        const LeastSq power_cpu = PowerLawLeastSq(scratch, n, m, cpu_time, two_variable);
+
         // Get the data from the accumulator to Run's.
         BenchMarkRun*& big_o         = bigo.Alloc();
         big_o                        = alloc->Construct<BenchMarkRun>();
@@ -225,6 +400,18 @@ namespace BenchMark
         big_o->cpu_accumulated_time  = result_cpu.coef;
         big_o->report_big_o          = true;
         big_o->complexity            = result_cpu.complexity;
+        big_o->time_unit             = run0->time_unit;
+
+        // How well the curve fits the cpu times, and the exponent of the power law (when it could be fitted)
+        big_o->counters.Initialize(alloc, 4);
+        big_o->counters.counters.PushBack({"R2", {CounterFlags::Defaults}, result_cpu.r2});
+        big_o->counters.counters.PushBack({"max residual", {CounterFlags::Defaults}, result_cpu.max_residual});
+        if (!power_cpu.complexity.Is(BigO::O_None))
+        {
+            big_o->counters.counters.PushBack({two_variable ? "exponent N" : "exponent", {CounterFlags::Defaults}, power_cpu.exponent_n});
+            if (two_variable)
+                big_o->counters.counters.PushBack({"exponent M", {CounterFlags::Defaults}, power_cpu.exponent_m});
+        }
 
         // All the time results are reported after being multiplied by the
         // time unit multiplier. But since RMS is a relative quantity it
@@ -255,6 +442,7 @@ namespace BenchMark
         rms->time_unit = run0->time_unit;
 
         n.Release();
+        m.Release();
         real_time.Release();
         cpu_time.Release();
     }
@@ -0,0 +1,380 @@
+#include "cbenchmark/private/c_benchmark_generator.h"
+#include "cbenchmark/private/c_benchmark_check.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace BenchMark
+{
+    // Used to turn a single seed into the states of the lanes
+    static inline u64 SplitMix64(u64& x)
+    {
+        u64 z = (x += 0x9E3779B97F4A7C15ULL);
+        z     = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z     = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // Maps a 32-bit random value onto [0, range)
+    static inline u32 MapRange(u32 r, u32 range) { return (u32)(((u64)r * (u64)range) >> 32); }
+
+    // Maps 8 random bits onto a lowercase letter
+    static inline char MapLetter(u8 r) { return (char)('a' + (((u32)r * 26) >> 8)); }
+
+    // Maps every byte of a random value onto a lowercase letter, the bytes are handled as 16-bit fields
+    // (odd and even) so that a multiply does not carry into the neighbouring byte
+    static inline u64 MapLetters(u64 r)
+    {
+        const u64 mask = 0x00FF00FF00FF00FFULL;
+        const u64 even = (((r & mask) * 26) >> 8) & mask;
+        const u64 odd  = ((((r >> 8) & mask) * 26) >> 8) & mask;
+        return (even | (odd << 8)) + 0x6161616161616161ULL;
+    }
+
+    Generator::Generator(u64 seed)
+        : cursor_(Lanes * 2)
+    {
+        for (s32 i = 0; i < Lanes; ++i)
+        {
+            s0_[i] = SplitMix64(seed);
+            s1_[i] = SplitMix64(seed);
+            if ((s0_[i] | s1_[i]) == 0)
+                s1_[i] = 1;
+        }
+    }
+
+    // One xorshift128+ step of a single lane
+    static inline u64 Step(u64& s0, u64& s1)
+    {
+        u64       x = s0;
+        u64 const y = s1;
+        s0          = y;
+        x ^= x << 23;
+        s1 = x ^ y ^ (x >> 17) ^ (y >> 26);
+        return s1 + y;
+    }
+
+    // The bulk loops below work on a local copy of the lanes, this (and the lack of any dependency
+    // between lanes) is what lets the compiler turn the loop over the lanes into SIMD.
+    inline void Generator::Load(u64* s0, u64* s1) const
+    {
+        for (s32 j = 0; j < Lanes; ++j)
+        {
+            s0[j] = s0_[j];
+            s1[j] = s1_[j];
+        }
+    }
+
+    inline void Generator::Store(u64 const* s0, u64 const* s1)
+    {
+        for (s32 j = 0; j < Lanes; ++j)
+        {
+            s0_[j] = s0[j];
+            s1_[j] = s1[j];
+        }
+    }
+
+    inline void Generator::NextBlock(u64* values)
+    {
+        for (s32 j = 0; j < Lanes; ++j)
+            values[j] = Step(s0_[j], s1_[j]);
+    }
+
+    inline u32 Generator::Next32()
+    {
+        if (cursor_ == Lanes * 2)
+        {
+            NextBlock(block_);
+            cursor_ = 0;
+        }
+        u32 const* values = (u32 const*)block_;
+        return values[cursor_++];
+    }
+
+    void Generator::Random(u64* values, s64 count)
+    {
+        u64 s0[Lanes], s1[Lanes];
+        Load(s0, s1);
+        s64 i = 0;
+        for (; (i + Lanes) <= count; i += Lanes)
+        {
+            for (s32 j = 0; j < Lanes; ++j)
+                values[i + j] = Step(s0[j], s1[j]);
+        }
+        Store(s0, s1);
+
+        for (; i < count; ++i)
+            values[i] = ((u64)Next32() << 32) | Next32();
+    }
+
+    // 32-bit random values, the low halves of a block go first, then the high halves
+    void Generator::Random(u32* values, s64 count)
+    {
+        u64 s0[Lanes], s1[Lanes];
+        Load(s0, s1);
+        s64 i = 0;
+        for (; (i + Lanes * 2) <= count; i += Lanes * 2)
+        {
+            for (s32 j = 0; j < Lanes; ++j)
+            {
+                u64 const r           = Step(s0[j], s1[j]);
+                values[i + j]         = (u32)r;
+                values[i + Lanes + j] = (u32)(r >> 32);
+            }
+        }
+        Store(s0, s1);
+
+        for (; i < count; ++i)
+            values[i] = Next32();
+    }
+
+    void Generator::Uniform(u32* keys, s64 count, u32 lo, u32 hi)
+    {
+        BM_CHECK(lo <= hi);
+        if ((hi - lo) == 0xFFFFFFFF)
+        {
+            Random(keys, count);
+            return;
+        }
+
+        u32 const range = (hi - lo) + 1;
+
+        u64 s0[Lanes], s1[Lanes];
+        Load(s0, s1);
+        s64 i = 0;
+        for (; (i + Lanes * 2) <= count; i += Lanes * 2)
+        {
+            for (s32 j = 0; j < Lanes; ++j)
+            {
+                u64 const r         = Step(s0[j], s1[j]);
+                keys[i + j]         = lo + MapRange((u32)r, range);
+                keys[i + Lanes + j] = lo + MapRange((u32)(r >> 32), range);
+            }
+        }
+        Store(s0, s1);
+
+        for (; i < count; ++i)
+            keys[i] = lo + MapRange(Next32(), range);
+    }
+
+    // Keys 0 .. kZipfHead-1 are drawn exactly with an alias table (Walker/Vose), the tail of the distribution
+    // is one extra entry in that table and is drawn from the continuous approximation. For the commonly used
+    // exponents most of the samples come from the table, which is branch free.
+    static const s32 kZipfHead = 65536;
+
+    union ZipfColumn
+    {
+        double scaled;    // While building, probability * number of columns
+        u64    threshold; // Probability of the column itself in 32-bit fixed point, otherwise take the alias
+    };
+
+    void Generator::Zipfian(Allocator* allocator, u32* keys, s64 count, u32 n, double s)
+    {
+        BM_CHECK(n > 0 && s > 0.0);
+
+        const s32 head = n < (u32)kZipfHead ? (s32)n : kZipfHead;
+
+        // Probability mass of the head (exact) and the tail (integral of x^-s over [head + 0.5, n + 0.5])
+        double head_mass = 0.0;
+        for (s32 k = 1; k <= head; ++k)
+            head_mass += std::pow((double)k, -s);
+
+        const double a         = (double)head + 0.5;
+        const double b         = (double)n + 0.5;
+        const bool   harmonic  = std::fabs(s - 1.0) < 1e-9;
+        const double a1s       = harmonic ? 0.0 : std::pow(a, 1.0 - s);
+        const double tail_mass = (head == (s32)n) ? 0.0 : (harmonic ? std::log(b / a) : (std::pow(b, 1.0 - s) - a1s) / (1.0 - s));
+        const double total     = head_mass + tail_mass;
+
+        const s32   columns = head + (tail_mass > 0.0 ? 1 : 0);
+        ZipfColumn* table   = (ZipfColumn*)allocator->Allocate(sizeof(ZipfColumn) * columns);
+        u32*        alias   = (u32*)allocator->Allocate(sizeof(u32) * columns);
+        u32*        work    = (u32*)allocator->Allocate(sizeof(u32) * columns);
+
+        // Columns below the average go on the front of 'work', the others on the back
+        s32 small = 0;
+        s32 large = columns;
+        for (s32 k = 0; k < columns; ++k)
+        {
+            const double mass = (k < head) ? std::pow((double)(k + 1), -s) : tail_mass;
+            table[k].scaled   = (mass / total) * (double)columns;
+            alias[k]          = (u32)k;
+            if (table[k].scaled < 1.0)
+                work[small++] = (u32)k;
+            else
+                work[--large] = (u32)k;
+        }
+
+        // Fill every small column up with a piece of a large column
+        while (small > 0 && large < columns)
+        {
+            const u32 l = work[--small];
+            const u32 g = work[large++];
+            alias[l]    = g;
+            table[g].scaled -= 1.0 - table[l].scaled;
+            table[l].threshold = (u64)(table[l].scaled * 4294967296.0);
+            if (table[g].scaled < 1.0)
+                work[small++] = g;
+            else
+                work[--large] = g;
+        }
+        while (small > 0)
+            table[work[--small]].threshold = (u64)1 << 32;
+        while (large < columns)
+            table[work[large++]].threshold = (u64)1 << 32;
+
+        allocator->Deallocate(work);
+
+        // A column from the low half of the random value, column or alias from the high half
+        u64 s0[Lanes], s1[Lanes];
+        Load(s0, s1);
+        for (s64 i = 0; i < count; i += Lanes)
+        {
+            const s32 block = (count - i) < Lanes ? (s32)(count - i) : (s32)Lanes;
+            for (s32 j = 0; j < block; ++j)
+            {
+                // Branch free, 'other' is all ones when the alias is taken
+                const u64 r      = Step(s0[j], s1[j]);
+                const u32 column = MapRange((u32)r, (u32)columns);
+                const u32 other  = (u32)0 - (u32)((r >> 32) >= table[column].threshold);
+                keys[i + j]      = column ^ ((column ^ alias[column]) & other);
+            }
+
+            for (s32 j = 0; j < block; ++j)
+            {
+                if (keys[i + j] != (u32)head)
+                    continue;
+
+                // Invert the integral of the tail for a uniform mass in [0, tail_mass)
+                const double m = ((double)Next32() / 4294967296.0) * tail_mass;
+                const double x = harmonic ? a * std::exp(m) : std::pow(a1s + m * (1.0 - s), 1.0 / (1.0 - s));
+                u64          k = (u64)(x + 0.5);
+                if (k <= (u64)head)
+                    k = head + 1;
+                if (k > n)
+                    k = n;
+                keys[i + j] = (u32)(k - 1);
+            }
+        }
+        Store(s0, s1);
+
+        allocator->Deallocate(alias);
+        allocator->Deallocate(table);
+    }
+
+    // Stratified: key i is drawn from the i-th of 'count' equal parts of [lo, hi], which keeps the keys ordered.
+    // Positions are in 32.32 fixed point, the width of a part is rounded down so the keys never pass 'hi'.
+    void Generator::Sorted(u32* keys, s64 count, u32 lo, u32 hi)
+    {
+        BM_CHECK(lo <= hi && count > 0);
+        u64 step = (u64)((((double)(hi - lo) + 1.0) * 4294967296.0) / (double)count);
+        if (step > 0)
+            step -= 1;
+        const u32 step_hi = (u32)(step >> 32);
+        const u32 step_lo = (u32)step;
+
+        // The position of a key is the start of the block plus a fixed offset per key in the block
+        u64 offsets[Lanes * 2];
+        for (s32 j = 0; j < Lanes * 2; ++j)
+            offsets[j] = (u64)j * step;
+
+        Random(keys, count);
+        u64 position = 0;
+        s64 i        = 0;
+        for (; (i + Lanes * 2) <= count; i += Lanes * 2)
+        {
+            for (s32 j = 0; j < Lanes * 2; ++j)
+            {
+                const u64 jitter = (u64)keys[i + j] * step_hi + (((u64)keys[i + j] * step_lo) >> 32);
+                keys[i + j]      = lo + (u32)((position + offsets[j] + jitter) >> 32);
+            }
+            position += offsets[Lanes * 2 - 1] + step;
+        }
+        for (; i < count; ++i)
+        {
+            const u64 jitter = (u64)keys[i] * step_hi + (((u64)keys[i] * step_lo) >> 32);
+            keys[i]          = lo + (u32)((position + jitter) >> 32);
+            position += step;
+        }
+    }
+
+    void Generator::ReverseSorted(u32* keys, s64 count, u32 lo, u32 hi)
+    {
+        Sorted(keys, count, lo, hi);
+        for (s64 i = 0, j = count - 1; i < j; ++i, --j)
+        {
+            const u32 t = keys[i];
+            keys[i]     = keys[j];
+            keys[j]     = t;
+        }
+    }
+
+    void Generator::FewUnique(Allocator* allocator, u32* keys, s64 count, u32 unique, u32 lo, u32 hi)
+    {
+        BM_CHECK(unique > 0);
+        u32* values = (u32*)allocator->Allocate(sizeof(u32) * unique);
+        Uniform(values, unique, lo, hi);
+
+        Random(keys, count);
+        for (s64 i = 0; i < count; ++i)
+            keys[i] = values[MapRange(keys[i], unique)];
+
+        allocator->Deallocate(values);
+    }
+
+    s64 Generator::Strings(char* buffer, s64 size, s32 min_length, s32 max_length)
+    {
+        BM_CHECK(min_length >= 0 && min_length <= max_length);
+
+        // First fill the whole buffer with letters, 8 at a time
+        u64 s0[Lanes], s1[Lanes];
+        Load(s0, s1);
+        s64 i = 0;
+        for (; (i + Lanes * (s64)sizeof(u64)) <= size; i += Lanes * (s64)sizeof(u64))
+        {
+            for (s32 j = 0; j < Lanes; ++j)
+            {
+                const u64 letters = MapLetters(Step(s0[j], s1[j]));
+                memcpy(buffer + i + j * sizeof(u64), &letters, sizeof(u64));
+            }
+        }
+        Store(s0, s1);
+        for (; i < size; ++i)
+            buffer[i] = MapLetter((u8)Next32());
+
+        // Then cut it into strings
+        const u32 range = (u32)(max_length - min_length) + 1;
+        s64       count = 0;
+        s64       pos   = 0;
+        while (pos < size)
+        {
+            const s64 length = min_length + MapRange(Next32(), range);
+            if ((pos + length) >= size)
+                break;
+            pos += length;
+            buffer[pos++] = '\0';
+            count += 1;
+        }
+
+        // Whatever is left is not a full string
+        for (; pos < size; ++pos)
+            buffer[pos] = '\0';
+        return count;
+    }
+
+    // Sattolo's algorithm, a Fisher-Yates shuffle that only produces a single cycle
+    void Generator::PointerChase(u32* next, s64 count)
+    {
+        BM_CHECK(count > 0 && count <= (s64)0xFFFFFFFF);
+        for (s64 i = 0; i < count; ++i)
+            next[i] = (u32)i;
+        for (s64 i = count - 1; i > 0; --i)
+        {
+            const s64 j = MapRange(Next32(), (u32)i);
+            const u32 t = next[i];
+            next[i]     = next[j];
+            next[j]     = t;
+        }
+    }
+
+} // namespace BenchMark
@@ -23,6 +23,17 @@ namespace BenchMark
         benchmark_repetitions                = 1;
         benchmark_enable_random_interleaving = false;
         benchmark_random_interleaving_seed   = 0x533DFE9E9A0A2F8BULL;
+        benchmark_global_interleaving        = false;
+        benchmark_interleaving_memory        = (s64)512 * 1024 * 1024;
+        benchmark_cache_file                 = nullptr;
+        benchmark_cache_max_age              = 7.0 * 24.0 * 60.0 * 60.0;
+        benchmark_checkpoint_file            = nullptr;
+        benchmark_resume                     = false;
+        benchmark_isolation                  = BenchMarkIsolation::None;
+        benchmark_shard_index                = 0;
+        benchmark_shard_count                = 1;
+        benchmark_shard_workers              = 0;
+        benchmark_builtin_suites             = BuiltinSuite::None;
     }
 
     BenchMarkRunResult::BenchMarkRunResult()
@@ -32,7 +43,13 @@ namespace BenchMark
         , cpu_time_used(0.0)
         , manual_time_used(0.0)
         , complexity_n(0)
+        , complexity_m(0)
+        , cold_time_used(0.0)
+        , cold_iterations(0)
+        , warm_time_used(0.0)
+        , warm_iterations(0)
         , counters()
+        , latency()
         , skipped_(Skipped::NotSkipped)
         , report_format_(nullptr)
         , report_value_(0.0)
@@ -48,7 +65,13 @@ namespace BenchMark
         cpu_time_used    = 0.0;
         manual_time_used = 0.0;
         complexity_n     = 0;
+        complexity_m     = 0;
+        cold_time_used   = 0.0;
+        cold_iterations  = 0;
+        warm_time_used   = 0.0;
+        warm_iterations  = 0;
         counters.Clear();
+        latency.Reset();
         skipped_       = Skipped::NotSkipped;
         report_format_ = nullptr;
         report_value_  = 0.0;
@@ -60,9 +83,15 @@ namespace BenchMark
         Reset();
         if (instance->counters() != nullptr)
             counters.Initialize(alloc, instance->counters()->Size());
+        if (instance->arrival_rate() > 0.0 || instance->inflight() > 0)
+            latency.Initialize(alloc);
     }
 
-    void BenchMarkRunResult::Shutdown() { counters.Release(); }
+    void BenchMarkRunResult::Shutdown()
+    {
+        counters.Release();
+        latency.Release();
+    }
 
     void BenchMarkRunResult::Merge(const BenchMarkRunResult& other)
     {
@@ -71,7 +100,13 @@ namespace BenchMark
         real_time_used += other.real_time_used;
         manual_time_used += other.manual_time_used;
         complexity_n += other.complexity_n;
+        complexity_m += other.complexity_m;
+        cold_time_used += other.cold_time_used;
+        cold_iterations += other.cold_iterations;
+        warm_time_used += other.warm_time_used;
+        warm_iterations += other.warm_iterations;
         Counters::Increment(counters, other.counters);
+        latency.Merge(other.latency);
 
         // TODO
 
@@ -90,17 +125,31 @@ namespace BenchMark
         , benchmark_(nullptr)
         , args_(nullptr)
         , threads_(1)
+        , arrival_rate_(0.0)
+        , inflight_(0)
+        , suite_data_(nullptr)
+        , fixture_data_(nullptr)
     {
+        for (s32 i = 0; i < BenchMarkUnit::Max_Args; ++i)
+            arg_names_[i] = nullptr;
     }
 
     void BenchMarkInstance::run(BenchMarkState& state, Allocator* allocator) const { benchmark_->run_(state, allocator); }
 
-    void BenchMarkInstance::initialize(ForwardAllocator* allocator, BenchMarkUnit* benchmark, Array<s32> const& args, int thread_count)
+    void BenchMarkInstance::initialize(ForwardAllocator* allocator, BenchMarkUnit* benchmark, Array<s64> const& args, int thread_count, double arrival_rate, s32 inflight, void const* suite_data, void const* fixture_data)
     {
-        benchmark_ = benchmark;
-        threads_   = (thread_count);
+        benchmark_    = benchmark;
+        threads_      = (thread_count);
+        arrival_rate_ = arrival_rate;
+        inflight_     = inflight;
+        suite_data_   = suite_data;
+        fixture_data_ = fixture_data;
         args_.Copy(allocator, args);
 
+        // Names are resolved here once, state.Arg(name) only has to look through this table
+        for (s32 i = 0; i < BenchMarkUnit::Max_Args; ++i)
+            arg_names_[i] = (i < args_.Size() && i < benchmark_->args_count_) ? benchmark_->args_[i].name_ : nullptr;
+
         // 'Reserve' enough memory for the name and parts.
         const s32 nameSize       = 511;
         char*     str            = allocator->Checkout<char>(nameSize + 1);
@@ -127,7 +176,23 @@ namespace BenchMark
                     str = gStringFormatAppend(str, strEnd, "%s:", benchmark_->args_[i].name_);
                 }
 
-                str = gStringFormatAppend(str, strEnd, "%d", args_[i]);
+                str = gStringFormatAppend(str, strEnd, "%lld", (long long)args_[i]);
+            }
+            if (arrival_rate_ > 0.0)
+            {
+                if (str > name_.args)
+                {
+                    str = gStringAppend(str, strEnd, '/');
+                }
+                str = gStringFormatAppend(str, strEnd, "rate:%g", arrival_rate_);
+            }
+            if (inflight_ > 0)
+            {
+                if (str > name_.args)
+                {
+                    str = gStringAppend(str, strEnd, '/');
+                }
+                str = gStringFormatAppend(str, strEnd, "inflight:%d", inflight_);
             }
             str = gStringAppendTerminator(str, strEnd);
 
@@ -0,0 +1,525 @@
+#include "ccore/c_debug.h"
+
+#include "cbenchmark/private/c_benchmark_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+#    include <immintrin.h>
+#    if defined(_MSC_VER)
+#        include <intrin.h>
+#        define BM_TARGET_AVX2
+#        define BM_TARGET_AVX512
+#    else
+#        define BM_TARGET_AVX2   __attribute__((target("avx2")))
+#        define BM_TARGET_AVX512 __attribute__((target("avx512f")))
+#    endif
+#    define BM_KERNELS_X86
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#    include <arm_neon.h>
+#    define BM_KERNELS_NEON
+#endif
+
+namespace BenchMark
+{
+    // The bucket of a value, clamped to [0, last] (a NaN ends up in bucket 0, like it does in the SIMD kernels)
+    static inline s32 sBucketOf(double value, double lo, double scale, double last)
+    {
+        double b = (value - lo) * scale;
+        b        = b > 0.0 ? b : 0.0;
+        b        = b < last ? b : last;
+        return (s32)b;
+    }
+
+    // ---------------------------------------------------------------------------------------------------------------
+    // Scalar
+
+    static double sSumScalar(double const* data, s64 count)
+    {
+        double sum = 0.0;
+        for (s64 i = 0; i < count; ++i)
+            sum += data[i];
+        return sum;
+    }
+
+    static double sSumSquaresScalar(double const* data, s64 count)
+    {
+        double sum = 0.0;
+        for (s64 i = 0; i < count; ++i)
+            sum += data[i] * data[i];
+        return sum;
+    }
+
+    static const double kInfinity = std::numeric_limits<double>::infinity();
+
+    static void sMinMaxScalar(double const* data, s64 count, double& min, double& max)
+    {
+        // A NaN never compares less or greater, so it is skipped
+        min = count > 0 ? kInfinity : 0.0;
+        max = count > 0 ? -kInfinity : 0.0;
+        for (s64 i = 0; i < count; ++i)
+        {
+            min = data[i] < min ? data[i] : min;
+            max = data[i] > max ? data[i] : max;
+        }
+    }
+
+    static void sHistogramScalar(double const* data, s64 count, double lo, double scale, u64* counts, s32 num_buckets)
+    {
+        const double last = (double)(num_buckets - 1);
+        for (s64 i = 0; i < count; ++i)
+            counts[sBucketOf(data[i], lo, scale, last)] += 1;
+    }
+
+    static const StatisticsKernels kScalarKernels = {"scalar", sSumScalar, sSumSquaresScalar, sMinMaxScalar, sHistogramScalar};
+
+#if defined(BM_KERNELS_X86)
+
+    // ---------------------------------------------------------------------------------------------------------------
+    // AVX2, 4 doubles per vector, two vectors per step to hide the latency of the adds
+
+    BM_TARGET_AVX2 static double sHorizontalSum(__m256d v)
+    {
+        __m128d const sum = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+    }
+
+    BM_TARGET_AVX2 static double sSumAvx2(double const* data, s64 count)
+    {
+        __m256d a = _mm256_setzero_pd();
+        __m256d b = _mm256_setzero_pd();
+        s64     i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            a = _mm256_add_pd(a, _mm256_loadu_pd(data + i));
+            b = _mm256_add_pd(b, _mm256_loadu_pd(data + i + 4));
+        }
+        return sHorizontalSum(_mm256_add_pd(a, b)) + sSumScalar(data + i, count - i);
+    }
+
+    BM_TARGET_AVX2 static double sSumSquaresAvx2(double const* data, s64 count)
+    {
+        __m256d a = _mm256_setzero_pd();
+        __m256d b = _mm256_setzero_pd();
+        s64     i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256d const x = _mm256_loadu_pd(data + i);
+            __m256d const y = _mm256_loadu_pd(data + i + 4);
+            a               = _mm256_add_pd(a, _mm256_mul_pd(x, x));
+            b               = _mm256_add_pd(b, _mm256_mul_pd(y, y));
+        }
+        return sHorizontalSum(_mm256_add_pd(a, b)) + sSumSquaresScalar(data + i, count - i);
+    }
+
+    // The lanes start at +/- infinity, min/max return the second operand (the lane) when the value is a NaN
+    BM_TARGET_AVX2 static void sMinMaxLanes(__m256d lo, __m256d hi, double const* data, s64 i, s64 count, double& min, double& max)
+    {
+        double lanes_lo[4];
+        double lanes_hi[4];
+        _mm256_storeu_pd(lanes_lo, lo);
+        _mm256_storeu_pd(lanes_hi, hi);
+        min = lanes_lo[0];
+        max = lanes_hi[0];
+        for (s32 l = 1; l < 4; ++l)
+        {
+            min = lanes_lo[l] < min ? lanes_lo[l] : min;
+            max = lanes_hi[l] > max ? lanes_hi[l] : max;
+        }
+        for (; i < count; ++i)
+        {
+            min = data[i] < min ? data[i] : min;
+            max = data[i] > max ? data[i] : max;
+        }
+    }
+
+    BM_TARGET_AVX2 static void sMinMaxAvx2(double const* data, s64 count, double& min, double& max)
+    {
+        if (count < 8)
+        {
+            sMinMaxScalar(data, count, min, max);
+            return;
+        }
+
+        __m256d lo = _mm256_set1_pd(kInfinity);
+        __m256d hi = _mm256_set1_pd(-kInfinity);
+        s64     i  = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m256d const x = _mm256_loadu_pd(data + i);
+            lo              = _mm256_min_pd(x, lo);
+            hi              = _mm256_max_pd(x, hi);
+        }
+        sMinMaxLanes(lo, hi, data, i, count, min, max);
+    }
+
+    BM_TARGET_AVX2 static void sHistogramAvx2(double const* data, s64 count, double lo, double scale, u64* counts, s32 num_buckets)
+    {
+        // The buckets are computed 4 at a time, the counts are incremented one by one (values can share a bucket).
+        // The bucket indices are moved to general registers as pairs, a round trip through memory is slower than
+        // the scalar kernel.
+        __m256d const vlo    = _mm256_set1_pd(lo);
+        __m256d const vscale = _mm256_set1_pd(scale);
+        __m256d const vzero  = _mm256_setzero_pd();
+        __m256d const vlast  = _mm256_set1_pd((double)(num_buckets - 1));
+
+        s64 i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m256d b = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(data + i), vlo), vscale);
+            b         = _mm256_min_pd(_mm256_max_pd(b, vzero), vlast);
+
+            __m128i const index = _mm256_cvttpd_epi32(b);
+            u64 const     i01   = (u64)_mm_cvtsi128_si64(index);
+            u64 const     i23   = (u64)_mm_extract_epi64(index, 1);
+            counts[(u32)i01] += 1;
+            counts[i01 >> 32] += 1;
+            counts[(u32)i23] += 1;
+            counts[i23 >> 32] += 1;
+        }
+        sHistogramScalar(data + i, count - i, lo, scale, counts, num_buckets);
+    }
+
+    static const StatisticsKernels kAvx2Kernels = {"avx2", sSumAvx2, sSumSquaresAvx2, sMinMaxAvx2, sHistogramAvx2};
+
+    // ---------------------------------------------------------------------------------------------------------------
+    // AVX-512, 8 doubles per vector
+    // NOTE: The intrinsics of GCC 12 start from _mm512_undefined_pd/_mm256_undefined_pd (self-initialized), which
+    //       warns about an uninitialized '__Y' in functions with a target attribute.
+
+#    if defined(__GNUC__) && !defined(__clang__)
+#        pragma GCC diagnostic push
+#        pragma GCC diagnostic ignored "-Wuninitialized"
+#        pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#    endif
+
+    BM_TARGET_AVX512 static double sSumAvx512(double const* data, s64 count)
+    {
+        __m512d a = _mm512_setzero_pd();
+        __m512d b = _mm512_setzero_pd();
+        s64     i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            a = _mm512_add_pd(a, _mm512_loadu_pd(data + i));
+            b = _mm512_add_pd(b, _mm512_loadu_pd(data + i + 8));
+        }
+        return _mm512_reduce_add_pd(_mm512_add_pd(a, b)) + sSumScalar(data + i, count - i);
+    }
+
+    BM_TARGET_AVX512 static double sSumSquaresAvx512(double const* data, s64 count)
+    {
+        __m512d a = _mm512_setzero_pd();
+        __m512d b = _mm512_setzero_pd();
+        s64     i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m512d const x = _mm512_loadu_pd(data + i);
+            __m512d const y = _mm512_loadu_pd(data + i + 8);
+            a               = _mm512_add_pd(a, _mm512_mul_pd(x, x));
+            b               = _mm512_add_pd(b, _mm512_mul_pd(y, y));
+        }
+        return _mm512_reduce_add_pd(_mm512_add_pd(a, b)) + sSumSquaresScalar(data + i, count - i);
+    }
+
+    BM_TARGET_AVX512 static void sMinMaxAvx512(double const* data, s64 count, double& min, double& max)
+    {
+        if (count < 16)
+        {
+            sMinMaxScalar(data, count, min, max);
+            return;
+        }
+
+        __m512d lo = _mm512_set1_pd(kInfinity);
+        __m512d hi = _mm512_set1_pd(-kInfinity);
+        s64     i  = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m512d const x = _mm512_loadu_pd(data + i);
+            lo              = _mm512_min_pd(x, lo);
+            hi              = _mm512_max_pd(x, hi);
+        }
+
+        // Down to 4 lanes, then the lanes as in the AVX2 kernel
+        __m256d const lo4 = _mm256_min_pd(_mm512_castpd512_pd256(lo), _mm512_extractf64x4_pd(lo, 1));
+        __m256d const hi4 = _mm256_max_pd(_mm512_castpd512_pd256(hi), _mm512_extractf64x4_pd(hi, 1));
+        sMinMaxLanes(lo4, hi4, data, i, count, min, max);
+    }
+
+    BM_TARGET_AVX512 static void sHistogramAvx512(double const* data, s64 count, double lo, double scale, u64* counts, s32 num_buckets)
+    {
+        __m512d const vlo    = _mm512_set1_pd(lo);
+        __m512d const vscale = _mm512_set1_pd(scale);
+        __m512d const vzero  = _mm512_setzero_pd();
+        __m512d const vlast  = _mm512_set1_pd((double)(num_buckets - 1));
+
+        s64 i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m512d b = _mm512_mul_pd(_mm512_sub_pd(_mm512_loadu_pd(data + i), vlo), vscale);
+            b         = _mm512_min_pd(_mm512_max_pd(b, vzero), vlast);
+
+            // See the AVX2 kernel, the bucket indices go to general registers as pairs
+            __m256i const index = _mm512_cvttpd_epi32(b);
+            __m128i const lo4   = _mm256_castsi256_si128(index);
+            __m128i const hi4   = _mm256_extracti128_si256(index, 1);
+            u64 const     i01   = (u64)_mm_cvtsi128_si64(lo4);
+            u64 const     i23   = (u64)_mm_extract_epi64(lo4, 1);
+            u64 const     i45   = (u64)_mm_cvtsi128_si64(hi4);
+            u64 const     i67   = (u64)_mm_extract_epi64(hi4, 1);
+            counts[(u32)i01] += 1;
+            counts[i01 >> 32] += 1;
+            counts[(u32)i23] += 1;
+            counts[i23 >> 32] += 1;
+            counts[(u32)i45] += 1;
+            counts[i45 >> 32] += 1;
+            counts[(u32)i67] += 1;
+            counts[i67 >> 32] += 1;
+        }
+        sHistogramScalar(data + i, count - i, lo, scale, counts, num_buckets);
+    }
+
+#    if defined(__GNUC__) && !defined(__clang__)
+#        pragma GCC diagnostic pop
+#    endif
+
+    static const StatisticsKernels kAvx512Kernels = {"avx512", sSumAvx512, sSumSquaresAvx512, sMinMaxAvx512, sHistogramAvx512};
+
+    static void sCpuFeatures(bool& avx2, bool& avx512)
+    {
+#    if defined(_MSC_VER)
+        // The CPU has to support them and the OS has to save the registers (XCR0)
+        int regs[4];
+        __cpuid(regs, 0);
+        const int max_leaf = regs[0];
+        __cpuid(regs, 1);
+        const bool os_saves_ymm = (regs[2] & (1 << 27)) != 0 && (regs[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+        const bool os_saves_zmm = os_saves_ymm && (_xgetbv(0) & 0xE6) == 0xE6;
+        avx2                    = false;
+        avx512                  = false;
+        if (max_leaf >= 7 && os_saves_ymm)
+        {
+            __cpuidex(regs, 7, 0);
+            avx2   = (regs[1] & (1 << 5)) != 0;
+            avx512 = os_saves_zmm && (regs[1] & (1 << 16)) != 0;
+        }
+#    else
+        __builtin_cpu_init();
+        avx2   = __builtin_cpu_supports("avx2") != 0;
+        avx512 = __builtin_cpu_supports("avx512f") != 0;
+#    endif
+    }
+
+#elif defined(BM_KERNELS_NEON)
+
+    // ---------------------------------------------------------------------------------------------------------------
+    // NEON, 2 doubles per vector, two vectors per step
+
+    static double sSumNeon(double const* data, s64 count)
+    {
+        float64x2_t a = vdupq_n_f64(0.0);
+        float64x2_t b = vdupq_n_f64(0.0);
+        s64         i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            a = vaddq_f64(a, vld1q_f64(data + i));
+            b = vaddq_f64(b, vld1q_f64(data + i + 2));
+        }
+        return vaddvq_f64(vaddq_f64(a, b)) + sSumScalar(data + i, count - i);
+    }
+
+    static double sSumSquaresNeon(double const* data, s64 count)
+    {
+        float64x2_t a = vdupq_n_f64(0.0);
+        float64x2_t b = vdupq_n_f64(0.0);
+        s64         i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            float64x2_t const x = vld1q_f64(data + i);
+            float64x2_t const y = vld1q_f64(data + i + 2);
+            a                   = vaddq_f64(a, vmulq_f64(x, x));
+            b                   = vaddq_f64(b, vmulq_f64(y, y));
+        }
+        return vaddvq_f64(vaddq_f64(a, b)) + sSumSquaresScalar(data + i, count - i);
+    }
+
+    static void sMinMaxNeon(double const* data, s64 count, double& min, double& max)
+    {
+        if (count < 4)
+        {
+            sMinMaxScalar(data, count, min, max);
+            return;
+        }
+
+        // minNum/maxNum, a NaN is skipped like it is by the scalar kernel
+        float64x2_t lo = vdupq_n_f64(kInfinity);
+        float64x2_t hi = vdupq_n_f64(-kInfinity);
+        s64         i  = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            float64x2_t const x = vld1q_f64(data + i);
+            lo                  = vminnmq_f64(lo, x);
+            hi                  = vmaxnmq_f64(hi, x);
+        }
+
+        min = vminnmvq_f64(lo);
+        max = vmaxnmvq_f64(hi);
+        for (; i < count; ++i)
+        {
+            min = data[i] < min ? data[i] : min;
+            max = data[i] > max ? data[i] : max;
+        }
+    }
+
+    static void sHistogramNeon(double const* data, s64 count, double lo, double scale, u64* counts, s32 num_buckets)
+    {
+        float64x2_t const vlo    = vdupq_n_f64(lo);
+        float64x2_t const vscale = vdupq_n_f64(scale);
+        float64x2_t const vzero  = vdupq_n_f64(0.0);
+        float64x2_t const vlast  = vdupq_n_f64((double)(num_buckets - 1));
+
+        s64 i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            float64x2_t b = vmulq_f64(vsubq_f64(vld1q_f64(data + i), vlo), vscale);
+            b             = vminq_f64(vmaxq_f64(b, vzero), vlast);
+            int64x2_t const index = vcvtq_s64_f64(b);
+            counts[vgetq_lane_s64(index, 0)] += 1;
+            counts[vgetq_lane_s64(index, 1)] += 1;
+        }
+        sHistogramScalar(data + i, count - i, lo, scale, counts, num_buckets);
+    }
+
+    static const StatisticsKernels kNeonKernels = {"neon", sSumNeon, sSumSquaresNeon, sMinMaxNeon, sHistogramNeon};
+
+#endif
+
+    static StatisticsKernels const* sSelectKernels()
+    {
+#if defined(BM_KERNELS_X86)
+        bool avx2   = false;
+        bool avx512 = false;
+        sCpuFeatures(avx2, avx512);
+        if (avx512)
+            return &kAvx512Kernels;
+        if (avx2)
+            return &kAvx2Kernels;
+#elif defined(BM_KERNELS_NEON)
+        return &kNeonKernels;
+#endif
+        return &kScalarKernels;
+    }
+
+    StatisticsKernels const& gStatisticsKernels()
+    {
+        static StatisticsKernels const* kernels = nullptr;
+        if (kernels == nullptr)
+            kernels = sSelectKernels();
+        return *kernels;
+    }
+
+    StatisticsKernels const& gScalarStatisticsKernels() { return kScalarKernels; }
+
+    // ---------------------------------------------------------------------------------------------------------------
+    // Selection
+
+    static const s64 kSelectDirect  = 4096; // Up to this many values a copy is partially sorted
+    static const s32 kSelectBuckets = 2048;
+
+    double gStatisticsSelect(Allocator* allocator, StatisticsKernels const& kernels, double const* data, s64 count, s64 k)
+    {
+        ASSERT(k >= 0 && k < count);
+
+        // Every round narrows the values down to those in the bucket of the k-th, 'values' is not the input
+        // after the first round. With a NaN the order is the one nth_element makes of it, so those are copied and
+        // partially sorted whatever their number (a NaN makes the sum a NaN).
+        double const* values = data;
+        double        result = 0.0;
+        bool          direct = count <= kSelectDirect || std::isnan(kernels.sum(data, count));
+        for (;;)
+        {
+            if (direct)
+            {
+                double* copy = allocator->Alloc<double>(sizeof(double) * count);
+                if (copy == nullptr)
+                {
+                    // Cannot happen after the first round, the values of the bucket were copied
+                    result = values[k];
+                    break;
+                }
+                memcpy(copy, values, sizeof(double) * count);
+                std::nth_element(copy, copy + k, copy + count);
+                result = copy[k];
+                allocator->Deallocate(copy);
+                break;
+            }
+
+            double lo = 0.0;
+            double hi = 0.0;
+            kernels.min_max(values, count, lo, hi);
+            if (!(lo < hi))
+            {
+                // All the same
+                result = lo;
+                break;
+            }
+
+            // An infinity (or a range beyond the largest double) puts every value in the first bucket, and a range
+            // close to 0 makes the scale infinite, the buckets would never narrow the values down
+            const double scale = (double)kSelectBuckets / (hi - lo);
+            if (!std::isfinite(hi - lo) || !std::isfinite(scale) || !(scale > 0.0))
+            {
+                direct = true;
+                continue;
+            }
+
+            u64* counts = allocator->Alloc<u64>(sizeof(u64) * kSelectBuckets);
+            if (counts == nullptr)
+            {
+                result = lo + (hi - lo) * ((double)k / (double)(count - 1));
+                break;
+            }
+            memset(counts, 0, sizeof(u64) * kSelectBuckets);
+
+            kernels.histogram(values, count, lo, scale, counts, kSelectBuckets);
+
+            s32 bucket = 0;
+            s64 below  = 0;
+            while (below + (s64)counts[bucket] <= k)
+                below += (s64)counts[bucket++];
+            const s64 in_bucket = (s64)counts[bucket];
+            allocator->Deallocate(counts);
+
+            double* bucket_values = allocator->Alloc<double>(sizeof(double) * in_bucket);
+            if (bucket_values == nullptr)
+            {
+                result = lo + ((double)bucket + 0.5) / scale;
+                break;
+            }
+
+            // Same bucket function as the kernels, so exactly 'in_bucket' values
+            const double last = (double)(kSelectBuckets - 1);
+            s64          n    = 0;
+            for (s64 i = 0; i < count && n < in_bucket; ++i)
+            {
+                if (sBucketOf(values[i], lo, scale, last) == bucket)
+                    bucket_values[n++] = values[i];
+            }
+            ASSERT(n == in_bucket);
+
+            if (values != data)
+                allocator->Deallocate((void*)values);
+            values = bucket_values;
+            count  = n;
+            direct = count <= kSelectDirect;
+            k -= below;
+        }
+
+        if (values != data)
+            allocator->Deallocate((void*)values);
+        return result;
+    }
+
+} // namespace BenchMark
@@ -0,0 +1,126 @@
+#include "cbenchmark/private/c_benchmark_openloop.h"
+#include "cbenchmark/private/c_benchmark_enums.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace BenchMark
+{
+    void LatencyHistogram::Initialize(Allocator* alloc)
+    {
+        allocator = alloc;
+        counts    = alloc->Alloc<u64>(sizeof(u64) * Buckets);
+        Reset();
+    }
+
+    void LatencyHistogram::Release()
+    {
+        if (allocator != nullptr && counts != nullptr)
+            allocator->Deallocate(counts);
+        allocator = nullptr;
+        counts    = nullptr;
+        count     = 0;
+        max       = 0;
+    }
+
+    void LatencyHistogram::Reset()
+    {
+        if (counts != nullptr)
+            memset(counts, 0, sizeof(u64) * Buckets);
+        count = 0;
+        max   = 0;
+    }
+
+    void LatencyHistogram::Merge(LatencyHistogram const& other)
+    {
+        if (counts == nullptr || other.counts == nullptr)
+            return;
+        for (s32 i = 0; i < Buckets; ++i)
+            counts[i] += other.counts[i];
+        count += other.count;
+        if (other.max > max)
+            max = other.max;
+    }
+
+    s32 LatencyHistogram::IndexOf(u64 ns)
+    {
+        if (ns < SubBuckets)
+            return (s32)ns;
+
+        s32 msb = SubBits;
+        while (msb < 63 && (ns >> (msb + 1)) != 0)
+            ++msb;
+        if (msb > MaxBits)
+            return Buckets - 1;
+
+        // [2^msb, 2^(msb+1)) is split into SubBuckets buckets of 2^shift
+        s32 const shift = msb - SubBits;
+        return (shift + 1) * SubBuckets + (s32)((ns >> shift) - SubBuckets);
+    }
+
+    u64 LatencyHistogram::ValueOf(s32 index)
+    {
+        if (index < SubBuckets)
+            return (u64)index;
+        s32 const shift = index / SubBuckets - 1;
+        u64 const lower = (u64)(index % SubBuckets + SubBuckets) << shift;
+        return lower + (((u64)1 << shift) >> 1);
+    }
+
+    double LatencyHistogram::Percentile(double p) const
+    {
+        if (counts == nullptr || count == 0)
+            return 0.0;
+        if (p >= 1.0)
+            return (double)max * 1e-9;
+
+        u64 const rank = (u64)std::ceil(p * (double)count);
+        u64       seen = 0;
+        for (s32 i = 0; i < Buckets; ++i)
+        {
+            seen += counts[i];
+            if (seen >= rank && seen > 0)
+            {
+                // The bucket covers the maximum, it cannot be larger than that
+                u64 const value = ValueOf(i);
+                return (double)(value < max ? value : max) * 1e-9;
+            }
+        }
+        return (double)max * 1e-9;
+    }
+
+    ArrivalTimeline::ArrivalTimeline(s32 arrival, double interval, double phase, u64 seed)
+        : gen_(seed)
+        , arrival_(arrival)
+        , interval_(interval)
+        , last_(phase - (arrival == Arrival::Constant ? interval : 0.0))
+        , cursor_(BlockSize)
+    {
+    }
+
+    void ArrivalTimeline::Refill()
+    {
+        if (arrival_ == Arrival::Poisson)
+        {
+            // Exponentially distributed intervals, -ln(1 - u) * mean with u uniform in [0, 1)
+            u64 random[BlockSize];
+            gen_.Random(random, BlockSize);
+            for (s32 i = 0; i < BlockSize; ++i)
+            {
+                double const u = (double)(random[i] >> 11) * (1.0 / 9007199254740992.0);
+                last_ += -std::log(1.0 - u) * interval_;
+                times_[i] = last_;
+            }
+        }
+        else
+        {
+            for (s32 i = 0; i < BlockSize; ++i)
+            {
+                last_ += interval_;
+                times_[i] = last_;
+            }
+        }
+        cursor_ = 0;
+    }
+
+} // namespace BenchMark
@@ -44,12 +44,32 @@ namespace BenchMark
     {
         /* TO BE IMPLEMENTED */
         name_field_width_ = context.name_field_width;
-        printed_header_   = false;
+        if (!context.continue_table)
+            printed_header_ = false;
 
         // PrintBasicContext(*error_stream_, context);
         return true;
     }
 
+    void ConsoleReporter::ReportSetup(const char* name, double seconds, ForwardAllocator* allocator, ScratchAllocator* scratch)
+    {
+        USE_SCRATCH(scratch);
+
+        const s32   max_line_width = 256;
+        char* const line           = scratch->Alloc<char>(max_line_width + 1);
+        line[max_line_width]       = '\0';
+
+        char*             outStr    = line;
+        const char* const outStrEnd = &line[max_line_width];
+        outStr                      = gStringFormatAppend(outStr, outStrEnd, "Setup of %s", name);
+        outStr                      = gStringFormatAppend(outStr, outStrEnd, " took %.3f s", seconds);
+        outStr                      = gStringAppendTerminator(outStr, outStrEnd);
+
+        (output_stream_ << line).endl();
+
+        scratch->Deallocate(line);
+    }
+
     void ConsoleReporter::ReportRuns(Array<BenchMarkRun*> const& reports, ForwardAllocator* allocator, ScratchAllocator* scratch)
     {
         for (s32 i = 0; i < reports.Size(); ++i)
@@ -88,11 +108,24 @@ namespace BenchMark
         outStr                      = gStringAppendTerminator(outStr, outStrEnd);
 
         const char* const line       = outStr;
-        auto              name_color = (result.report_big_o || result.report_rms) ? COLOR_BLUE : COLOR_GREEN;
+        auto              name_color = (result.report_big_o || result.report_rms || result.report_scaling || result.report_curve || result.report_compare) ? COLOR_BLUE : COLOR_GREEN;
         // name_color
         outStr = gStringFormatAppend(outStr, outStrEnd, nameWidthFormat, name);
 
-        // TODO print 'skipped with error' or 'skipped with message'
+        if (result.skipped.IsSkipped())
+        {
+            // printer(Out, COLOR_RED, "ERROR OCCURRED: \'%s\'", result.skip_message);
+            outStr = gStringAppend(outStr, outStrEnd, result.skipped.Is(Skipped::SkippedWithError) ? "ERROR OCCURRED: '" : "SKIPPED: '");
+            outStr = gStringAppend(outStr, outStrEnd, result.skip_message != nullptr ? result.skip_message : "");
+            outStr = gStringAppend(outStr, outStrEnd, '\'');
+            outStr = gStringAppendTerminator(outStr, outStrEnd);
+
+            (output_stream_ << line).endl();
+
+            scratch->Deallocate(nameWidthFormat);
+            scratch->Deallocate(name);
+            return;
+        }
 
         const double real_time = result.GetAdjustedRealTime();
         const double cpu_time  = result.GetAdjustedCPUTime();
@@ -115,6 +148,27 @@ namespace BenchMark
             outStr = gStringFormatAppend(outStr, outStrEnd, "%10.0f ", cpu_time * 100);
             outStr = gStringFormatAppend(outStr, outStrEnd, "%-4s ", "%");
         }
+        else if (result.report_scaling)
+        {
+            // The speedup and the parallel efficiency of a thread count
+            outStr = gStringFormatAppend(outStr, outStrEnd, "%10.2f ", result.real_accumulated_time);
+            outStr = gStringFormatAppend(outStr, outStrEnd, "%-4s ", "x");
+            outStr = gStringFormatAppend(outStr, outStrEnd, "%10.0f ", result.cpu_accumulated_time * 100);
+            outStr = gStringFormatAppend(outStr, outStrEnd, "%-4s ", "%");
+        }
+        else if (result.report_compare)
+        {
+            // The ratio of the time per iteration to that of the baseline and the relative difference
+            outStr = gStringFormatAppend(outStr, outStrEnd, "%10.3f ", result.real_accumulated_time);
+            outStr = gStringFormatAppend(outStr, outStrEnd, "%-4s ", "x");
+            outStr = gStringFormatAppend(outStr, outStrEnd, "%+10.1f ", result.cpu_accumulated_time * 100);
+            outStr = gStringFormatAppend(outStr, outStrEnd, "%-4s ", "%");
+        }
+        else if (result.report_curve)
+        {
+            // The offered and achieved rates and the latencies are counters
+            outStr = gStringFormatAppend(outStr, outStrEnd, "%32s", "");
+        }
         else if (result.run_type != BenchMarkRun::RT_Aggregate || result.aggregate_unit.unit == StatisticUnit::Time)
         {
             const char* timeLabel = result.time_unit.ToString();
@@ -136,11 +190,16 @@ namespace BenchMark
             outStr = gStringFormatAppend(outStr, outStrEnd, "%-4s ", "%");
         }
 
-        if (!result.report_big_o && !result.report_rms)
+        if (!result.report_big_o && !result.report_rms && !result.report_scaling && !result.report_curve && !result.report_compare)
         {
             // printer(Out, COLOR_CYAN, "%10lld", result.iterations);
             outStr = gStringFormatAppend(outStr, outStrEnd, "%10lld", result.iterations);
         }
+        else if (result.report_scaling || result.report_curve || result.report_compare)
+        {
+            // No iterations, keep the counters under their header
+            outStr = gStringFormatAppend(outStr, outStrEnd, "%10s", "");
+        }
 
         if (result.counters.Size() > 0)
         {
@@ -161,6 +220,17 @@ namespace BenchMark
                     outStr2 = gStringFormatAppend(outStr2, outStr2End, "%.2f", 100. * c.value);
                     unit    = "%";
                 }
+                else if (result.report_curve && (c.flags.flags & CounterFlags::IsRate) == 0)
+                {
+                    // A latency of a curve, already in the time unit of the run
+                    outStr2 = gStringFormatAppend(outStr2, outStr2End, "%.3f", c.value);
+                    unit    = result.time_unit.ToString();
+                }
+                else if (result.report_scaling || result.report_compare || result.report_big_o)
+                {
+                    // The fitted parameters and ratios are fractions, a SI prefix would hide their magnitude
+                    outStr2 = gStringFormatAppend(outStr2, outStr2End, "%.3g", c.value);
+                }
                 else
                 {
                     outStr2 = gHumanReadableNumber(outStr2, outStr2End, c.value, c.flags.OneK());
@@ -193,6 +263,74 @@ namespace BenchMark
             outStr = gStringAppend(outStr, outStrEnd, ' ');
             outStr = gStringFormatAppend(outStr, outStrEnd, result.report_format, result.report_value);
         }
+        if (result.numa_nodes.Size() > 0)
+        {
+            // The NUMA node of the arena of every thread, e.g. " numa:0/0/1/1"
+            outStr = gStringAppend(outStr, outStrEnd, " numa:");
+            for (s32 i = 0; i < result.numa_nodes.Size(); ++i)
+            {
+                if (i > 0)
+                    outStr = gStringAppend(outStr, outStrEnd, '/');
+                outStr = gStringFormatAppend(outStr, outStrEnd, "%d", (int)result.numa_nodes[i]);
+            }
+        }
+        if (result.cold_iterations > 0)
+        {
+            // Cache::Cold, the time of a cold iteration next to that of a warm one, e.g. " cold:1.234 us warm:0.123 us"
+            const char*  timeLabel  = result.time_unit.ToString();
+            const double multiplier = result.time_unit.GetTimeUnitMultiplier();
+            outStr = gStringFormatAppend(outStr, outStrEnd, " cold:%.3f", result.cold_accumulated_time * multiplier / (double)result.cold_iterations);
+            outStr = gStringFormatAppend(outStr, outStrEnd, " %s", timeLabel);
+            if (result.warm_iterations > 0)
+            {
+                outStr = gStringFormatAppend(outStr, outStrEnd, " warm:%.3f", result.warm_accumulated_time * multiplier / (double)result.warm_iterations);
+                outStr = gStringFormatAppend(outStr, outStrEnd, " %s", timeLabel);
+            }
+        }
+        if ((result.arrival_rate > 0.0 || result.inflight > 0) && result.run_type == BenchMarkRun::RT_Iteration && result.skipped.IsNotSkipped())
+        {
+            // Open loop or asynchronous, the offered rate or the in-flight depth, the achieved rate and the latency percentiles, e.g.
+            // " offered:10k/s achieved:9.98k/s p50:1.234 p90:2.345 p99:12.345 p99.9:45.678 max:123.456 us"
+            // " inflight:16 achieved:250k/s p50:61.234 p90:62.345 p99:80.345 p99.9:95.678 max:123.456 us"
+            char* const rateStr        = scratch->Alloc<char>(64 + 1);
+            rateStr[64]                = '\0';
+            const char* const rateEnd  = &rateStr[64];
+            const double      achieved = result.real_accumulated_time > 0.0 ? (double)result.iterations / result.real_accumulated_time : 0.0;
+            const double      multiplier = result.time_unit.GetTimeUnitMultiplier();
+
+            if (result.arrival_rate > 0.0)
+            {
+                gStringAppendTerminator(gHumanReadableNumber(rateStr, rateEnd, result.arrival_rate, 1000.0), rateEnd);
+                outStr = gStringFormatAppend(outStr, outStrEnd, " offered:%s/s", rateStr);
+            }
+            if (result.inflight > 0)
+                outStr = gStringFormatAppend(outStr, outStrEnd, " inflight:%d", (int)result.inflight);
+            gStringAppendTerminator(gHumanReadableNumber(rateStr, rateEnd, achieved, 1000.0), rateEnd);
+            outStr = gStringFormatAppend(outStr, outStrEnd, " achieved:%s/s", rateStr);
+            outStr = gStringFormatAppend(outStr, outStrEnd, " p50:%.3f", result.latency_p50 * multiplier);
+            outStr = gStringFormatAppend(outStr, outStrEnd, " p90:%.3f", result.latency_p90 * multiplier);
+            outStr = gStringFormatAppend(outStr, outStrEnd, " p99:%.3f", result.latency_p99 * multiplier);
+            outStr = gStringFormatAppend(outStr, outStrEnd, " p99.9:%.3f", result.latency_p999 * multiplier);
+            outStr = gStringFormatAppend(outStr, outStrEnd, " max:%.3f", result.latency_max * multiplier);
+            outStr = gStringFormatAppend(outStr, outStrEnd, " %s", result.time_unit.ToString());
+            scratch->Deallocate(rateStr);
+        }
+        if (result.page_size > 0)
+        {
+            // The size of the pages that back the arenas, e.g. " pages:2M"
+            s64 const kb = result.page_size / 1024;
+            if (kb >= 1024 * 1024)
+                outStr = gStringFormatAppend(outStr, outStrEnd, " pages:%dG", (int)(kb / (1024 * 1024)));
+            else if (kb >= 1024)
+                outStr = gStringFormatAppend(outStr, outStrEnd, " pages:%dM", (int)(kb / 1024));
+            else
+                outStr = gStringFormatAppend(outStr, outStrEnd, " pages:%dK", (int)kb);
+        }
+        if (result.cached)
+        {
+            // The run is from the result cache (see 'benchmark_cache_file'), it did not run now
+            outStr = gStringAppend(outStr, outStrEnd, " (cached)");
+        }
         outStr = gStringAppendTerminator(outStr, outStrEnd);
 
         (output_stream_ << line).endl();
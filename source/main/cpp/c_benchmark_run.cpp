@@ -13,6 +13,8 @@
 #include "cbenchmark/private/c_benchmark_statistics.h"
 #include "cbenchmark/private/c_benchmark_allocators.h"
 
+#include <cstring>
+
 namespace BenchMark
 {
     const char* BenchMarkRun::BenchMarkName(Allocator* alloc)
@@ -51,4 +53,234 @@ namespace BenchMark
             new_time /= static_cast<double>(iterations);
         return new_time;
     }
-} // namespace BenchMark
\ No newline at end of file
+
+    template <typename T> static u8* sEncode(u8* dst, u8 const* dstEnd, T const& value)
+    {
+        if (dst == nullptr || (dstEnd - dst) < (s64)sizeof(T))
+            return nullptr;
+        memcpy(dst, &value, sizeof(T));
+        return dst + sizeof(T);
+    }
+
+    template <typename T> static u8 const* sDecode(u8 const* src, u8 const* srcEnd, T& value)
+    {
+        if (src == nullptr || (srcEnd - src) < (s64)sizeof(T))
+            return nullptr;
+        memcpy(&value, src, sizeof(T));
+        return src + sizeof(T);
+    }
+
+    static const u32 kRunEncodingMagic = 0x4E555242; // 'BRUN'
+
+    // A string by value, its length (-1 for null) followed by its characters
+    static s64 sStringSize(const char* str) { return sizeof(s32) + (str != nullptr ? gStringLength(str) : 0); }
+
+    // The characters of a restored string including its terminator, see BenchMarkRun::strings
+    static s32 sStringChars(const char* str) { return str != nullptr ? gStringLength(str) + 1 : 0; }
+
+    static u8* sPersistString(u8* dst, u8 const* dstEnd, const char* str)
+    {
+        const s32 length = str != nullptr ? gStringLength(str) : -1;
+        dst              = sEncode(dst, dstEnd, length);
+        if (dst == nullptr || length <= 0)
+            return dst;
+        if (dstEnd - dst < length)
+            return nullptr;
+        memcpy(dst, str, length);
+        return dst + length;
+    }
+
+    static u8 const* sRestoreString(u8 const* src, u8 const* srcEnd, char*& chars, char const* charsEnd, const char*& str)
+    {
+        str        = nullptr;
+        s32 length = 0;
+        src        = sDecode(src, srcEnd, length);
+        if (src == nullptr || length < 0)
+            return src;
+        if (srcEnd - src < length || charsEnd - chars < length + 1)
+            return nullptr;
+
+        memcpy(chars, src, length);
+        chars[length] = '\0';
+        str           = chars;
+        chars += length + 1;
+        return src + length;
+    }
+
+    s64 BenchMarkRun::PersistedSize() const
+    {
+        s64 size = sizeof(u32) + sizeof(s32) + sizeof(s32) + sizeof(aggregate_unit.unit) + sizeof(double) + sizeof(skipped.skipped);
+        size += sizeof(IterationCount) + 3 * sizeof(s64) + sizeof(time_unit.flags) + 3 * sizeof(double);
+        size += sizeof(complexity.bigo) + 2 * sizeof(s64) + 2 * sizeof(u8) + sizeof(double);
+        size += sizeof(s32) + counters.Size() * (sizeof(CounterFlags::flags) + sizeof(double));
+        size += sizeof(s32) + numa_nodes.Size() * sizeof(s32);
+        size += sizeof(s64);
+        size += 2 * (sizeof(double) + sizeof(IterationCount));
+        size += 6 * sizeof(double);
+        size += sizeof(s64);
+        size += sStringSize(aggregate_name) + sStringSize(report_format) + sStringSize(skip_message);
+        for (s32 i = 0; i < counters.Size(); ++i)
+            size += sStringSize(counters.counters[i].name);
+        return size;
+    }
+
+    u8* BenchMarkRun::Persist(u8* dst, u8 const* dstEnd) const
+    {
+        s32 chars = sStringChars(aggregate_name) + sStringChars(report_format) + sStringChars(skip_message);
+        for (s32 i = 0; i < counters.Size(); ++i)
+            chars += sStringChars(counters.counters[i].name);
+
+        dst = sEncode(dst, dstEnd, kRunEncodingMagic);
+        dst = sEncode(dst, dstEnd, chars);
+        dst = sEncode(dst, dstEnd, (s32)run_type);
+        dst = sEncode(dst, dstEnd, aggregate_unit.unit);
+        dst = sEncode(dst, dstEnd, report_value);
+        dst = sEncode(dst, dstEnd, skipped.skipped);
+
+        dst = sEncode(dst, dstEnd, iterations);
+        dst = sEncode(dst, dstEnd, threads);
+        dst = sEncode(dst, dstEnd, repetition_index);
+        dst = sEncode(dst, dstEnd, repetitions);
+        dst = sEncode(dst, dstEnd, time_unit.flags);
+        dst = sEncode(dst, dstEnd, real_accumulated_time);
+        dst = sEncode(dst, dstEnd, cpu_accumulated_time);
+        dst = sEncode(dst, dstEnd, max_heapbytes_used);
+
+        dst = sEncode(dst, dstEnd, complexity.bigo);
+        dst = sEncode(dst, dstEnd, complexity_n);
+        dst = sEncode(dst, dstEnd, complexity_m);
+        dst = sEncode(dst, dstEnd, (u8)(report_big_o ? 1 : 0));
+        dst = sEncode(dst, dstEnd, (u8)(report_rms ? 1 : 0));
+        dst = sEncode(dst, dstEnd, allocs_per_iter);
+
+        dst = sEncode(dst, dstEnd, counters.Size());
+        for (s32 i = 0; i < counters.Size(); ++i)
+        {
+            Counter const& c = counters.counters[i];
+            dst              = sEncode(dst, dstEnd, c.flags.flags);
+            dst              = sEncode(dst, dstEnd, c.value);
+        }
+
+        dst = sEncode(dst, dstEnd, numa_nodes.Size());
+        for (s32 i = 0; i < numa_nodes.Size(); ++i)
+            dst = sEncode(dst, dstEnd, numa_nodes[i]);
+
+        dst = sEncode(dst, dstEnd, page_size);
+        dst = sEncode(dst, dstEnd, cold_accumulated_time);
+        dst = sEncode(dst, dstEnd, cold_iterations);
+        dst = sEncode(dst, dstEnd, warm_accumulated_time);
+        dst = sEncode(dst, dstEnd, warm_iterations);
+        dst = sEncode(dst, dstEnd, arrival_rate);
+        dst = sEncode(dst, dstEnd, latency_p50);
+        dst = sEncode(dst, dstEnd, latency_p90);
+        dst = sEncode(dst, dstEnd, latency_p99);
+        dst = sEncode(dst, dstEnd, latency_p999);
+        dst = sEncode(dst, dstEnd, latency_max);
+        dst = sEncode(dst, dstEnd, inflight);
+
+        dst = sPersistString(dst, dstEnd, aggregate_name);
+        dst = sPersistString(dst, dstEnd, report_format);
+        dst = sPersistString(dst, dstEnd, skip_message);
+        for (s32 i = 0; i < counters.Size(); ++i)
+            dst = sPersistString(dst, dstEnd, counters.counters[i].name);
+        return dst;
+    }
+
+    u8 const* BenchMarkRun::Restore(Allocator* alloc, u8 const* src, u8 const* srcEnd)
+    {
+        u32 magic = 0;
+        s32 chars = 0;
+        src       = sDecode(src, srcEnd, magic);
+        src       = sDecode(src, srcEnd, chars);
+        if (src == nullptr || magic != kRunEncodingMagic || chars < 0 || chars > srcEnd - src)
+            return nullptr;
+
+        s32 type  = 0;
+        u8  big_o = 0;
+        u8  rms   = 0;
+
+        src = sDecode(src, srcEnd, type);
+        src = sDecode(src, srcEnd, aggregate_unit.unit);
+        src = sDecode(src, srcEnd, report_value);
+        src = sDecode(src, srcEnd, skipped.skipped);
+
+        src = sDecode(src, srcEnd, iterations);
+        src = sDecode(src, srcEnd, threads);
+        src = sDecode(src, srcEnd, repetition_index);
+        src = sDecode(src, srcEnd, repetitions);
+        src = sDecode(src, srcEnd, time_unit.flags);
+        src = sDecode(src, srcEnd, real_accumulated_time);
+        src = sDecode(src, srcEnd, cpu_accumulated_time);
+        src = sDecode(src, srcEnd, max_heapbytes_used);
+
+        src = sDecode(src, srcEnd, complexity.bigo);
+        src = sDecode(src, srcEnd, complexity_n);
+        src = sDecode(src, srcEnd, complexity_m);
+        src = sDecode(src, srcEnd, big_o);
+        src = sDecode(src, srcEnd, rms);
+        src = sDecode(src, srcEnd, allocs_per_iter);
+
+        run_type     = type == RT_Aggregate ? RT_Aggregate : RT_Iteration;
+        report_big_o = big_o != 0;
+        report_rms   = rms != 0;
+
+        // The complexity function is of the process that ran the benchmark, the receiver takes it from the instance
+        complexity_lambda = nullptr;
+
+        s32 num_counters = 0;
+        src              = sDecode(src, srcEnd, num_counters);
+        if (src == nullptr || num_counters < 0)
+            return nullptr;
+
+        counters.Initialize(alloc, num_counters);
+        for (s32 i = 0; i < num_counters; ++i)
+        {
+            Counter c;
+            c.name = nullptr;
+            src    = sDecode(src, srcEnd, c.flags.flags);
+            src    = sDecode(src, srcEnd, c.value);
+            if (src == nullptr)
+                return nullptr;
+            counters.counters.PushBack(c);
+        }
+
+        s32 num_nodes = 0;
+        src           = sDecode(src, srcEnd, num_nodes);
+        if (src == nullptr || num_nodes < 0)
+            return nullptr;
+
+        numa_nodes.Init(alloc, 0, num_nodes);
+        for (s32 i = 0; i < num_nodes; ++i)
+        {
+            s32 node = 0;
+            src      = sDecode(src, srcEnd, node);
+            if (src == nullptr)
+                return nullptr;
+            numa_nodes.PushBack(node);
+        }
+
+        src = sDecode(src, srcEnd, page_size);
+        src = sDecode(src, srcEnd, cold_accumulated_time);
+        src = sDecode(src, srcEnd, cold_iterations);
+        src = sDecode(src, srcEnd, warm_accumulated_time);
+        src = sDecode(src, srcEnd, warm_iterations);
+        src = sDecode(src, srcEnd, arrival_rate);
+        src = sDecode(src, srcEnd, latency_p50);
+        src = sDecode(src, srcEnd, latency_p90);
+        src = sDecode(src, srcEnd, latency_p99);
+        src = sDecode(src, srcEnd, latency_p999);
+        src = sDecode(src, srcEnd, latency_max);
+        src = sDecode(src, srcEnd, inflight);
+
+        // The strings are copied into one block that the run owns
+        strings.Init(alloc, chars, chars);
+        char*       str    = strings.Begin();
+        char const* strEnd = strings.End();
+        src                = sRestoreString(src, srcEnd, str, strEnd, aggregate_name);
+        src                = sRestoreString(src, srcEnd, str, strEnd, report_format);
+        src                = sRestoreString(src, srcEnd, str, strEnd, skip_message);
+        for (s32 i = 0; i < counters.Size(); ++i)
+            src = sRestoreString(src, srcEnd, str, strEnd, counters.counters[i].name);
+        return src;
+    }
+} // namespace BenchMark
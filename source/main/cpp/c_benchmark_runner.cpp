@@ -15,8 +15,11 @@
 #include "cbenchmark/private/c_benchmark_instance.h"
 #include "cbenchmark/private/c_benchmark_state.h"
 #include "cbenchmark/private/c_benchmark_statistics.h"
+#include "cbenchmark/private/c_process.h"
+#include "cbenchmark/private/c_memory.h"
 
 #include <cmath>
+#include <cstring>
 
 #include "c_benchmark_thread_manager.cc"
 
@@ -24,6 +27,7 @@ namespace BenchMark
 {
     static constexpr IterationCount kMaxIterations  = 1000000000;
     static constexpr double         kDefaultMinTime = 1.0;
+    static constexpr s64            kMaxRunRecordSize = 64 * 1024; // Anything larger did not come from SendRepetition
 
     void CreateRunReport(ForwardAllocator* allocator, BenchMarkRun* report, const BenchMarkInstance* bmi, const BenchMarkRunResult& results, IterationCount memory_iterations, double seconds, s64 repetition_index, s64 repeats)
     {
@@ -52,10 +56,22 @@ namespace BenchMark
             {
                 report->real_accumulated_time = results.real_time_used;
             }
-            report->cpu_accumulated_time = results.cpu_time_used;
-            report->complexity_n         = results.complexity_n;
-            report->complexity           = bmi->complexity();
-            report->complexity_lambda    = bmi->complexity_lambda();
+            report->cpu_accumulated_time  = results.cpu_time_used;
+            report->complexity_n          = results.complexity_n;
+            report->complexity_m          = results.complexity_m;
+            report->cold_accumulated_time = results.cold_time_used;
+            report->cold_iterations       = results.cold_iterations;
+            report->warm_accumulated_time = results.warm_time_used;
+            report->warm_iterations       = results.warm_iterations;
+            report->arrival_rate          = bmi->arrival_rate();
+            report->inflight              = bmi->inflight();
+            report->latency_p50           = results.latency.Percentile(0.5);
+            report->latency_p90           = results.latency.Percentile(0.9);
+            report->latency_p99           = results.latency.Percentile(0.99);
+            report->latency_p999          = results.latency.Percentile(0.999);
+            report->latency_max           = results.latency.Percentile(1.0);
+            report->complexity            = bmi->complexity();
+            report->complexity_lambda     = bmi->complexity_lambda();
             report->statistics.Copy(allocator, bmi->statistics());
             report->counters.Copy(allocator, results.counters);
 
@@ -65,12 +81,35 @@ namespace BenchMark
 
     // Execute one thread of benchmark bmi for the specified number of iterations.
     // Adds the stats collected for the thread into manager->results.
-    void RunInThread(ForwardAllocator* allocator, const BenchMarkInstance* bmi, IterationCount iters, int thread_id, ThreadManager* manager, BenchMarkRunResult* results)
+    // When 'arena' is not null the thread initializes its own allocator from it (NumaPolicy::Local).
+    // 'sweep' is the buffer that is read to evict the last level cache (Cache::Flush and Cache::Cold).
+    // 'async_slots' is the memory for the slots of BM_ITERATE_ASYNC of this thread (see BenchMarkState::AsyncSlotsSize).
+    void RunInThread(ForwardAllocator* allocator, Allocator* arena, const BenchMarkInstance* bmi, BenchMarkSharedData* shared_data, u8 const* sweep, s64 sweep_size, u8* async_slots, u64 seed, IterationCount iters, int thread_id, ThreadManager* manager, BenchMarkRunResult* results)
     {
+        if (arena != nullptr)
+            allocator->Initialize(arena, bmi->memory_required());
+
+        // Bring the arena of this thread into the cache state the benchmark asks for (see BM_CACHE)
+        if (bmi->cache() == Cache::Warm)
+            gWarmCache(allocator->Buffer(), allocator->Size());
+        else if (bmi->cache() == Cache::Flush || bmi->cache() == Cache::Cold)
+            gFlushCache(allocator->Buffer(), allocator->Size());
+
         ThreadTimer timer(ThreadTimer::Create());
 
         BenchMarkState st;
-        st.InitRun(allocator, bmi->name().function_name, iters, bmi->args(), bmi->counters()->Size(), thread_id, bmi->threads(), &timer, manager, results);
+        st.InitRun(allocator, bmi->name().function_name, iters, bmi->args(), bmi->arg_names(), bmi->counters()->Size(), thread_id, bmi->threads(), &timer, manager, results);
+        st.InitData(bmi->suite_data(), bmi->fixture_data(), shared_data, seed);
+        st.InitCache(bmi->cache(), sweep, sweep_size);
+
+        // Open loop, the threads share the arrival rate and every thread has its own timeline. With a
+        // constant rate the threads are spread over one interval, otherwise they would start together.
+        const double    rate     = bmi->arrival_rate();
+        const double    interval = rate > 0.0 ? (double)bmi->threads() / rate : 0.0;
+        ArrivalTimeline timeline(bmi->arrival(), interval, rate > 0.0 ? (double)thread_id / rate : 0.0, seed + 0x9E3779B97F4A7C15ULL * (u64)(thread_id + 1));
+        if (rate > 0.0)
+            st.InitArrival(&timeline);
+        st.InitAsync(bmi->inflight(), async_slots);
 
         bmi->run(st, allocator);
 
@@ -81,6 +120,7 @@ namespace BenchMark
             results->real_time_used += timer.real_time_used();
             results->manual_time_used += timer.manual_time_used();
             results->complexity_n += st.GetComplexityLengthN();
+            results->complexity_m += st.GetComplexityLengthM();
             Counters::Increment(results->counters, st.counters_);
         }
         st.Shutdown();
@@ -120,6 +160,9 @@ namespace BenchMark
         int            GetNumRepeats() const { return repeats; }
         bool           HasRepeatsRemaining() const { return GetNumRepeats() != num_repetitions_done; }
         void           DoOneRepetition(ForwardAllocator* allocator, ScratchAllocator* scratch, BenchMarkRun* report, BenchMarkReporter::PerFamilyRunReports* reports_for_family);
+        bool           ReceiveRepetition(ChildProcess& child, ForwardAllocator* allocator, ScratchAllocator* scratch, BenchMarkRun* report, BenchMarkReporter::PerFamilyRunReports* reports_for_family);
+        void           ReplayRepetition(ForwardAllocator* allocator, BenchMarkRun* report, BenchMarkReporter::PerFamilyRunReports* reports_for_family);
+        void           CompleteRepetition(BenchMarkRun* report, BenchMarkReporter::PerFamilyRunReports* reports_for_family);
         void           AggregateResults(ForwardAllocator* alloc, ScratchAllocator* scratch, const Array<BenchMarkRun*>& non_aggregates, Array<BenchMarkRun*>& aggregates_only) const;
         double         GetMinTime() const { return min_time; }
         bool           HasExplicitIters() const { return has_explicit_iteration_count; }
@@ -129,6 +172,13 @@ namespace BenchMark
         ForwardAllocator*        forward_allocator_;
         ScratchAllocator*        scratch_allocator_;
         BenchMarkInstance const* instance;
+        BenchMarkSharedData      shared_data; // Built by the first thread, released after the last repetition
+        Array<s32>               numa_nodes;  // The NUMA node of the arena of every thread (NumaPolicy::Local and Node)
+        s64                      page_size;   // The smallest page size backing the arenas (BM_PAGES), 0 = not asked for
+        u8*                      sweep;       // Buffer larger than the last level cache, swept to evict it (Cache::Flush and Cold)
+        s64                      sweep_size;
+        u64                      seed;        // Seed for the inputs, see BenchMarkState::Seed()
+        RepetitionStatistics     statistics;  // Of the repetitions that completed, see ComputeStats
 
         BenchTimeType benchtime_flag;
         double        min_time;
@@ -136,6 +186,7 @@ namespace BenchMark
         bool          warmup_done;
         int           repeats;
         bool          has_explicit_iteration_count;
+        bool          has_predicted_iteration_count; // By a repetition in this process, a child, a cache or a checkpoint
         int           num_repetitions_done = 0;
 
         void* operator new(u64 num_bytes, void* mem) { return mem; }
@@ -182,7 +233,15 @@ namespace BenchMark
     // Public Interface
     BenchMarkRunner* CreateRunner(Allocator* a) { return a->Construct<BenchMarkRunner>(); }
     void             InitRunner(BenchMarkRunner* r, Allocator* a, ScratchAllocator* t, BenchMarkGlobals* globals, const BenchMarkInstance* b_) { r->Init(a, t, globals, b_); }
-    void             DestroyRunner(BenchMarkRunner*& r, Allocator* a) { a->Destruct(r); }
+    void             DestroyRunner(BenchMarkRunner*& r, Allocator* a)
+    {
+        r->shared_data.Release();
+        r->numa_nodes.Release();
+        r->statistics.Release();
+        if (r->sweep != nullptr)
+            r->main_allocator_->Deallocate(r->sweep);
+        a->Destruct(r);
+    }
 
     void InitRunResults(BenchMarkRunner* r, BenchMarkGlobals* globals, RunResults* results)
     {
@@ -199,26 +258,43 @@ namespace BenchMark
     int    GetNumRepeats(const BenchMarkRunner* r) { return r->GetNumRepeats(); }
     bool   HasRepeatsRemaining(const BenchMarkRunner* r) { return r->HasRepeatsRemaining(); }
     void   DoOneRepetition(BenchMarkRunner* r, ForwardAllocator* allocator, ScratchAllocator* scratch, BenchMarkRun* report, BenchMarkReporter::PerFamilyRunReports* reports_for_family) { r->DoOneRepetition(allocator, scratch, report, reports_for_family); }
+    bool   ReceiveRepetition(BenchMarkRunner* r, ChildProcess& child, ForwardAllocator* allocator, ScratchAllocator* scratch, BenchMarkRun* report, BenchMarkReporter::PerFamilyRunReports* reports_for_family) { return r->ReceiveRepetition(child, allocator, scratch, report, reports_for_family); }
+    void   ReplayRepetition(BenchMarkRunner* r, ForwardAllocator* allocator, BenchMarkRun* report, BenchMarkReporter::PerFamilyRunReports* reports_for_family) { r->ReplayRepetition(allocator, report, reports_for_family); }
     void   AggregateResults(BenchMarkRunner* r, ForwardAllocator* alloc, ScratchAllocator* scratch, const Array<BenchMarkRun*>& non_aggregates, Array<BenchMarkRun*>& aggregates_only) { r->AggregateResults(alloc, scratch, non_aggregates, aggregates_only); }
     double GetMinTime(const BenchMarkRunner* r) { return r->GetMinTime(); }
     bool   HasExplicitIters(const BenchMarkRunner* r) { return r->HasExplicitIters(); }
     IterationCount GetIters(const BenchMarkRunner* r) { return r->GetIters(); }
+    s64            GetMemoryHeld(const BenchMarkInstance* b)
+    {
+        // See Init, the sweep buffer is twice the size of the last level cache
+        s64 size = b->shared_memory_required();
+        if (b->cache() == Cache::Flush || b->cache() == Cache::Cold)
+            size += 2 * gLastLevelCacheSize();
+        return size;
+    }
     void           StartStopBarrier(ThreadManager* tm) { tm->StartStopBarrier(); }
     void           ThreadTimerStart(ThreadTimer* timer) { timer->StartTimer(); }
     void           ThreadTimerStop(ThreadTimer* timer) { timer->StopTimer(); }
     bool           ThreadTimerIsRunning(ThreadTimer* timer) { return timer->IsRunning(); }
     void           ThreadTimerSetIterationTime(ThreadTimer* timer, double seconds) { timer->SetIterationTime(seconds); }
+    double         ThreadTimerRealTimeUsed(ThreadTimer* timer) { return timer->real_time_used(); }
+    double         RealTimeNow() { return ChronoClockNow(); }
 
     BenchMarkRunner::BenchMarkRunner()
         : main_allocator_(nullptr)
         , scratch_allocator_(nullptr)
         , instance(nullptr)
+        , page_size(0)
+        , sweep(nullptr)
+        , sweep_size(0)
+        , seed(0)
         , benchtime_flag(BenchTimeType())
         , min_time(0.0)
         , min_warmup_time(0.0)
         , warmup_done(false)
         , repeats(0)
         , has_explicit_iteration_count(false)
+        , has_predicted_iteration_count(false)
         , thread_pool()
         , iters(0)
     {
@@ -226,17 +302,29 @@ namespace BenchMark
 
     void BenchMarkRunner::Init(Allocator* allocator, ScratchAllocator* scratch, BenchMarkGlobals* globals, const BenchMarkInstance* b_)
     {
-        main_allocator_              = (allocator);
-        scratch_allocator_           = (scratch);
-        instance                     = (b_);
-        benchtime_flag               = (BenchTimeType(globals->benchmark_min_time));
-        min_time                     = (ComputeMinTime(b_, benchtime_flag));
-        min_warmup_time              = ((!gIsZero(instance->min_time()) && instance->min_warmup_time() > 0.0) ? instance->min_warmup_time() : globals->benchmark_min_warmup_time);
-        warmup_done                  = (!(min_warmup_time > 0.0));
-        repeats                      = (instance->repetitions() != 0 ? instance->repetitions() : globals->benchmark_repetitions);
-        has_explicit_iteration_count = (instance->iterations() != 0 || benchtime_flag.type == BenchTimeType::ITERS);
+        main_allocator_               = (allocator);
+        scratch_allocator_            = (scratch);
+        instance                      = (b_);
+        benchtime_flag                = (BenchTimeType(globals->benchmark_min_time));
+        min_time                      = (ComputeMinTime(b_, benchtime_flag));
+        min_warmup_time               = ((!gIsZero(instance->min_time()) && instance->min_warmup_time() > 0.0) ? instance->min_warmup_time() : globals->benchmark_min_warmup_time);
+        warmup_done                   = (!(min_warmup_time > 0.0));
+        repeats                       = (instance->repetitions() != 0 ? instance->repetitions() : globals->benchmark_repetitions);
+        has_explicit_iteration_count  = (instance->iterations() != 0 || benchtime_flag.type == BenchTimeType::ITERS);
+        has_predicted_iteration_count = false;
 
         iters = (has_explicit_iteration_count ? ComputeIters(*instance, benchtime_flag) : 1);
+
+        shared_data.Initialize(main_allocator_, instance->shared_memory_required());
+        if (instance->numa_policy() == NumaPolicy::Local || instance->numa_policy() == NumaPolicy::Node)
+            numa_nodes.Init(main_allocator_, 0, instance->threads());
+        if (instance->cache() == Cache::Flush || instance->cache() == Cache::Cold)
+        {
+            sweep_size = 2 * gLastLevelCacheSize();
+            sweep      = main_allocator_->Alloc<u8>(sweep_size);
+            gTouchPages(sweep, sweep_size);
+        }
+        seed = instance->seed() != 0 ? instance->seed() : globals->benchmark_random_interleaving_seed;
     }
 
     void BenchMarkRunner::DoNIterations(BenchMarkRunner::IterationResults& iteration_results)
@@ -254,29 +342,55 @@ namespace BenchMark
         Array<BenchMarkRunResult*> results;
         results.Init(scratch_allocator_, 0, thread_pool.Capacity());
 
-        // Prepare allocators for each thread
+        // Prepare allocators for each thread. With a NUMA policy or a page size the arenas come directly from
+        // the OS (prefaulted), with NumaPolicy::Local every thread allocates (and first-touches) its own arena.
+        const s32     numa_policy = instance->numa_policy();
+        PageAllocator page_allocator(numa_policy, instance->numa_node(), instance->pages());
+        Allocator*    arena        = (numa_policy == NumaPolicy::Default && instance->pages() == Pages::Default) ? main_allocator_ : &page_allocator;
+        Allocator*    thread_arena = (numa_policy == NumaPolicy::Local) ? arena : nullptr;
+
         Array<ForwardAllocator*> forward_allocators;
         forward_allocators.Init(scratch_allocator_, 0, thread_pool.Capacity() + 1);
         for (s32 ti = 0; ti < thread_pool.Capacity() + 1; ++ti)
         {
             ForwardAllocator* allocator = scratch_allocator_->Construct<ForwardAllocator>();
-            allocator->Initialize(main_allocator_, instance->memory_required());
+            if (thread_arena == nullptr)
+                allocator->Initialize(arena, instance->memory_required());
+            if (arena == main_allocator_)
+                allocator->Prefault();
             forward_allocators.PushBack(allocator);
         }
 
+        // The shared data lives on between runs, the arenas are handled by the threads themselves
+        if (instance->cache() == Cache::Warm && shared_data.built)
+        {
+            gWarmCache(shared_data.arena.Buffer(), shared_data.arena.Size());
+        }
+        else if (instance->cache() == Cache::Flush || instance->cache() == Cache::Cold)
+        {
+            gWarmCache(sweep, sweep_size);
+            if (shared_data.built)
+                gFlushCache(shared_data.arena.Buffer(), shared_data.arena.Size());
+        }
+
+        // The slots of BM_ITERATE_ASYNC do not take from the arenas, every thread has its own cache lines of them
+        const s64 async_stride = (BenchMarkState::AsyncSlotsSize(instance->inflight()) + 63) & ~(s64)63;
+        u8*       async_slots  = (u8*)scratch_allocator_->Allocate(async_stride * (thread_pool.Capacity() + 1), 64);
+
         // Run all but one thread in separate threads
         for (s32 ti = 0; ti < thread_pool.Capacity(); ++ti)
         {
             BenchMarkRunResult*& result = results.Alloc();
             result                      = scratch_allocator_->Construct<BenchMarkRunResult>();
             result->Initialize(scratch_allocator_, instance);
-            thread_pool[ti] = scratch_allocator_->Construct<std::thread>(&RunInThread, forward_allocators[1 + ti], instance, iters, static_cast<int>(ti + 1), manager, result);
+            u8* const thread_slots = async_slots != nullptr ? async_slots + async_stride * (1 + ti) : nullptr;
+            thread_pool[ti]        = scratch_allocator_->Construct<std::thread>(&RunInThread, forward_allocators[1 + ti], thread_arena, instance, &shared_data, sweep, sweep_size, thread_slots, seed, iters, static_cast<int>(ti + 1), manager, result);
         }
 
         // And run one thread here directly and use the results from iteration_results.
         // (If we were asked to run just one thread, we don't create new threads.)
         // Yes, we need to do this here *after* we start the separate threads.
-        RunInThread(forward_allocators[0], instance, iters, 0, manager, &iteration_results.results);
+        RunInThread(forward_allocators[0], thread_arena, instance, &shared_data, sweep, sweep_size, async_slots, seed, iters, 0, manager, &iteration_results.results);
 
         // The main thread has finished. Now let's wait for the other threads.
         manager->WaitForAllThreads();
@@ -290,6 +404,26 @@ namespace BenchMark
         }
         thread_pool.Release();
 
+        // Remember where the arenas of the threads ended up
+        if (numa_nodes.Capacity() > 0)
+        {
+            numa_nodes.Clear();
+            for (s32 ti = 0; ti < forward_allocators.Size(); ++ti)
+                numa_nodes.PushBack(gNumaNodeOf(forward_allocators[ti]->Buffer()));
+        }
+
+        // And the pages they got, the OS may not have been able to give us the (huge) pages we asked for
+        if (instance->pages() != Pages::Default)
+        {
+            page_size = 0;
+            for (s32 ti = 0; ti < forward_allocators.Size(); ++ti)
+            {
+                s64 const size = gPageSizeOf(forward_allocators[ti]->Buffer());
+                if (page_size == 0 || (size != 0 && size < page_size))
+                    page_size = size;
+            }
+        }
+
         // Destroy the allocators.
         for (s32 ti = 0; ti < forward_allocators.Size(); ++ti)
         {
@@ -309,6 +443,9 @@ namespace BenchMark
         }
         results.Release();
 
+        if (async_slots != nullptr)
+            scratch_allocator_->Deallocate(async_slots);
+
         // And get rid of the manager.
         scratch_allocator_->Destruct(manager);
 
@@ -407,7 +544,7 @@ namespace BenchMark
         const IterationCount i_backup = iters;
 
         BenchMarkState state;
-        state.Init(instance->name().function_name, /*iters*/ 1, instance->args(), /*thread_id*/ 0, instance->threads());
+        state.Init(instance->name().function_name, /*iters*/ 1, instance->args(), instance->arg_names(), /*thread_id*/ 0, instance->threads());
 
         for (;;)
         {
@@ -443,8 +580,6 @@ namespace BenchMark
 
         USE_SCRATCH(scratch);
 
-        const bool is_the_first_repetition = num_repetitions_done == 0;
-
         // In case a warmup phase is requested by the benchmark, run it now.
         // After running the warmup phase the BenchMarkRunner should be in a state as
         // this warmup never happened except the fact that warmup_done is set. Every
@@ -463,7 +598,7 @@ namespace BenchMark
         // is *only* calculated for the *first* repetition, and other repetitions
         // simply use that precomputed iteration count.
         BenchMarkState state;
-        state.Init(instance->name().function_name, /*iters*/ 1, instance->args(), /*thread_id*/ 0, instance->threads());
+        state.Init(instance->name().function_name, /*iters*/ 1, instance->args(), instance->arg_names(), /*thread_id*/ 0, instance->threads());
 
         for (;;)
         {
@@ -475,11 +610,12 @@ namespace BenchMark
             instance->teardown()(state);
 
             // Do we consider the results to be significant?
-            // If we are doing repetitions, and the first repetition was already done,
+            // If we are doing repetitions, and an earlier repetition was already done,
             // it has calculated the correct iteration time, so we have run that very
             // iteration count just now. No need to calculate anything. Just report->
-            // Else, the normal rules apply.
-            const bool results_are_significant = !is_the_first_repetition || has_explicit_iteration_count || ShouldReportIterationResults(results);
+            // Else, the normal rules apply. A repetition of which the child process
+            // crashed did not calculate anything.
+            const bool results_are_significant = has_predicted_iteration_count || has_explicit_iteration_count || ShouldReportIterationResults(results);
 
             if (results_are_significant)
                 break; // Good, let's report them!
@@ -492,12 +628,108 @@ namespace BenchMark
         }
 
         state.Shutdown();
+        has_predicted_iteration_count = true;
 
         // Ok, now actually report
         IterationCount memory_iterations = 0;
 
         CreateRunReport(allocator, report, instance, results.results, memory_iterations, results.seconds, num_repetitions_done, repeats);
+        if (numa_nodes.Size() > 0)
+            report->numa_nodes.Copy(allocator, numa_nodes);
+        report->page_size = page_size;
+
+        results.Shutdown();
+
+        CompleteRepetition(report, reports_for_family);
+    }
+
+    void SendRepetition(ChildProcess& child, ScratchAllocator* scratch, const BenchMarkRun* report)
+    {
+        USE_SCRATCH(scratch);
+
+        // A record is the size of the persisted run followed by the persisted run
+        s64 const size   = report->PersistedSize();
+        u8*       buffer = scratch->Alloc<u8>(sizeof(s64) + size);
+        memcpy(buffer, &size, sizeof(s64));
+        u8* end = report->Persist(buffer + sizeof(s64), buffer + sizeof(s64) + size);
+        ASSERTS(end == buffer + sizeof(s64) + size, "Persisted size of the run is not correct");
 
+        // If the parent is gone there is nobody to report to
+        if (!gWriteToParent(child, buffer, sizeof(s64) + size))
+            gExitChild(child);
+
+        scratch->Deallocate(buffer);
+    }
+
+    bool BenchMarkRunner::ReceiveRepetition(ChildProcess& child, ForwardAllocator* allocator, ScratchAllocator* scratch, BenchMarkRun* report, BenchMarkReporter::PerFamilyRunReports* reports_for_family)
+    {
+        ASSERTS(HasRepeatsRemaining(), "Already done all repetitions?");
+
+        USE_SCRATCH(scratch);
+
+        bool received = false;
+        s64  size     = 0;
+        if (gReadFromChild(child, &size, sizeof(s64)) && size > 0 && size <= kMaxRunRecordSize)
+        {
+            u8* buffer = scratch->Alloc<u8>(size);
+            received   = gReadFromChild(child, buffer, size) && report->Restore(allocator, buffer, buffer + size) == buffer + size;
+            scratch->Deallocate(buffer);
+        }
+
+        report->run_name.CopyFrom(allocator, instance->name());
+        if (received)
+        {
+            if (report->skipped.IsNotSkipped())
+                report->statistics.Copy(allocator, instance->statistics());
+            report->complexity_lambda = instance->complexity_lambda();
+
+            // A new child, after this one crashed, uses the iteration count of this repetition
+            if (!has_explicit_iteration_count && report->skipped.IsNotSkipped() && report->iterations > 0)
+            {
+                iters                         = report->iterations / instance->threads();
+                has_predicted_iteration_count = true;
+            }
+        }
+        else
+        {
+            // The child crashed or exited before it reported this repetition
+            report->counters.Release();
+            report->skipped          = Skipped::SkippedWithError;
+            report->skip_message     = "benchmark process exited before reporting";
+            report->iterations       = 0;
+            report->time_unit        = instance->time_unit();
+            report->threads          = instance->threads();
+            report->repetition_index = num_repetitions_done;
+            report->repetitions      = repeats;
+        }
+
+        CompleteRepetition(report, reports_for_family);
+        return received;
+    }
+
+    void BenchMarkRunner::ReplayRepetition(ForwardAllocator* allocator, BenchMarkRun* report, BenchMarkReporter::PerFamilyRunReports* reports_for_family)
+    {
+        ASSERTS(HasRepeatsRemaining(), "Already done all repetitions?");
+
+        // A run from the result cache or a checkpoint, like a run received from a child it lacks what is taken from
+        // the instance
+        report->run_name.CopyFrom(allocator, instance->name());
+        if (report->skipped.IsNotSkipped())
+            report->statistics.Copy(allocator, instance->statistics());
+        report->complexity_lambda = instance->complexity_lambda();
+
+        // The repetitions that still run use the iteration count of the first repetition
+        if (!has_explicit_iteration_count && report->skipped.IsNotSkipped() && report->iterations > 0)
+        {
+            iters                         = report->iterations / instance->threads();
+            has_predicted_iteration_count = true;
+        }
+
+        CompleteRepetition(report, reports_for_family);
+    }
+
+    void BenchMarkRunner::CompleteRepetition(BenchMarkRun* report, BenchMarkReporter::PerFamilyRunReports* reports_for_family)
+    {
         if (reports_for_family)
         {
             ++reports_for_family->num_runs_done;
@@ -505,8 +737,13 @@ namespace BenchMark
                 reports_for_family->runs.PushBack(report);
         }
 
-        results.Shutdown();
+        // The statistics are updated as the repetitions complete, whatever their number they take the same memory
+        statistics.Add(main_allocator_, report);
         ++num_repetitions_done;
+
+        // The shared data of this instance is not needed anymore
+        if (!HasRepeatsRemaining())
+            shared_data.Release();
     }
 
     void BenchMarkRunner::AggregateResults(ForwardAllocator* alloc, ScratchAllocator* scratch, const Array<BenchMarkRun*>& non_aggregates, Array<BenchMarkRun*>& aggregates_only) const
@@ -514,6 +751,6 @@ namespace BenchMark
         ASSERT(!HasRepeatsRemaining() && "Did not run all repetitions yet?");
 
         // Calculate additional statistics over the repetitions of this instance
-        ComputeStats(alloc, scratch, non_aggregates, aggregates_only);
+        ComputeStats(alloc, scratch, non_aggregates, statistics, aggregates_only);
     }
 } // namespace BenchMark
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include "ccore/c_debug.h"
+#include "cbenchmark/private/c_benchmark_scaling.h"
+#include "cbenchmark/private/c_benchmark_run.h"
+#include "cbenchmark/private/c_benchmark_name.h"
+#include "cbenchmark/private/c_benchmark_types.h"
+#include "cbenchmark/private/c_utils.h"
+
+#include <cmath>
+
+namespace BenchMark
+{
+    struct ScalingFit
+    {
+        ScalingFit()
+            : serial(0.0)
+            , contention(0.0)
+            , coherency(0.0)
+            , peak(0.0)
+        {
+        }
+
+        double serial;     // Amdahl, S(N) = N / (1 + serial * (N - 1))
+        double contention; // USL, S(N) = N / (1 + contention * (N - 1) + coherency * N * (N - 1))
+        double coherency;  //
+        double peak;       // USL, the thread count with the highest throughput (0 when there is no coherency cost)
+    };
+
+    // Least squares fit of Amdahl's law and the Universal Scalability Law on the speedups 's' at
+    // thread counts 'n', both laws are linear in their parameters after a change of variables:
+    //   - Amdahl : 1/S - 1/N = serial * (1 - 1/N)
+    //   - USL    : N/S - 1   = contention * (N - 1) + coherency * N * (N - 1)
+    // The parameters are constrained to be non-negative, a super-linear speedup fits as 0.
+    static ScalingFit FitScaling(const Array<double>& n, const Array<double>& s)
+    {
+        double amdahl_xy = 0.0, amdahl_xx = 0.0;
+        double a11 = 0.0, a12 = 0.0, a22 = 0.0, b1 = 0.0, b2 = 0.0;
+        for (s32 i = 0; i < n.Size(); ++i)
+        {
+            const double x = 1.0 - 1.0 / n[i];
+            amdahl_xy += (1.0 / s[i] - 1.0 / n[i]) * x;
+            amdahl_xx += x * x;
+
+            const double x1 = n[i] - 1.0;
+            const double x2 = n[i] * (n[i] - 1.0);
+            const double y  = n[i] / s[i] - 1.0;
+            a11 += x1 * x1;
+            a12 += x1 * x2;
+            a22 += x2 * x2;
+            b1 += x1 * y;
+            b2 += x2 * y;
+        }
+
+        ScalingFit fit;
+        if (amdahl_xx > 0.0)
+            fit.serial = std::fmin(std::fmax(amdahl_xy / amdahl_xx, 0.0), 1.0);
+
+        // With a single thread count (besides 1) the system is under-determined, contention takes it all
+        const double det = a11 * a22 - a12 * a12;
+        if (n.Size() >= 2 && det > 1e-12 * a11 * a22)
+        {
+            fit.contention = (b1 * a22 - b2 * a12) / det;
+            fit.coherency  = (a11 * b2 - a12 * b1) / det;
+        }
+        if (fit.coherency <= 0.0)
+        {
+            fit.coherency  = 0.0;
+            fit.contention = a11 > 0.0 ? b1 / a11 : 0.0;
+        }
+        if (fit.contention < 0.0)
+        {
+            fit.contention = 0.0;
+            fit.coherency  = a22 > 0.0 ? std::fmax(b2 / a22, 0.0) : 0.0;
+        }
+        if (fit.coherency > 0.0 && fit.contention < 1.0)
+            fit.peak = std::sqrt((1.0 - fit.contention) / fit.coherency);
+
+        return fit;
+    }
+
+    void ComputeScaling(Allocator* alloc, ScratchAllocator* scratch, const Array<BenchmarkName const*>& names, const Array<s64>& threads, const Array<double>& throughput, Array<BenchMarkRun*>& scaling)
+    {
+        s32 base = -1;
+        for (s32 i = 0; i < threads.Size(); ++i)
+        {
+            if (threads[i] == 1 && throughput[i] > 0.0)
+                base = i;
+        }
+        if (base < 0 || threads.Size() < 2)
+            return;
+
+        // Deferred 'scope' release of the scratch allocator.
+        USE_SCRATCH(scratch);
+
+        // The speedup of every thread count other than 1
+        Array<double> n;
+        Array<double> speedup;
+        n.Init(scratch, 0, threads.Size());
+        speedup.Init(scratch, 0, threads.Size());
+
+        s32 widest = base;
+        for (s32 i = 0; i < threads.Size(); ++i)
+        {
+            if (i == base || throughput[i] <= 0.0)
+                continue;
+            n.PushBack((double)threads[i]);
+            speedup.PushBack(throughput[i] / throughput[base]);
+            if (threads[i] > threads[widest])
+                widest = i;
+
+            BenchMarkRun*& row         = scaling.Alloc();
+            row                        = alloc->Construct<BenchMarkRun>();
+            row->run_name              = *names[i];
+            row->run_type              = BenchMarkRun::RT_Aggregate;
+            row->aggregate_name        = "speedup";
+            row->repetition_index      = BenchMarkRun::no_repetition_index;
+            row->threads               = threads[i];
+            row->iterations            = 0;
+            row->real_accumulated_time = speedup[speedup.Size() - 1];
+            row->cpu_accumulated_time  = speedup[speedup.Size() - 1] / (double)threads[i];
+            row->report_scaling        = true;
+        }
+        if (n.Empty())
+        {
+            n.Release();
+            speedup.Release();
+            return;
+        }
+
+        const ScalingFit fit = FitScaling(n, speedup);
+
+        const double widest_speedup = throughput[widest] / throughput[base];
+
+        BenchMarkRun*& row         = scaling.Alloc();
+        row                        = alloc->Construct<BenchMarkRun>();
+        row->run_name              = *names[base];
+        row->run_name.threads      = gStringToEnd(row->run_name.threads); // Drop the 'threads', the row covers all of them.
+        row->run_type              = BenchMarkRun::RT_Aggregate;
+        row->aggregate_name        = "scaling";
+        row->repetition_index      = BenchMarkRun::no_repetition_index;
+        row->threads               = threads[widest];
+        row->iterations            = 0;
+        row->real_accumulated_time = widest_speedup;
+        row->cpu_accumulated_time  = widest_speedup / (double)threads[widest];
+        row->report_scaling        = true;
+
+        row->counters.Initialize(alloc, 4);
+        row->counters.counters.PushBack({"serial", {CounterFlags::Defaults}, fit.serial});
+        row->counters.counters.PushBack({"contention", {CounterFlags::Defaults}, fit.contention});
+        row->counters.counters.PushBack({"coherency", {CounterFlags::Defaults}, fit.coherency});
+        row->counters.counters.PushBack({"peak threads", {CounterFlags::Defaults}, fit.peak});
+
+        n.Release();
+        speedup.Release();
+    }
+
+} // namespace BenchMark
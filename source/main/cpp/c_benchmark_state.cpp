@@ -11,40 +11,81 @@
 #include "cbenchmark/private/c_benchmark_instance.h"
 #include "cbenchmark/private/c_benchmark_state.h"
 #include "cbenchmark/private/c_benchmark_check.h"
+#include "cbenchmark/private/c_memory.h"
+
+#include <chrono>
+#include <thread>
 
 namespace BenchMark
 {
     BenchMarkState::BenchMarkState()
-        : alloc_(nullptr)
-        , name_(nullptr)
+        : total_iterations_(0)
+        , batch_leftover_(0)
         , max_iterations(0)
+        , started_(false)
+        , finished_(false)
+        , skipped_(Skipped::NotSkipped)
         , range_(nullptr)
+        , arg_names_(nullptr)
+        , arg_name_(nullptr)
+        , arg_index_(0)
         , complexity_n_(0)
+        , complexity_m_(0)
+        , suite_data_(nullptr)
+        , fixture_data_(nullptr)
+        , shared_data_(nullptr)
+        , seed_(0)
+        , alloc_(nullptr)
+        , name_(nullptr)
+        , results_(nullptr)
         , thread_index_(0)
         , threads_(0)
         , timer_(nullptr)
         , manager_(nullptr)
-        , results_(nullptr)
-        , total_iterations_(0)
-        , batch_leftover_(0)
-        , started_(false)
-        , finished_(false)
-        , skipped_(Skipped::NotSkipped)
+        , cache_(Cache::Default)
+        , sweep_(nullptr)
+        , sweep_size_(0)
+        , cold_batch_(0)
+        , cold_remaining_(0)
+        , cold_pending_(0)
+        , cold_running_(0)
+        , cold_mark_(0.0)
+        , cold_first_(false)
+        , timeline_(nullptr)
+        , arrival_start_(0.0)
+        , arrival_intended_(0.0)
+        , arrival_remaining_(0)
+        , inflight_(0)
+        , async_slots_(nullptr)
     {
     }
 
-    void BenchMarkState::Init(const char* name, IterationCount max_iters, Array<s32> const* range, s32 thread_index, s32 threads)
+    void BenchMarkState::Init(const char* name, IterationCount max_iters, Array<s64> const* range, char const* const* arg_names, s32 thread_index, s32 threads)
     {
         name_             = name;
         max_iterations    = max_iters;
         range_            = range;
+        arg_names_        = arg_names;
+        arg_name_         = nullptr;
+        arg_index_        = 0;
         thread_index_     = thread_index;
         threads_          = threads;
         alloc_            = nullptr;
         name_             = nullptr;
         complexity_n_     = 0;
+        complexity_m_     = 0;
+        suite_data_       = nullptr;
+        fixture_data_     = nullptr;
+        shared_data_      = nullptr;
+        seed_             = 0;
         timer_            = nullptr;
         manager_          = nullptr;
+        cache_            = Cache::Default;
+        sweep_            = nullptr;
+        sweep_size_       = 0;
+        timeline_         = nullptr;
+        inflight_         = 0;
+        async_slots_      = nullptr;
         results_          = nullptr;
         total_iterations_ = 0;
         batch_leftover_   = 0;
@@ -53,9 +94,31 @@ namespace BenchMark
         skipped_          = Skipped::NotSkipped;
     }
 
-    void BenchMarkState::InitRun(Allocator* alloc, const char* name, IterationCount max_iters, Array<s32> const* range, s32 counters, s32 thread_index, s32 threads, ThreadTimer* timer, ThreadManager* manager, BenchMarkRunResult* results)
+    void BenchMarkState::InitData(void const* suite_data, void const* fixture_data, BenchMarkSharedData* shared_data, u64 seed)
+    {
+        suite_data_   = suite_data;
+        fixture_data_ = fixture_data;
+        shared_data_  = shared_data;
+        seed_         = seed;
+    }
+
+    void BenchMarkState::InitCache(s32 cache, u8 const* sweep, s64 sweep_size)
     {
-        Init(name, max_iters, range, thread_index, threads);
+        cache_      = cache;
+        sweep_      = sweep;
+        sweep_size_ = sweep_size;
+    }
+
+    void BenchMarkState::InitArrival(ArrivalTimeline* timeline) { timeline_ = timeline; }
+    void BenchMarkState::InitAsync(s32 inflight, u8* slots)
+    {
+        inflight_    = inflight;
+        async_slots_ = slots;
+    }
+
+    void BenchMarkState::InitRun(ForwardAllocator* alloc, const char* name, IterationCount max_iters, Array<s64> const* range, char const* const* arg_names, s32 counters, s32 thread_index, s32 threads, ThreadTimer* timer, ThreadManager* manager, BenchMarkRunResult* results)
+    {
+        Init(name, max_iters, range, arg_names, thread_index, threads);
 
         alloc_            = alloc;
         timer_            = timer;
@@ -71,6 +134,17 @@ namespace BenchMark
         counters_.Release();
     }
 
+    s32 BenchMarkState::ArgIndex(const char* name) const
+    {
+        for (s32 i = 0; i < range_->Size(); ++i)
+        {
+            if (arg_names_[i] != nullptr && gAreStringsEqual(arg_names_[i], name))
+                return i;
+        }
+        BM_CHECK(false);
+        return -1;
+    }
+
     static void ResultSkipWithMessage(BenchMarkRunResult* rr, const char* msg, Skipped skipped)
     {
         if (rr->skip_message_ != nullptr)
@@ -148,4 +222,340 @@ namespace BenchMark
         finished_         = true;
         StartStopBarrier(manager_);
     }
-} // namespace BenchMark
\ No newline at end of file
+
+    // Cache::Cold, the time spent evicting the caches of one run may not exceed this (seconds),
+    // when one eviction is expensive the batches are made larger.
+    static const double kColdEvictionBudget = 0.5;
+
+    void BenchMarkState::EvictCaches()
+    {
+        gFlushCache(alloc_->Buffer(), alloc_->Size());
+        if (shared_data_ != nullptr && shared_data_->built)
+            gFlushCache(shared_data_->arena.Buffer(), shared_data_->arena.Size());
+        gWarmCache(sweep_, sweep_size_);
+    }
+
+    IterationCount BenchMarkState::StartIterating()
+    {
+        if (timeline_ != nullptr && skipped_.IsNotSkipped() && max_iterations > 0)
+        {
+            StartKeepRunning();
+            arrival_remaining_ = max_iterations;
+            arrival_start_     = RealTimeNow();
+            WaitForArrival();
+            return 1;
+        }
+
+        // The other threads would be timing their iterations while this one evicts the caches
+        if (cache_ == Cache::Cold && threads_ > 1 && skipped_.IsNotSkipped())
+            SkipWithError("BM_CACHE(Cache::Cold) needs a single thread, the evictions of one thread would be timed by the others");
+
+        if (cache_ != Cache::Cold || skipped_.IsSkipped() || max_iterations <= 0)
+        {
+            StartKeepRunning();
+            return skipped_.IsSkipped() ? 0 : max_iterations;
+        }
+
+        // What one eviction costs decides how many batches this run can afford
+        const double start = RealTimeNow();
+        EvictCaches();
+        const double cost = RealTimeNow() - start;
+
+        IterationCount batches = max_iterations;
+        if (cost * (double)batches > kColdEvictionBudget)
+            batches = (IterationCount)(kColdEvictionBudget / cost);
+        if (batches < 1)
+            batches = 1;
+
+        cold_batch_     = (max_iterations + batches - 1) / batches;
+        cold_remaining_ = max_iterations - cold_batch_;
+        cold_pending_   = cold_batch_ - 1;
+        cold_running_   = 1;
+        cold_first_     = true;
+        cold_mark_      = ThreadTimerRealTimeUsed(timer_);
+        StartKeepRunning();
+        return cold_running_;
+    }
+
+    IterationCount BenchMarkState::NextIterations()
+    {
+        if (timeline_ != nullptr)
+            return NextArrival();
+
+        const bool done = cache_ != Cache::Cold || skipped_.IsSkipped() || (cold_pending_ == 0 && cold_remaining_ == 0);
+        if (done)
+            FinishKeepRunning();
+        else
+            PauseTiming();
+
+        if (cache_ == Cache::Cold && skipped_.IsNotSkipped())
+        {
+            const double used = ThreadTimerRealTimeUsed(timer_) - cold_mark_;
+            if (cold_first_)
+            {
+                results_->cold_time_used += used;
+                results_->cold_iterations += cold_running_;
+            }
+            else
+            {
+                results_->warm_time_used += used;
+                results_->warm_iterations += cold_running_;
+            }
+        }
+        if (done)
+            return 0;
+
+        // The rest of the current batch runs warm, the next batch starts after evicting the caches
+        if (cold_pending_ > 0)
+        {
+            cold_running_ = cold_pending_;
+            cold_pending_ = 0;
+            cold_first_   = false;
+        }
+        else
+        {
+            EvictCaches();
+            const IterationCount batch = cold_remaining_ < cold_batch_ ? cold_remaining_ : cold_batch_;
+            cold_remaining_ -= batch;
+            cold_pending_ = batch - 1;
+            cold_running_ = 1;
+            cold_first_   = true;
+        }
+        cold_mark_ = ThreadTimerRealTimeUsed(timer_);
+        ResumeTiming();
+        return cold_running_;
+    }
+
+    // Waiting for an arrival sleeps until it is this close, then yields the core until it is closer than the
+    // spin margin and only spins for the last stretch, so a low rate does not keep a core busy.
+    static const double kArrivalSleepMargin = 2.0e-3;
+    static const double kArrivalSpinMargin  = 50.0e-6;
+
+    void BenchMarkState::WaitForArrival()
+    {
+        // When the previous operations took too long this one is late and starts right away
+        arrival_intended_ = timeline_->Next();
+        for (;;)
+        {
+            const double wait = arrival_intended_ - (RealTimeNow() - arrival_start_);
+            if (wait <= 0.0)
+                break;
+            if (wait > kArrivalSleepMargin)
+                std::this_thread::sleep_for(std::chrono::duration<double>(wait - kArrivalSleepMargin));
+            else if (wait > kArrivalSpinMargin)
+                std::this_thread::yield();
+        }
+    }
+
+    IterationCount BenchMarkState::NextArrival()
+    {
+        // The latency of the operation that just finished is measured from the time it should have started,
+        // not from the time it did start, this includes the time it was queued behind the previous ones.
+        const double done = RealTimeNow() - arrival_start_;
+        results_->latency.Record(done > arrival_intended_ ? (u64)((done - arrival_intended_) * 1e9) : 0);
+
+        if (--arrival_remaining_ == 0 || skipped_.IsSkipped())
+        {
+            FinishKeepRunning();
+            return 0;
+        }
+        WaitForArrival();
+        return 1;
+    }
+
+    void BenchMarkSharedData::Initialize(Allocator* alloc, s64 arena_size)
+    {
+        allocator = alloc;
+        size      = arena_size;
+        data      = nullptr;
+        built     = false;
+    }
+
+    void BenchMarkSharedData::Release()
+    {
+        if (built)
+            arena.Release();
+        data  = nullptr;
+        built = false;
+    }
+
+    void const* BenchMarkState::GetSharedData(shared_data_build_function build)
+    {
+        BM_CHECK(!started_);
+        BM_CHECK(shared_data_ != nullptr);
+
+        // The arena is created lazily, units that do not use shared data do not pay for it
+        if (thread_index_ == 0 && !shared_data_->built)
+        {
+            shared_data_->arena.Initialize(shared_data_->allocator, shared_data_->size);
+            shared_data_->data = nullptr;
+            build(*this, &shared_data_->arena, shared_data_->data);
+            shared_data_->built = true;
+        }
+
+        // The other threads wait here until the first thread has built the data
+        StartStopBarrier(manager_);
+        return shared_data_->data;
+    }
+
+    // Inputs of a batch start on a cache line boundary
+    static const unsigned int kBatchAlignment = 64;
+
+    BenchMarkState::BatchIterator::BatchIterator(BenchMarkState* st, s64 input_size, batch_prepare_function prepare)
+        : cached_(0)
+        , remaining_(st->IsSkipped() ? 0 : st->max_iterations)
+        , cursor_(nullptr)
+        , inputs_(nullptr)
+        , input_size_(input_size)
+        , batch_size_(0)
+        , prepare_(prepare)
+        , parent_(st)
+    {
+        // The larger the batch the less often we have to stop the timer to prepare the next one, but the
+        // inputs of a batch should still be in the cache when it runs. So the batch takes half of L2, at
+        // least one input, and never more than the arena of this thread allows.
+        s64 batch_size = 0;
+        if (input_size_ > 0)
+        {
+            const s64 available = st->alloc_->Available(kBatchAlignment) / input_size_;
+            batch_size          = (gL2CacheSize() / 2) / input_size_;
+            if (batch_size < 1)
+                batch_size = 1;
+            if (batch_size > available)
+                batch_size = available;
+        }
+        if (batch_size > remaining_)
+            batch_size = remaining_;
+        if (batch_size > 0x7fffffff)
+            batch_size = 0x7fffffff;
+        batch_size_ = (s32)batch_size;
+
+        if (remaining_ > 0 && batch_size_ == 0)
+        {
+            st->SkipWithError("BM_ITERATE_BATCHED, input does not fit in the memory required by this benchmark");
+            remaining_ = 0;
+        }
+        else if (batch_size_ > 0)
+        {
+            inputs_ = (u8*)st->alloc_->Allocate(input_size_ * batch_size_, kBatchAlignment);
+
+            // The timer is not running yet, so the first batch can be prepared right away
+            Prepare();
+        }
+
+        st->StartKeepRunning();
+    }
+
+    BenchMarkState::BatchIterator::~BatchIterator()
+    {
+        if (inputs_ != nullptr)
+            parent_->alloc_->Deallocate(inputs_);
+    }
+
+    void BenchMarkState::BatchIterator::Prepare()
+    {
+        const s32 count = remaining_ < batch_size_ ? (s32)remaining_ : batch_size_;
+        prepare_(*parent_, inputs_, input_size_, count);
+        remaining_ -= count;
+        cached_ = count;
+        cursor_ = inputs_;
+    }
+
+    bool BenchMarkState::BatchIterator::NextBatch()
+    {
+        // A skipped benchmark has already stopped the timer
+        if (remaining_ == 0 || parent_->IsSkipped())
+        {
+            parent_->FinishKeepRunning();
+            return false;
+        }
+
+        parent_->PauseTiming();
+        Prepare();
+        parent_->ResumeTiming();
+        return true;
+    }
+
+    BenchMarkState::AsyncIterator::AsyncIterator(BenchMarkState* st)
+        : started_(nullptr)
+        , free_(nullptr)
+        , free_count_(0)
+        , depth_(st->inflight_ > 0 ? st->inflight_ : 1)
+        , remaining_(st->IsSkipped() ? 0 : st->max_iterations)
+        , pending_(0)
+        , start_(0.0)
+        , next_(0.0)
+        , parent_(st)
+    {
+        // The slots live in memory of the runner (see InitAsync), not in the arena of the benchmark
+        if (st->async_slots_ == nullptr)
+        {
+            st->SkipWithError("BM_ITERATE_ASYNC, the in-flight operations do not fit in the scratch memory of the runner");
+            remaining_ = 0;
+        }
+        else
+        {
+            started_ = (double*)st->async_slots_;
+            free_    = (s32*)(st->async_slots_ + sizeof(double) * depth_);
+
+            // Slot 0 is handed out first
+            for (s32 i = depth_ - 1; i >= 0; --i)
+                free_[free_count_++] = i;
+        }
+
+        st->StartKeepRunning();
+        start_ = RealTimeNow();
+        if (st->timeline_ != nullptr)
+            next_ = st->timeline_->Next();
+    }
+
+    BenchMarkState::AsyncIterator::~AsyncIterator() {}
+
+    bool BenchMarkState::AsyncIterator::Next(AsyncOp& op)
+    {
+        // After a skip nothing new is launched, the operations in flight still have to complete
+        if (parent_->IsSkipped())
+            remaining_ = 0;
+
+        if (remaining_ > 0 && free_count_ > 0)
+        {
+            const double now = RealTimeNow() - start_;
+            if (parent_->timeline_ == nullptr)
+            {
+                const s32 slot = free_[--free_count_];
+                started_[slot] = now;
+                --remaining_;
+                ++pending_;
+                op = AsyncOp(this, slot);
+                return true;
+            }
+            if (now >= next_)
+            {
+                // Open loop, when the operation is late its latency includes the time it was waiting for a slot
+                const s32 slot = free_[--free_count_];
+                started_[slot] = next_;
+                next_          = parent_->timeline_->Next();
+                --remaining_;
+                ++pending_;
+                op = AsyncOp(this, slot);
+                return true;
+            }
+        }
+
+        op = AsyncOp();
+        if (pending_ > 0 || remaining_ > 0)
+            return true;
+
+        parent_->FinishKeepRunning();
+        return false;
+    }
+
+    void BenchMarkState::AsyncIterator::Done(s32 slot)
+    {
+        BM_ASSERT(slot >= 0 && slot < depth_ && pending_ > 0);
+        const double done = RealTimeNow() - start_;
+        parent_->results_->latency.Record(done > started_[slot] ? (u64)((done - started_[slot]) * 1e9) : 0);
+        free_[free_count_++] = slot;
+        --pending_;
+    }
+} // namespace BenchMark
@@ -2,24 +2,17 @@
 #include "cbenchmark/private/c_time_helpers.h"
 #include "cbenchmark/private/c_benchmark_run.h"
 #include "cbenchmark/private/c_benchmark_check.h"
+#include "cbenchmark/private/c_benchmark_kernels.h"
 #include "cbenchmark/private/c_utils.h"
 
 #include <algorithm>
 #include <cmath>
-#include <numeric>
+#include <cstring>
 #include <string>
 
 namespace BenchMark
 {
-    static double StatisticsSum(const Array<double>& v)
-    {
-        double sum = 0.0;
-        for (auto i = 0; i < v.Size(); ++i)
-        {
-            sum += v[i];
-        };
-        return sum;
-    };
+    static double StatisticsSum(const Array<double>& v) { return gStatisticsKernels().sum(v.Begin(), v.Size()); }
 
     double StatisticsMean(ScratchAllocator* scratch, const Array<double>& v)
     {
@@ -35,6 +28,16 @@ namespace BenchMark
 
         USE_SCRATCH(scratch);
 
+        // Large arrays are not copied and sorted but narrowed down with histograms
+        if (v.Size() > 4096)
+        {
+            StatisticsKernels const& kernels = gStatisticsKernels();
+            const double             center  = gStatisticsSelect(scratch, kernels, v.Begin(), v.Size(), v.Size() / 2);
+            if (v.Size() % 2 == 1)
+                return center;
+            return (center + gStatisticsSelect(scratch, kernels, v.Begin(), v.Size(), v.Size() / 2 - 1)) / 2.0;
+        }
+
         Array<double> copy;
         copy.Copy(scratch, v);
 
@@ -58,7 +61,7 @@ namespace BenchMark
     }
 
     // Return the sum of the squares of this sample set
-    inline static double SumSquares(const Array<double>& v) { return std::inner_product(v.Begin(), v.End(), v.Begin(), 0.0); }
+    inline static double SumSquares(const Array<double>& v) { return gStatisticsKernels().sum_squares(v.Begin(), v.Size()); }
     inline static double Sqr(const double dat) { return dat * dat; }
     inline static double Sqrt(const double dat)
     {
@@ -93,116 +96,250 @@ namespace BenchMark
         return stddev / mean;
     }
 
-    // create stats for user counters
-    struct CounterStat
-    {
-        CounterStat() = default;
-        Counter       c;
-        Array<double> s;
-    };
+    // P², the quantiles the markers follow, the desired position of a marker moves this much with every value
+    static const double kMarkerQuantiles[5] = {0.0, 0.25, 0.5, 0.75, 1.0};
 
-    struct CounterStats
+    void StreamingStatistics::Reset()
     {
-        Array<CounterStat> stats;
+        count_ = 0;
+        mean_  = 0.0;
+        m2_    = 0.0;
+        min_   = 0.0;
+        max_   = 0.0;
+        for (s32 i = 0; i < 5; ++i)
+        {
+            heights_[i]   = 0.0;
+            positions_[i] = 0.0;
+            desired_[i]   = 0.0;
+        }
+    }
 
-        s32 FindByName(Counter const& c) const
+    void StreamingStatistics::Add(double value)
+    {
+        // Welford
+        ++count_;
+        const double delta = value - mean_;
+        mean_ += delta / (double)count_;
+        m2_ += delta * (value - mean_);
+        min_ = (count_ == 1 || value < min_) ? value : min_;
+        max_ = (count_ == 1 || value > max_) ? value : max_;
+
+        if (count_ <= kExactValues)
         {
-            for (int i = 0; i < stats.Size(); i++)
-            {
-                if (gCompareStrings(stats[i].c.name, c.name) == 0)
-                    return i;
-            }
-            return stats.Size();
+            s32 i = (s32)count_ - 1;
+            for (; i > 0 && values_[i - 1] > value; --i)
+                values_[i] = values_[i - 1];
+            values_[i] = value;
+            return;
         }
 
-        s32 End() const { return stats.Size(); }
-    };
+        if (count_ == kExactValues + 1)
+            StartEstimate();
+        UpdateEstimate(value);
+    }
 
-    void ComputeStats(ForwardAllocator* alloc, ScratchAllocator* scratch, const Array<BenchMarkRun*>& reports, Array<BenchMarkRun*>& results)
+    void StreamingStatistics::StartEstimate()
     {
-        USE_SCRATCH(scratch);
+        // The markers start at their quantiles of the exact values
+        const double last = (double)(kExactValues - 1);
+        for (s32 i = 0; i < 5; ++i)
+        {
+            const s32 index = (s32)(kMarkerQuantiles[i] * last + 0.5);
+            heights_[i]     = values_[index];
+            positions_[i]   = (double)index;
+            desired_[i]     = kMarkerQuantiles[i] * last;
+        }
+    }
 
-        auto error_count = 0;
-        for (int i = 0; i < reports.Size(); i++)
+    void StreamingStatistics::UpdateEstimate(double value)
+    {
+        // The cell the value falls in, the outer markers follow the min and max
+        s32 k;
+        if (value < heights_[0])
         {
-            if (!reports[i]->skipped.IsSkipped())
-                continue;
-            error_count++;
+            heights_[0] = value;
+            k           = 0;
+        }
+        else if (value >= heights_[4])
+        {
+            heights_[4] = value;
+            k           = 3;
+        }
+        else
+        {
+            k = 0;
+            while (value >= heights_[k + 1])
+                ++k;
         }
 
-        if (reports.Size() - error_count < 2)
+        for (s32 i = k + 1; i < 5; ++i)
+            positions_[i] += 1.0;
+        for (s32 i = 0; i < 5; ++i)
+            desired_[i] += kMarkerQuantiles[i];
+
+        // Move the middle markers towards their desired positions, a parabolic prediction of their height
+        // unless that breaks their order, then a linear one
+        for (s32 i = 1; i < 4; ++i)
         {
-            // We don't report aggregated data if there was a single run.
-            return;
+            const double d = desired_[i] - positions_[i];
+            if ((d >= 1.0 && positions_[i + 1] - positions_[i] > 1.0) || (d <= -1.0 && positions_[i - 1] - positions_[i] < -1.0))
+            {
+                const double sign   = d >= 0.0 ? 1.0 : -1.0;
+                const double n_prev = positions_[i - 1];
+                const double n      = positions_[i];
+                const double n_next = positions_[i + 1];
+                const double q_prev = heights_[i - 1];
+                const double q      = heights_[i];
+                const double q_next = heights_[i + 1];
+
+                const double parabolic = q + sign / (n_next - n_prev) * ((n - n_prev + sign) * (q_next - q) / (n_next - n) + (n_next - n - sign) * (q - q_prev) / (n - n_prev));
+                if (q_prev < parabolic && parabolic < q_next)
+                {
+                    heights_[i] = parabolic;
+                }
+                else
+                {
+                    const s32 j = sign > 0.0 ? i + 1 : i - 1;
+                    heights_[i] = q + sign * (heights_[j] - q) / (positions_[j] - n);
+                }
+                positions_[i] += sign;
+            }
         }
+    }
 
-        // Accumulators.
-        Array<double> real_accumulated_time_stat;
-        Array<double> cpu_accumulated_time_stat;
+    double StreamingStatistics::Median() const
+    {
+        // Like StatisticsMedian, the mean of less than 3 values
+        if (count_ < 3)
+            return mean_;
+        if (count_ <= kExactValues)
+            return (count_ % 2 == 1) ? values_[count_ / 2] : (values_[count_ / 2 - 1] + values_[count_ / 2]) / 2.0;
+        return heights_[2];
+    }
 
-        real_accumulated_time_stat.Init(scratch, 0, reports.Size());
-        cpu_accumulated_time_stat.Init(scratch, 0, reports.Size());
+    double StreamingMean(const StreamingStatistics& stats) { return stats.Mean(); }
+    double StreamingMedian(const StreamingStatistics& stats) { return stats.Median(); }
+    double StreamingStdDev(const StreamingStatistics& stats) { return stats.Count() > 1 ? Sqrt(stats.Variance()) : 0.0; }
+    double StreamingCV(const StreamingStatistics& stats) { return stats.Count() > 1 ? StreamingStdDev(stats) / stats.Mean() : 0.0; }
 
-        // All repetitions should be run with the same number of iterations so we
-        // can take this information from the first benchmark.
-        const IterationCount run_iterations = reports.Front()->iterations;
+    RepetitionStatistics::RepetitionStatistics()
+        : counters(nullptr)
+        , num_counters(0)
+        , allocator_(nullptr)
+        , max_counters_(0)
+    {
+    }
 
-        s32 num_counters = 0;
-        for (int i = 0; i < reports.Size(); i++)
-        {
-            BenchMarkRun const* r = reports[i];
-            num_counters += r->counters.counters.Size();
-        }
+    void RepetitionStatistics::Release()
+    {
+        if (counters != nullptr)
+            allocator_->Deallocate(counters);
+        real_time.Reset();
+        cpu_time.Reset();
+        counters      = nullptr;
+        num_counters  = 0;
+        max_counters_ = 0;
+    }
 
-        CounterStats counter_stats;
-        counter_stats.stats.Init(scratch, 0, num_counters);
+    void RepetitionStatistics::Add(Allocator* allocator, BenchMarkRun const* run)
+    {
+        if (run->skipped.IsSkipped())
+            return;
 
-        for (int i = 0; i < reports.Size(); i++)
+        real_time.Add(run->real_accumulated_time);
+        cpu_time.Add(run->cpu_accumulated_time);
+
+        for (s32 j = 0; j < run->counters.counters.Size(); ++j)
         {
-            BenchMarkRun const* r = reports[i];
+            Counter const& cnt = run->counters.counters[j];
 
-            // for (auto const& cnt : r.counters)
-            for (int j = 0; j < r->counters.counters.Size(); j++)
-            {
-                auto const& cnt = r->counters.counters[j];
+            s32 i = 0;
+            while (i < num_counters && gCompareStrings(counters[i].counter.name, cnt.name) != 0)
+                ++i;
 
-                auto it = counter_stats.FindByName(cnt);
-                if (it == counter_stats.End())
-                {
-                    CounterStat& c = counter_stats.stats.Alloc();
-                    c.c            = cnt;
-                    c.s.Init(scratch, 0, reports.Size());
-                }
-                else
+            if (i == num_counters)
+            {
+                // A counter that did not appear before, the repetitions of an instance usually all have the same
+                if (num_counters == max_counters_)
                 {
-                    BM_CHECK_EQ(counter_stats.stats[it].c.flags, cnt.flags);
+                    const s32          max   = max_counters_ + run->counters.counters.Size() - j;
+                    CounterStatistics* grown = allocator->Alloc<CounterStatistics>(sizeof(CounterStatistics) * max);
+                    if (counters != nullptr)
+                    {
+                        memcpy(grown, counters, sizeof(CounterStatistics) * num_counters);
+                        allocator_->Deallocate(counters);
+                    }
+                    allocator_    = allocator;
+                    counters      = grown;
+                    max_counters_ = max;
                 }
+                CounterStatistics& stat = counters[num_counters++];
+                stat.counter            = cnt;
+                stat.stream.Reset();
+            }
+            else
+            {
+                BM_CHECK_EQ(counters[i].counter.flags, cnt.flags);
             }
+            counters[i].stream.Add(cnt.value);
         }
+    }
 
-        // Populate the accumulators.
-        for (int i = 0; i < reports.Size(); i++)
+    // The times of the repetitions that were not skipped
+    static void sGatherTimes(const Array<BenchMarkRun*>& reports, Array<double>& real_times, Array<double>& cpu_times)
+    {
+        for (s32 i = 0; i < reports.Size(); i++)
         {
-            const BenchMarkRun* run = reports[i];
+            if (reports[i]->skipped.IsSkipped())
+                continue;
+            real_times.PushBack(reports[i]->real_accumulated_time);
+            cpu_times.PushBack(reports[i]->cpu_accumulated_time);
+        }
+    }
 
-            BM_CHECK_EQ(gCompareStrings(reports[0].benchmark_name(), run->benchmark_name()), 0);
-            BM_CHECK_EQ(run_iterations, run->iterations);
+    // The values of a user counter of the repetitions that were not skipped
+    static void sGatherCounter(const Array<BenchMarkRun*>& reports, const char* name, Array<double>& values)
+    {
+        for (s32 i = 0; i < reports.Size(); i++)
+        {
+            BenchMarkRun const* run = reports[i];
             if (run->skipped.IsSkipped())
                 continue;
-
-            real_accumulated_time_stat.PushBack(run->real_accumulated_time);
-            cpu_accumulated_time_stat.PushBack(run->cpu_accumulated_time);
-
-            // user counters
-            for (int j = 0; j < run->counters.counters.Size(); j++)
+            for (s32 j = 0; j < run->counters.counters.Size(); ++j)
             {
-                Counter const& cnt = run->counters.counters[j];
-                auto           it  = counter_stats.FindByName(cnt);
-                BM_CHECK_NE(it, counter_stats.End());
-                CounterStat& stat = counter_stats.stats[it];
-                stat.s.PushBack(cnt.value);
+                if (gCompareStrings(run->counters.counters[j].name, name) == 0)
+                    values.PushBack(run->counters.counters[j].value);
             }
         }
+    }
+
+    void ComputeStats(ForwardAllocator* alloc, ScratchAllocator* scratch, const Array<BenchMarkRun*>& reports, RepetitionStatistics const& stream, Array<BenchMarkRun*>& results)
+    {
+        USE_SCRATCH(scratch);
+
+        auto error_count = 0;
+        for (int i = 0; i < reports.Size(); i++)
+        {
+            if (!reports[i]->skipped.IsSkipped())
+                continue;
+            error_count++;
+        }
+
+        if (reports.Size() - error_count < 2)
+        {
+            // We don't report aggregated data if there was a single run.
+            return;
+        }
+
+        // All repetitions should be run with the same number of iterations so we
+        // can take this information from the first benchmark.
+        const IterationCount run_iterations = reports.Front()->iterations;
+        for (int i = 0; i < reports.Size(); i++)
+        {
+            BM_CHECK_EQ(gCompareStrings(reports[0].benchmark_name(), reports[i]->benchmark_name()), 0);
+            BM_CHECK_EQ(run_iterations, reports[i]->iterations);
+        }
+        BM_CHECK_EQ(stream.real_time.Count(), reports.Size() - error_count);
 
         // Only add label if it is same for all runs
         const char* report_format = reports[0]->report_format;
@@ -246,8 +383,25 @@ namespace BenchMark
             // Thus it is best to simply use the count of separate reports.
             data->iterations = reports.Size();
 
-            data->real_accumulated_time = Stat.compute_(scratch, real_accumulated_time_stat);
-            data->cpu_accumulated_time  = Stat.compute_(scratch, cpu_accumulated_time_stat);
+            if (Stat.stream_ != nullptr)
+            {
+                data->real_accumulated_time = Stat.stream_(stream.real_time);
+                data->cpu_accumulated_time  = Stat.stream_(stream.cpu_time);
+            }
+            else
+            {
+                // A user defined statistic, over the values of the repetitions
+                USE_SCRATCH(scratch);
+                Array<double> real_times;
+                Array<double> cpu_times;
+                real_times.Init(scratch, 0, reports.Size());
+                cpu_times.Init(scratch, 0, reports.Size());
+                sGatherTimes(reports, real_times, cpu_times);
+                data->real_accumulated_time = Stat.compute_(scratch, real_times);
+                data->cpu_accumulated_time  = Stat.compute_(scratch, cpu_times);
+                cpu_times.Release();
+                real_times.Release();
+            }
 
             if (data->aggregate_unit.IsTime())
             {
@@ -263,15 +417,31 @@ namespace BenchMark
             data->time_unit = reports[0]->time_unit;
 
             // user counters
-            data->counters.counters.Init(alloc, 0, counter_stats.stats.Size());
-            for (int j = 0; j < counter_stats.stats.Size(); j++)
+            data->counters.counters.Init(alloc, 0, stream.num_counters);
+            for (int j = 0; j < stream.num_counters; j++)
             {
-                CounterStat const& kv = counter_stats.stats[j];
+                RepetitionStatistics::CounterStatistics const& kv = stream.counters[j];
+
                 // Do NOT rescale the custom counters since they are already properly scaled!
-                const auto uc_stat = Stat.compute_(scratch, kv.s);
-                Counter&   c       = data->counters.counters.Alloc();
-                c.value            = uc_stat;
-                c.flags            = kv.c.flags;
+                double uc_stat = 0.0;
+                if (Stat.stream_ != nullptr)
+                {
+                    uc_stat = Stat.stream_(kv.stream);
+                }
+                else
+                {
+                    USE_SCRATCH(scratch);
+                    Array<double> values;
+                    values.Init(scratch, 0, reports.Size());
+                    sGatherCounter(reports, kv.counter.name, values);
+                    uc_stat = Stat.compute_(scratch, values);
+                    values.Release();
+                }
+
+                Counter& c = data->counters.counters.Alloc();
+                c.name     = kv.counter.name;
+                c.value    = uc_stat;
+                c.flags    = kv.counter.flags;
             }
         }
     }
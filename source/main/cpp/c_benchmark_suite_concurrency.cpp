@@ -0,0 +1,483 @@
+#include "ccore/c_target.h"
+#include "cbenchmark/cbenchmark.h"
+#include "cbenchmark/private/c_benchmark_results.h"
+#include "cbenchmark/private/c_benchmark_state.h"
+#include "cbenchmark/private/c_benchmark_unit.h"
+#include "cbenchmark/private/c_benchmark_allocators.h"
+#include "cbenchmark/private/c_process.h"
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#    include <emmintrin.h>
+#    define BM_CPU_RELAX() _mm_pause()
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+#    define BM_CPU_RELAX() __asm__ volatile("yield" ::: "memory")
+#else
+#    define BM_CPU_RELAX() \
+        do                 \
+        {                  \
+        } while (0)
+#endif
+
+// Atomics, locks and queues under contention, run with --builtin=concurrency.
+//
+//   atomics/...    fetch_add on a private and on a shared counter, a CAS loop on a shared counter
+//   sharing/...    Counters of different threads on one cache line versus one line each
+//   pingpong/...   One cache line bounced between two pinned threads (time is a round trip)
+//   locks/...      std::mutex, a ticket lock and an MCS lock around a tiny critical section
+//   queues/...     A single producer / single consumer ring and a bounded MPMC queue
+//
+// Every unit reports 'ops per thread' (per second), the speedup and the efficiency relative to the
+// 1 thread instance of the same unit are in the scaling report that follows the unit.
+//
+// NOTE: The shared data of these units is what the threads contend on, so unlike the usual shared
+//       data it is written to by all threads.
+
+namespace BenchMark
+{
+    BM_SUITE(concurrency)
+    {
+        static const s64 kLineSize         = 64;
+        static const s32 kSpinsBeforeYield = 64;
+
+        // Spin with a pause, and give up the core once in a while so that oversubscribed threads
+        // (more threads than cores) still make progress.
+        struct Backoff
+        {
+            Backoff()
+                : spins(0)
+            {
+            }
+
+            inline void Pause()
+            {
+                if (++spins < kSpinsBeforeYield)
+                {
+                    BM_CPU_RELAX();
+                }
+                else
+                {
+                    spins = 0;
+                    std::this_thread::yield();
+                }
+            }
+
+            s32 spins;
+        };
+
+        struct alignas(64) PaddedAtomic
+        {
+            std::atomic<u64> value;
+        };
+
+        template <typename T> static void BuildShared(BenchMarkState&, Allocator* allocator, void*& data)
+        {
+            data = new (allocator->Allocate(sizeof(T), kLineSize)) T();
+        }
+
+        template <typename T> static void BuildPerThread(BenchMarkState& state, Allocator* allocator, void*& data)
+        {
+            T* items = (T*)allocator->Allocate(sizeof(T) * state.Threads(), kLineSize);
+            for (s32 i = 0; i < state.Threads(); ++i)
+                new (&items[i]) T();
+            data = items;
+        }
+
+        // The data the threads contend on, see the NOTE above
+        template <typename T> static T* Contended(BenchMarkState& state) { return (T*)state.SharedData<T>(BuildShared<T>); }
+
+        // An item for every thread of the instance, the item of the calling thread
+        template <typename T> static T& PerThread(BenchMarkState& state) { return ((T*)state.SharedData<T>(BuildPerThread<T>))[state.ThreadIndex()]; }
+
+        // Ops per thread (summed over the threads, presented as a per thread rate)
+        static void ReportOps(BenchMarkState& state) { state.SetCounter("ops per thread", CounterFlags::IsRate | CounterFlags::AvgThreads, (double)state.Iterations()); }
+
+        BM_SUITE_SETTINGS
+        {
+            BM_COUNTER("ops per thread", CounterFlags::IsRate | CounterFlags::AvgThreads);
+            BM_TIMEUNIT(TimeUnit::Nanosecond);
+            BM_MINWARMUPTIME(0.1);
+        }
+
+        BM_FIXTURE(atomics)
+        {
+            BM_FIXTURE_SETTINGS { BM_THREAD_SWEEP(ThreadSweep::Powers2); }
+
+            BM_UNIT(fetch_add_private)
+            {
+                std::atomic<u64>& counter = PerThread<PaddedAtomic>(state).value;
+
+                BM_ITERATE { counter.fetch_add(1, std::memory_order_relaxed); }
+                ReportOps(state);
+            }
+
+            BM_UNIT(fetch_add_shared)
+            {
+                std::atomic<u64>& counter = Contended<PaddedAtomic>(state)->value;
+
+                BM_ITERATE { counter.fetch_add(1, std::memory_order_relaxed); }
+                ReportOps(state);
+            }
+
+            BM_UNIT(cas_shared)
+            {
+                std::atomic<u64>& counter = Contended<PaddedAtomic>(state)->value;
+
+                BM_ITERATE
+                {
+                    u64 expected = counter.load(std::memory_order_relaxed);
+                    while (!counter.compare_exchange_weak(expected, expected + 1, std::memory_order_relaxed))
+                    {
+                    }
+                }
+                ReportOps(state);
+            }
+        }
+
+        BM_FIXTURE(sharing)
+        {
+            BM_FIXTURE_SETTINGS { BM_THREAD_SWEEP(ThreadSweep::Powers2); }
+
+            // 8 threads per cache line
+            BM_UNIT(false_sharing)
+            {
+                std::atomic<u64>& counter = PerThread<std::atomic<u64>>(state);
+
+                BM_ITERATE { counter.fetch_add(1, std::memory_order_relaxed); }
+                ReportOps(state);
+            }
+
+            // 1 thread per cache line
+            BM_UNIT(padded)
+            {
+                std::atomic<u64>& counter = PerThread<PaddedAtomic>(state).value;
+
+                BM_ITERATE { counter.fetch_add(1, std::memory_order_relaxed); }
+                ReportOps(state);
+            }
+        }
+
+        BM_FIXTURE(pingpong)
+        {
+            BM_FIXTURE_SETTINGS { BM_THREAD_COUNTS(2); }
+
+            // Thread 0 makes the ball odd, thread 1 makes it even again, an iteration is one round trip.
+            // Both threads run the same number of iterations so the ball is even after every run.
+            BM_UNIT(round_trip)
+            {
+                std::atomic<u64>& ball  = Contended<PaddedAtomic>(state)->value;
+                u64 const         serve = state.ThreadIndex() == 0 ? 0 : 1;
+
+                gPinThread(state.ThreadIndex());
+
+                BM_ITERATE
+                {
+                    Backoff backoff;
+                    u64     b = ball.load(std::memory_order_acquire);
+                    while ((b & 1) != serve)
+                    {
+                        backoff.Pause();
+                        b = ball.load(std::memory_order_acquire);
+                    }
+                    ball.store(b + 1, std::memory_order_release);
+                }
+                ReportOps(state);
+
+                gUnpinThread();
+            }
+        }
+
+        BM_FIXTURE(locks)
+        {
+            class TicketLock
+            {
+            public:
+                TicketLock()
+                    : next_(0)
+                    , serving_(0)
+                {
+                }
+
+                void lock()
+                {
+                    u32 const ticket = next_.fetch_add(1, std::memory_order_relaxed);
+                    Backoff   backoff;
+                    while (serving_.load(std::memory_order_acquire) != ticket)
+                        backoff.Pause();
+                }
+
+                void unlock() { serving_.store(serving_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+            private:
+                alignas(64) std::atomic<u32> next_;
+                alignas(64) std::atomic<u32> serving_;
+            };
+
+            // Every waiter spins on its own node, the lock hands over by clearing the flag of the next node
+            class McsLock
+            {
+            public:
+                struct alignas(64) Node
+                {
+                    std::atomic<Node*> next;
+                    std::atomic<bool>  locked;
+                };
+
+                McsLock()
+                    : tail_(nullptr)
+                {
+                }
+
+                void lock(Node& node)
+                {
+                    node.next.store(nullptr, std::memory_order_relaxed);
+                    node.locked.store(true, std::memory_order_relaxed);
+                    Node* const prev = tail_.exchange(&node, std::memory_order_acq_rel);
+                    if (prev == nullptr)
+                        return;
+                    prev->next.store(&node, std::memory_order_release);
+                    Backoff backoff;
+                    while (node.locked.load(std::memory_order_acquire))
+                        backoff.Pause();
+                }
+
+                void unlock(Node& node)
+                {
+                    Node* next = node.next.load(std::memory_order_acquire);
+                    if (next == nullptr)
+                    {
+                        Node* expected = &node;
+                        if (tail_.compare_exchange_strong(expected, nullptr, std::memory_order_release, std::memory_order_relaxed))
+                            return;
+                        Backoff backoff;
+                        while ((next = node.next.load(std::memory_order_acquire)) == nullptr)
+                            backoff.Pause();
+                    }
+                    next->locked.store(false, std::memory_order_release);
+                }
+
+            private:
+                alignas(64) std::atomic<Node*> tail_;
+            };
+
+            struct Locks
+            {
+                std::mutex  mutex;
+                TicketLock  ticket;
+                McsLock     mcs;
+                alignas(64) u64 value; // The critical section increments this
+            };
+
+            BM_FIXTURE_SETTINGS { BM_THREAD_SWEEP(ThreadSweep::Powers2); }
+
+            BM_UNIT(std_mutex)
+            {
+                Locks* locks = Contended<Locks>(state);
+
+                BM_ITERATE
+                {
+                    locks->mutex.lock();
+                    locks->value += 1;
+                    locks->mutex.unlock();
+                }
+                ReportOps(state);
+            }
+
+            BM_UNIT(ticket_lock)
+            {
+                Locks* locks = Contended<Locks>(state);
+
+                BM_ITERATE
+                {
+                    locks->ticket.lock();
+                    locks->value += 1;
+                    locks->ticket.unlock();
+                }
+                ReportOps(state);
+            }
+
+            BM_UNIT(mcs_lock)
+            {
+                Locks*        locks = Contended<Locks>(state);
+                McsLock::Node node;
+
+                BM_ITERATE
+                {
+                    locks->mcs.lock(node);
+                    locks->value += 1;
+                    locks->mcs.unlock(node);
+                }
+                ReportOps(state);
+            }
+        }
+
+        BM_FIXTURE(queues)
+        {
+            static const u64 kCapacity = 1024; // Power of 2
+
+            class SpscRing
+            {
+            public:
+                SpscRing()
+                    : head_(0)
+                    , tail_(0)
+                {
+                }
+
+                void Push(u64 value)
+                {
+                    u64 const tail = tail_.load(std::memory_order_relaxed);
+                    Backoff   backoff;
+                    while (tail - head_.load(std::memory_order_acquire) == kCapacity)
+                        backoff.Pause();
+                    items_[tail & (kCapacity - 1)] = value;
+                    tail_.store(tail + 1, std::memory_order_release);
+                }
+
+                u64 Pop()
+                {
+                    u64 const head = head_.load(std::memory_order_relaxed);
+                    Backoff   backoff;
+                    while (tail_.load(std::memory_order_acquire) == head)
+                        backoff.Pause();
+                    u64 const value = items_[head & (kCapacity - 1)];
+                    head_.store(head + 1, std::memory_order_release);
+                    return value;
+                }
+
+            private:
+                alignas(64) std::atomic<u64> head_; // Consumer
+                alignas(64) std::atomic<u64> tail_; // Producer
+                alignas(64) u64 items_[kCapacity];
+            };
+
+            // Bounded MPMC queue (Vyukov), every cell has a sequence number that tells whether it
+            // is free for the producer or filled for the consumer of a position.
+            class MpmcQueue
+            {
+            public:
+                MpmcQueue()
+                    : enqueue_(0)
+                    , dequeue_(0)
+                {
+                    for (u64 i = 0; i < kCapacity; ++i)
+                        cells_[i].sequence.store(i, std::memory_order_relaxed);
+                }
+
+                bool TryPush(u64 value)
+                {
+                    u64 pos = enqueue_.load(std::memory_order_relaxed);
+                    for (;;)
+                    {
+                        Cell&     cell = cells_[pos & (kCapacity - 1)];
+                        s64 const dif  = (s64)cell.sequence.load(std::memory_order_acquire) - (s64)pos;
+                        if (dif == 0)
+                        {
+                            if (enqueue_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                            {
+                                cell.value = value;
+                                cell.sequence.store(pos + 1, std::memory_order_release);
+                                return true;
+                            }
+                        }
+                        else if (dif < 0)
+                        {
+                            return false; // Full
+                        }
+                        else
+                        {
+                            pos = enqueue_.load(std::memory_order_relaxed);
+                        }
+                    }
+                }
+
+                bool TryPop(u64& value)
+                {
+                    u64 pos = dequeue_.load(std::memory_order_relaxed);
+                    for (;;)
+                    {
+                        Cell&     cell = cells_[pos & (kCapacity - 1)];
+                        s64 const dif  = (s64)cell.sequence.load(std::memory_order_acquire) - (s64)(pos + 1);
+                        if (dif == 0)
+                        {
+                            if (dequeue_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                            {
+                                value = cell.value;
+                                cell.sequence.store(pos + kCapacity, std::memory_order_release);
+                                return true;
+                            }
+                        }
+                        else if (dif < 0)
+                        {
+                            return false; // Empty
+                        }
+                        else
+                        {
+                            pos = dequeue_.load(std::memory_order_relaxed);
+                        }
+                    }
+                }
+
+            private:
+                struct Cell
+                {
+                    std::atomic<u64> sequence;
+                    u64              value;
+                };
+
+                alignas(64) std::atomic<u64> enqueue_;
+                alignas(64) std::atomic<u64> dequeue_;
+                alignas(64) Cell cells_[kCapacity];
+            };
+
+            static u64 volatile sQueueSink = 0;
+
+            BM_SETTINGS(spsc) { BM_THREAD_COUNTS(2); }
+
+            // Thread 0 produces and thread 1 consumes, an iteration is one item
+            BM_UNIT(spsc)
+            {
+                SpscRing* ring = Contended<SpscRing>(state);
+
+                if (state.ThreadIndex() == 0)
+                {
+                    u64 value = 0;
+                    BM_ITERATE { ring->Push(value++); }
+                }
+                else
+                {
+                    u64 sum = 0;
+                    BM_ITERATE { sum += ring->Pop(); }
+                    sQueueSink = sum;
+                }
+                ReportOps(state);
+            }
+
+            BM_SETTINGS(mpmc) { BM_THREAD_SWEEP(ThreadSweep::Powers2); }
+
+            // Every thread pushes an item and then pops one, an iteration is a push and a pop
+            BM_UNIT(mpmc)
+            {
+                MpmcQueue* queue = Contended<MpmcQueue>(state);
+                u64        sum   = 0;
+
+                BM_ITERATE
+                {
+                    Backoff backoff;
+                    while (!queue->TryPush((u64)state.ThreadIndex()))
+                        backoff.Pause();
+                    u64 value = 0;
+                    while (!queue->TryPop(value))
+                        backoff.Pause();
+                    sum += value;
+                }
+                sQueueSink = sum;
+                ReportOps(state);
+            }
+        }
+    }
+} // namespace BenchMark
@@ -0,0 +1,394 @@
+#include "ccore/c_target.h"
+#include "cbenchmark/cbenchmark.h"
+#include "cbenchmark/private/c_benchmark_results.h"
+#include "cbenchmark/private/c_benchmark_state.h"
+#include "cbenchmark/private/c_benchmark_unit.h"
+#include "cbenchmark/private/c_benchmark_runner.h"
+#include "cbenchmark/private/c_benchmark_allocators.h"
+#include "cbenchmark/private/c_benchmark_generator.h"
+#include "cbenchmark/private/c_memory.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#    include <emmintrin.h>
+#    define BM_STREAM_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#    include <arm_neon.h>
+#    define BM_STREAM_NEON
+#endif
+
+// The memory hierarchy of the machine, run with --builtin=memory.
+//
+//   latency/chase     Nanoseconds per dependent load over a working set of 4 KiB to 1 GiB
+//   caches/knees      The working set sizes where the latency steps up (L1, L2, L3)
+//   bandwidth/...     STREAM copy, scale, add and triad over 1 .. N threads
+//
+// The latency is the time of a load whose address comes from the previous load, the cache lines of
+// the working set are linked into a single random cycle so that the hardware prefetchers cannot help.
+
+namespace BenchMark
+{
+    BM_SUITE(memory_hierarchy)
+    {
+        static const s64 kLineSize      = 64;
+        static const s64 kMinWorkingSet = (s64)4 << 10;
+        static const s64 kMaxWorkingSet = (s64)1 << 30;
+        static const s64 kChaseUnroll   = 16;
+
+        // Memory needed for a chain of 'size' bytes, the lines and the temporary permutation
+        static s64 ChainMemory(s64 size) { return size + (size / kLineSize) * (s64)sizeof(u32) + ((s64)64 << 10); }
+
+        // Links the 'count' cache lines at 'lines' into a single random cycle, every line holds
+        // a pointer to the next one. 'next' is room for the permutation ('count' entries).
+        static void** BuildChain(u32* next, u64 seed, u8* lines, s64 count)
+        {
+            Generator gen(seed);
+            gen.PointerChase(next, count);
+            for (s64 i = 0; i < count; ++i)
+                *(void**)(lines + i * kLineSize) = lines + (s64)next[i] * kLineSize;
+            return (void**)lines;
+        }
+
+        // Follows the chain for 'loads' loads (a multiple of kChaseUnroll), returns where it ended
+        static void** Chase(void** p, s64 loads)
+        {
+            for (s64 i = 0; i < loads; i += kChaseUnroll)
+            {
+                p = (void**)*p; p = (void**)*p; p = (void**)*p; p = (void**)*p;
+                p = (void**)*p; p = (void**)*p; p = (void**)*p; p = (void**)*p;
+                p = (void**)*p; p = (void**)*p; p = (void**)*p; p = (void**)*p;
+                p = (void**)*p; p = (void**)*p; p = (void**)*p; p = (void**)*p;
+            }
+            return p;
+        }
+
+        // The end of a chase is handed to a volatile so that the compiler cannot drop the loads
+        static void* volatile sChaseSink = nullptr;
+
+        BM_FIXTURE(latency)
+        {
+            BM_FIXTURE_SETTINGS
+            {
+                BM_ARG_NAME(0, "bytes")->RANGE(kMinWorkingSet, kMaxWorkingSet, 2);
+
+                // The chain is shared data, only the pages of the working set of an instance are touched
+                BM_SHARED_MEMORY_REQUIRED(ChainMemory(kMaxWorkingSet));
+
+                // Seconds per load (presented as e.g. 1.2n)
+                BM_COUNTER("latency", CounterFlags::IsRate | CounterFlags::Invert);
+
+                BM_TIMEUNIT(TimeUnit::Nanosecond);
+                BM_MINWARMUPTIME(0.1);
+            }
+
+            static void BuildChainShared(BenchMarkState& state, Allocator* allocator, void*& data)
+            {
+                s64 const count = state.Range(0) / kLineSize;
+                u8*       lines = (u8*)allocator->Allocate(state.Range(0), kLineSize);
+                u32*      next  = allocator->Alloc<u32>(sizeof(u32) * count);
+                data            = BuildChain(next, state.Seed(), lines, count);
+                allocator->Dealloc(next);
+            }
+
+            BM_UNIT(chase)
+            {
+                void** p = (void**)state.SharedData<void*>(BuildChainShared);
+
+                // One iteration is kChaseUnroll dependent loads
+                BM_ITERATE { p = Chase(p, kChaseUnroll); }
+                sChaseSink = p;
+
+                state.SetItemsProcessed(s64(state.Iterations()) * kChaseUnroll);
+                state.SetCounter("latency", CounterFlags::IsRate | CounterFlags::Invert, (double)(s64(state.Iterations()) * kChaseUnroll));
+            }
+        }
+
+        BM_FIXTURE(caches)
+        {
+            static const s32    kMaxSizes       = 64;
+            static const s32    kMaxLevels      = 3;
+            static const s64    kMinLoads       = (s64)1 << 16;
+            static const s64    kMaxLoads       = (s64)1 << 21;
+            static const double kKneeJump       = 1.3; // Latency ratio over the plateau that starts a knee
+            static const double kPlateauFlatten = 1.1; // Step ratio below which the next plateau has started
+
+            static const char* const kLevelNames[kMaxLevels] = {"L1", "L2", "L3"};
+
+            // Sweep up to a few times the last level cache (as reported by the OS), but not beyond 1 GiB
+            static s64 SweepLimit()
+            {
+                s64 limit = (s64)16 << 20;
+                while (limit < 4 * gLastLevelCacheSize() && limit < kMaxWorkingSet)
+                    limit *= 2;
+                return limit;
+            }
+
+            BM_FIXTURE_SETTINGS
+            {
+                // One pass over all sizes, the unit does its own timing per size
+                BM_ITERATIONS(1);
+                BM_MINWARMUPTIME(0.01);
+                BM_MEMORY_REQUIRED(ChainMemory(SweepLimit()));
+
+                // Huge pages keep TLB misses from showing up as a cache level
+                BM_PAGES(Pages::Transparent);
+
+                BM_COUNTER("L1", CounterFlags::Is1024);
+                BM_COUNTER("L2", CounterFlags::Is1024);
+                BM_COUNTER("L3", CounterFlags::Is1024);
+                BM_TIMEUNIT(TimeUnit::Millisecond);
+            }
+
+            // Walks the latency curve, a plateau ends where the latency rises above kKneeJump times its level,
+            // the last size on the plateau is the capacity of that cache level. The next plateau starts where
+            // the curve flattens out again. Returns the number of knees written to 'knees'.
+            static s32 FindKnees(s64 const* sizes, double const* latency, s32 count, s64* knees, s32 max_knees)
+            {
+                s32    num_knees = 0;
+                double level     = latency[0];
+                for (s32 i = 1; i < count && num_knees < max_knees; ++i)
+                {
+                    if (latency[i] <= level * kKneeJump)
+                    {
+                        if (latency[i] < level)
+                            level = latency[i];
+                        continue;
+                    }
+
+                    knees[num_knees++] = sizes[i - 1];
+                    while ((i + 1) < count && latency[i + 1] > latency[i] * kPlateauFlatten)
+                        ++i;
+                    level = latency[i];
+                }
+                return num_knees;
+            }
+
+            BM_UNIT(knees)
+            {
+                s64    sizes[kMaxSizes];
+                double latency[kMaxSizes];
+                s32    count = 0;
+
+                s64 const limit = SweepLimit();
+                u8*       lines = (u8*)allocator->Allocate(limit, kLineSize);
+                u32*      next  = allocator->Alloc<u32>(sizeof(u32) * (limit / kLineSize));
+
+                BM_ITERATE
+                {
+                    // Working sets at steps of sqrt(2), 4 KiB, 6 KiB, 8 KiB, 12 KiB, ...
+                    count = 0;
+                    for (s64 size = kMinWorkingSet; size <= limit && count < kMaxSizes; count += 1)
+                    {
+                        s64 const lines_count = size / kLineSize;
+                        void**    p           = BuildChain(next, state.Seed(), lines, lines_count);
+
+                        s64 loads = 2 * lines_count;
+                        loads     = loads < kMinLoads ? kMinLoads : (loads > kMaxLoads ? kMaxLoads : loads);
+
+                        p                  = Chase(p, loads); // Bring the working set into the caches
+                        double const start = RealTimeNow();
+                        p                  = Chase(p, loads);
+                        latency[count]     = (RealTimeNow() - start) / (double)loads;
+                        sizes[count]       = size;
+                        sChaseSink         = p;
+
+                        size = ((count & 1) == 0) ? (size + size / 2) : (size / 3 * 4);
+                    }
+                }
+
+                // Knees far beyond the caches the OS knows about come from the TLB or the memory controller
+                s64       knees[kMaxLevels];
+                s32       num_knees = FindKnees(sizes, latency, count, knees, kMaxLevels);
+                s64 const llc       = gLastLevelCacheSize();
+                while (num_knees > 0 && knees[num_knees - 1] > 2 * llc)
+                    --num_knees;
+
+                for (s32 i = 0; i < num_knees; ++i)
+                    state.SetCounter(kLevelNames[i], CounterFlags::Is1024, (double)knees[i]);
+
+                allocator->Deallocate(next);
+                allocator->Deallocate(lines);
+            }
+        }
+
+        // STREAM (McCalpin), every array holds 'bytes' of doubles, the threads each take their own slice.
+        // The units write into the shared arrays, this is fine since no two threads touch the same slice.
+        BM_FIXTURE(bandwidth)
+        {
+            static const s64 kMinArray = (s64)16 << 10;
+            static const s64 kMaxArray = (s64)256 << 20;
+
+            struct Arrays
+            {
+                double* a;
+                double* b;
+                double* c;
+            };
+
+            BM_FIXTURE_SETTINGS
+            {
+                BM_ARG_NAME(0, "bytes")->RANGE(kMinArray, kMaxArray, 4);
+                BM_THREAD_SWEEP(ThreadSweep::Powers2 | ThreadSweep::PhysicalCores);
+                BM_SHARED_MEMORY_REQUIRED(3 * kMaxArray + ((s64)64 << 10));
+                BM_TIMEUNIT(TimeUnit::Microsecond);
+                BM_MINWARMUPTIME(0.1);
+            }
+
+            static void BuildArrays(BenchMarkState& state, Allocator* allocator, void*& data)
+            {
+                s64 const n      = state.Range(0) / (s64)sizeof(double);
+                Arrays*   arrays = allocator->Alloc<Arrays>(sizeof(Arrays));
+                arrays->a        = (double*)allocator->Allocate(n * sizeof(double), kLineSize);
+                arrays->b        = (double*)allocator->Allocate(n * sizeof(double), kLineSize);
+                arrays->c        = (double*)allocator->Allocate(n * sizeof(double), kLineSize);
+                for (s64 i = 0; i < n; ++i)
+                {
+                    arrays->a[i] = 1.0;
+                    arrays->b[i] = 2.0;
+                    arrays->c[i] = 0.0;
+                }
+                data = arrays;
+            }
+
+            // The slice [begin, begin + count) of this thread, whole cache lines
+            static void Slice(BenchMarkState const& state, s64& begin, s64& count)
+            {
+                s64 const n        = state.Range(0) / (s64)sizeof(double);
+                s64 const per_line = kLineSize / (s64)sizeof(double);
+                count              = (n / state.Threads()) & ~(per_line - 1);
+                begin              = count * state.ThreadIndex();
+            }
+
+            // The kernels handle 4 doubles per step, 'n' is a multiple of 8 (a cache line)
+            static void Copy(double* dst, double const* src, s64 n)
+            {
+#if defined(BM_STREAM_SSE2)
+                for (s64 i = 0; i < n; i += 4)
+                {
+                    _mm_store_pd(dst + i, _mm_load_pd(src + i));
+                    _mm_store_pd(dst + i + 2, _mm_load_pd(src + i + 2));
+                }
+#elif defined(BM_STREAM_NEON)
+                for (s64 i = 0; i < n; i += 4)
+                {
+                    vst1q_f64(dst + i, vld1q_f64(src + i));
+                    vst1q_f64(dst + i + 2, vld1q_f64(src + i + 2));
+                }
+#else
+                for (s64 i = 0; i < n; ++i)
+                    dst[i] = src[i];
+#endif
+            }
+
+            static void Scale(double* dst, double const* src, double q, s64 n)
+            {
+#if defined(BM_STREAM_SSE2)
+                __m128d const vq = _mm_set1_pd(q);
+                for (s64 i = 0; i < n; i += 4)
+                {
+                    _mm_store_pd(dst + i, _mm_mul_pd(vq, _mm_load_pd(src + i)));
+                    _mm_store_pd(dst + i + 2, _mm_mul_pd(vq, _mm_load_pd(src + i + 2)));
+                }
+#elif defined(BM_STREAM_NEON)
+                float64x2_t const vq = vdupq_n_f64(q);
+                for (s64 i = 0; i < n; i += 4)
+                {
+                    vst1q_f64(dst + i, vmulq_f64(vq, vld1q_f64(src + i)));
+                    vst1q_f64(dst + i + 2, vmulq_f64(vq, vld1q_f64(src + i + 2)));
+                }
+#else
+                for (s64 i = 0; i < n; ++i)
+                    dst[i] = q * src[i];
+#endif
+            }
+
+            static void Add(double* dst, double const* x, double const* y, s64 n)
+            {
+#if defined(BM_STREAM_SSE2)
+                for (s64 i = 0; i < n; i += 4)
+                {
+                    _mm_store_pd(dst + i, _mm_add_pd(_mm_load_pd(x + i), _mm_load_pd(y + i)));
+                    _mm_store_pd(dst + i + 2, _mm_add_pd(_mm_load_pd(x + i + 2), _mm_load_pd(y + i + 2)));
+                }
+#elif defined(BM_STREAM_NEON)
+                for (s64 i = 0; i < n; i += 4)
+                {
+                    vst1q_f64(dst + i, vaddq_f64(vld1q_f64(x + i), vld1q_f64(y + i)));
+                    vst1q_f64(dst + i + 2, vaddq_f64(vld1q_f64(x + i + 2), vld1q_f64(y + i + 2)));
+                }
+#else
+                for (s64 i = 0; i < n; ++i)
+                    dst[i] = x[i] + y[i];
+#endif
+            }
+
+            static void Triad(double* dst, double const* x, double const* y, double q, s64 n)
+            {
+#if defined(BM_STREAM_SSE2)
+                __m128d const vq = _mm_set1_pd(q);
+                for (s64 i = 0; i < n; i += 4)
+                {
+                    _mm_store_pd(dst + i, _mm_add_pd(_mm_load_pd(x + i), _mm_mul_pd(vq, _mm_load_pd(y + i))));
+                    _mm_store_pd(dst + i + 2, _mm_add_pd(_mm_load_pd(x + i + 2), _mm_mul_pd(vq, _mm_load_pd(y + i + 2))));
+                }
+#elif defined(BM_STREAM_NEON)
+                float64x2_t const vq = vdupq_n_f64(q);
+                for (s64 i = 0; i < n; i += 4)
+                {
+                    vst1q_f64(dst + i, vaddq_f64(vld1q_f64(x + i), vmulq_f64(vq, vld1q_f64(y + i))));
+                    vst1q_f64(dst + i + 2, vaddq_f64(vld1q_f64(x + i + 2), vmulq_f64(vq, vld1q_f64(y + i + 2))));
+                }
+#else
+                for (s64 i = 0; i < n; ++i)
+                    dst[i] = x[i] + q * y[i];
+#endif
+            }
+
+            static const double kScalar = 3.0;
+
+            // Bytes moved per iteration is counted the STREAM way, reads plus writes
+            BM_UNIT(copy)
+            {
+                Arrays const* arrays = state.SharedData<Arrays>(BuildArrays);
+                s64           begin, n;
+                Slice(state, begin, n);
+
+                BM_ITERATE { Copy(arrays->c + begin, arrays->a + begin, n); }
+
+                state.SetBytesProcessed(s64(state.Iterations()) * 2 * n * (s64)sizeof(double));
+            }
+
+            BM_UNIT(scale)
+            {
+                Arrays const* arrays = state.SharedData<Arrays>(BuildArrays);
+                s64           begin, n;
+                Slice(state, begin, n);
+
+                BM_ITERATE { Scale(arrays->b + begin, arrays->c + begin, kScalar, n); }
+
+                state.SetBytesProcessed(s64(state.Iterations()) * 2 * n * (s64)sizeof(double));
+            }
+
+            BM_UNIT(add)
+            {
+                Arrays const* arrays = state.SharedData<Arrays>(BuildArrays);
+                s64           begin, n;
+                Slice(state, begin, n);
+
+                BM_ITERATE { Add(arrays->c + begin, arrays->a + begin, arrays->b + begin, n); }
+
+                state.SetBytesProcessed(s64(state.Iterations()) * 3 * n * (s64)sizeof(double));
+            }
+
+            BM_UNIT(triad)
+            {
+                Arrays const* arrays = state.SharedData<Arrays>(BuildArrays);
+                s64           begin, n;
+                Slice(state, begin, n);
+
+                BM_ITERATE { Triad(arrays->a + begin, arrays->b + begin, arrays->c + begin, kScalar, n); }
+
+                state.SetBytesProcessed(s64(state.Iterations()) * 3 * n * (s64)sizeof(double));
+            }
+        }
+    }
+} // namespace BenchMark
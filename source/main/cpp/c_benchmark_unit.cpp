@@ -50,7 +50,7 @@ namespace BenchMark
         }
     }
 
-    void Arg_t::Range(s32 lo, s32 hi, s32 multiplier)
+    void Arg_t::Range(s64 lo, s64 hi, s32 multiplier)
     {
         if (count_only_)
         {
@@ -65,7 +65,7 @@ namespace BenchMark
         }
     }
 
-    void Arg_t::DenseRange(s32 start, s32 limit, s32 step)
+    void Arg_t::DenseRange(s64 start, s64 limit, s32 step)
     {
         if (count_only_)
         {
@@ -109,7 +109,7 @@ namespace BenchMark
         }
     }
 
-    s32 BenchMarkUnit::BuildArgs(Allocator* alloc, Array<Array<s32>>& args)
+    s32 BenchMarkUnit::BuildArgs(Allocator* alloc, Array<Array<s64>>& args)
     {
         // check what we have:
         // - arg values, []{ x:{a,b,c,...}, y:{a,b,c,...}, ...}
@@ -141,12 +141,13 @@ namespace BenchMark
 
             for (s32 i = 0; i < iters; ++i)
             {
-                Array<s32>& arg = args.Alloc();
+                Array<s64>& arg = *new (&args.Alloc()) Array<s64>();
+                arg.Init(alloc, 0, args_count_);
                 for (s32 j = 0; j < args_count_; ++j)
                 {
-                    if (args_[i].mode_ == 0 || args_[i].count_ == 0)
+                    if (args_[j].mode_ == 0 || args_[j].count_ == 0)
                         continue;
-                    arg.PushBack(static_cast<s32>(args_[j].args_[i]));
+                    arg.PushBack(args_[j].args_[i]);
                 }
             }
         }
@@ -168,11 +169,11 @@ namespace BenchMark
             args.Init(alloc, 0, iters);
             for (s32 i = 0; i < iters; ++i)
             {
-                Array<s32>& arg = args.Alloc();
+                Array<s64>& arg = *new (&args.Alloc()) Array<s64>();
                 arg.Init(alloc, 0, args_count_);
                 for (s32 j = 0; j < args_count_; ++j)
                 {
-                    arg.PushBack(static_cast<s32>(args_[j].args_[permute_vector[j]]));
+                    arg.PushBack(args_[j].args_[permute_vector[j]]);
                 }
 
                 IncreasePermuteVector(permute_vector, permute_target, args_count_);
@@ -182,7 +183,7 @@ namespace BenchMark
         if (args.Size() == 0)
         {
             args.Init(alloc, 0, 1);
-            Array<s32>& arg = args.Alloc();
+            new (&args.Alloc()) Array<s64>();
         }
 
         return args.Size();
@@ -220,10 +221,15 @@ namespace BenchMark
     void BenchMarkUnit::PrepareSettings()
     {
         thread_counts_.Release();
+        arrival_rates_.Release();
+        inflight_.Release();
         statistics_.Release();
         counters_.Release();
         counters_size_      = 2;
         thread_counts_size_ = 1;
+        arrival_rates_size_ = 0;
+        inflight_size_      = 0;
+        compare_            = nullptr;
         statistics_count_   = 4;
 
         args_count_ = sizeof(args_) / sizeof(args_[0]);
@@ -250,13 +256,17 @@ namespace BenchMark
         }
 
         thread_counts_.Init(allocator, 0, thread_counts_size_);
+        if (arrival_rates_size_ > 0)
+            arrival_rates_.Init(allocator, 0, arrival_rates_size_);
+        if (inflight_size_ > 0)
+            inflight_.Init(allocator, 0, inflight_size_);
         counters_.counters.Init(allocator, 0, counters_size_);
         statistics_.Init(allocator, 0, statistics_count_);
 
-        AddStatisticsComputer(Statistic("mean", StatisticsMean, {StatisticUnit::Time}));
-        AddStatisticsComputer(Statistic("median", StatisticsMedian, {StatisticUnit::Time}));
-        AddStatisticsComputer(Statistic("stddev", StatisticsStdDev, {StatisticUnit::Time}));
-        AddStatisticsComputer(Statistic("cv", StatisticsCV, {StatisticUnit::Percentage}));
+        AddStatisticsComputer(Statistic("mean", StatisticsMean, StreamingMean, {StatisticUnit::Time}));
+        AddStatisticsComputer(Statistic("median", StatisticsMedian, StreamingMedian, {StatisticUnit::Time}));
+        AddStatisticsComputer(Statistic("stddev", StatisticsStdDev, StreamingStdDev, {StatisticUnit::Time}));
+        AddStatisticsComputer(Statistic("cv", StatisticsCV, StreamingCV, {StatisticUnit::Percentage}));
 
         AddCounter("bytes per second", CounterFlags::IsRate);
         AddCounter("items per second", CounterFlags::IsRate);
@@ -268,16 +278,16 @@ namespace BenchMark
             time_settings_.SetDefaults();
         if (aggregation_report_mode_.IsUnspecified())
             aggregation_report_mode_.SetDefault();
-        if (thread_counts_.Size() == 0)
-            thread_counts_.PushBack(1);
         if (repetitions_ == 0)
-            repetitions_ = 1;
+            repetitions_ = compare_ != nullptr ? Compare_Repetitions : 1;
         if (min_time_ == 0)
             min_time_ = 0.5;
         if (min_warmup_time_ == 0)
             min_warmup_time_ = 0.5;
         if (memory_required_ == 0)
             memory_required_ = 1 << 20; // 1 MB is the minimum
+        if (shared_memory_required_ == 0)
+            shared_memory_required_ = 1 << 20;
     }
 
     void BenchMarkUnit::ReleaseSettings() { PrepareSettings(); }
@@ -305,6 +315,44 @@ namespace BenchMark
             thread_counts_.PushBack(thread_counts[i]);
     }
 
+    void BenchMarkUnit::SetThreadSweep(s32 sweep) { thread_sweep_ = sweep; }
+    void BenchMarkUnit::SetArrival(s32 arrival) { arrival_ = arrival; }
+
+    void BenchMarkUnit::SetArrivalRates(double const* rates, s32 rates_size)
+    {
+        if (count_only_)
+        {
+            arrival_rates_size_ += rates_size;
+            return;
+        }
+        for (s32 i = 0; i < rates_size; ++i)
+            arrival_rates_.PushBack(rates[i]);
+    }
+
+    void BenchMarkUnit::SetArrivalSweep(double lo, double hi, double multi)
+    {
+        // lo, lo * multi, lo * multi^2, ... and hi
+        double rates[64];
+        s32    n = 0;
+        for (double rate = lo; rate < hi && n < 63 && multi > 1.0; rate *= multi)
+            rates[n++] = rate;
+        rates[n++] = hi;
+        SetArrivalRates(rates, n);
+    }
+
+    void BenchMarkUnit::SetInFlight(s32 const* depths, s32 depths_size)
+    {
+        if (count_only_)
+        {
+            inflight_size_ += depths_size;
+            return;
+        }
+        for (s32 i = 0; i < depths_size; ++i)
+            inflight_.PushBack(depths[i] > 0 ? depths[i] : 1);
+    }
+
+    void BenchMarkUnit::SetCompare(const char* group) { compare_ = group; }
+
     void BenchMarkUnit::AddCounter(const char* name, CounterFlags flags, double value)
     {
         if (count_only_)
@@ -326,11 +374,58 @@ namespace BenchMark
     void BenchMarkUnit::SetMinTime(double min_time) { min_time_ = min_time; }
     void BenchMarkUnit::SetMinWarmupTime(double min_warmup_time) { min_warmup_time_ = min_warmup_time; }
     void BenchMarkUnit::SetMemoryRequired(s64 required) { memory_required_ = required; }
+    void BenchMarkUnit::SetSharedMemoryRequired(s64 required) { shared_memory_required_ = required; }
+    void BenchMarkUnit::SetSeed(u64 seed) { seed_ = seed; }
+    void BenchMarkUnit::SetNuma(s32 policy, s32 node)
+    {
+        numa_policy_ = policy;
+        numa_node_   = node;
+    }
+    void BenchMarkUnit::SetPages(s32 pages) { pages_ = pages; }
+    void BenchMarkUnit::SetCache(s32 cache) { cache_ = cache; }
     void BenchMarkUnit::SetIterations(IterationCount iters) { iterations_ = iters; }
     void BenchMarkUnit::SetRepetitions(int repetitions) { repetitions_ = repetitions; }
     void BenchMarkUnit::SetFuncRun(run_function func) { run_ = func; }
     void BenchMarkUnit::SetFuncSettings(settings_function func) { settings_ = func; }
 
+    void gTemplateUnitName(char* name, s32 name_size, const char* family_name, const char* types, s32 index)
+    {
+        // Find the type at 'index', the commas inside <> or () belong to the type
+        const char* type = types;
+        for (s32 depth = 0; *type != '\0' && index > 0; ++type)
+        {
+            if (*type == '<' || *type == '(')
+                ++depth;
+            else if (*type == '>' || *type == ')')
+                --depth;
+            else if (*type == ',' && depth == 0)
+                --index;
+        }
+        while (*type == ' ')
+            ++type;
+
+        const char* end = type;
+        for (s32 depth = 0; *end != '\0' && (*end != ',' || depth > 0); ++end)
+        {
+            if (*end == '<' || *end == '(')
+                ++depth;
+            else if (*end == '>' || *end == ')')
+                --depth;
+        }
+        while (end > type && end[-1] == ' ')
+            --end;
+
+        // The family name leaves room for '<', '>' and the terminator, the type for '>' and the terminator
+        s32 n = 0;
+        for (const char* c = family_name; *c != '\0' && n < name_size - 3; ++c)
+            name[n++] = *c;
+        name[n++] = '<';
+        for (const char* c = type; c < end && n < name_size - 2; ++c)
+            name[n++] = *c;
+        name[n++] = '>';
+        name[n]   = '\0';
+    }
+
     // Append the powers of 'mult' in the closed interval [lo, hi].
     // Returns iterator to the start of the inserted range.
 
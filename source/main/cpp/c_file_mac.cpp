@@ -0,0 +1,84 @@
+#ifdef TARGET_MAC
+
+#    include "cbenchmark/private/c_file.h"
+
+#    include <errno.h>
+#    include <fcntl.h>
+#    include <unistd.h>
+#    include <sys/stat.h>
+
+namespace BenchMark
+{
+    s64 gOpenFile(const char* path)
+    {
+        int const fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0644);
+        return fd < 0 ? -1 : (s64)fd;
+    }
+
+    s64 gCreateFile(const char* path)
+    {
+        int const fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_APPEND, 0644);
+        return fd < 0 ? -1 : (s64)fd;
+    }
+
+    s64 gFileSize(s64 file)
+    {
+        struct stat st;
+        if (file < 0 || fstat((int)file, &st) != 0)
+            return -1;
+        return (s64)st.st_size;
+    }
+
+    bool gReadFile(s64 file, s64 offset, void* data, s64 size)
+    {
+        u8* dst = (u8*)data;
+        while (size > 0)
+        {
+            ssize_t const n = pread((int)file, dst, (size_t)size, (off_t)offset);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            dst += n;
+            offset += n;
+            size -= n;
+        }
+        return true;
+    }
+
+    bool gAppendFile(s64 file, void const* data, s64 size)
+    {
+        // O_APPEND, every write goes to the end of the file
+        u8 const* src = (u8 const*)data;
+        while (size > 0)
+        {
+            ssize_t const n = write((int)file, src, (size_t)size);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            src += n;
+            size -= n;
+        }
+        return true;
+    }
+
+    bool gTruncateFile(s64 file, s64 size)
+    {
+        while (ftruncate((int)file, (off_t)size) != 0)
+        {
+            if (errno != EINTR)
+                return false;
+        }
+        return true;
+    }
+
+    void gCloseFile(s64 file)
+    {
+        if (file >= 0)
+            close((int)file);
+    }
+
+} // namespace BenchMark
+
+#endif
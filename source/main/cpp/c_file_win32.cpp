@@ -0,0 +1,84 @@
+#ifdef TARGET_PC
+
+#include "cbenchmark/private/c_file.h"
+
+#include <windows.h>
+
+namespace BenchMark
+{
+    s64 gOpenFile(const char* path)
+    {
+        HANDLE const handle = ::CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        return handle == INVALID_HANDLE_VALUE ? -1 : (s64)handle;
+    }
+
+    s64 gCreateFile(const char* path)
+    {
+        HANDLE const handle = ::CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        return handle == INVALID_HANDLE_VALUE ? -1 : (s64)handle;
+    }
+
+    s64 gFileSize(s64 file)
+    {
+        LARGE_INTEGER size;
+        if (file < 0 || !::GetFileSizeEx((HANDLE)file, &size))
+            return -1;
+        return (s64)size.QuadPart;
+    }
+
+    bool gReadFile(s64 file, s64 offset, void* data, s64 size)
+    {
+        u8* dst = (u8*)data;
+        while (size > 0)
+        {
+            OVERLAPPED at = {};
+            at.Offset     = (DWORD)((u64)offset & 0xFFFFFFFF);
+            at.OffsetHigh = (DWORD)((u64)offset >> 32);
+
+            DWORD const chunk = size > 0x40000000 ? 0x40000000 : (DWORD)size;
+            DWORD       read  = 0;
+            if (!::ReadFile((HANDLE)file, dst, chunk, &read, &at) || read == 0)
+                return false;
+            dst += read;
+            offset += read;
+            size -= read;
+        }
+        return true;
+    }
+
+    bool gAppendFile(s64 file, void const* data, s64 size)
+    {
+        // An offset of 0xFFFFFFFF:0xFFFFFFFF writes to the end of the file, the handle also needs write access for gTruncateFile
+        u8 const* src = (u8 const*)data;
+        while (size > 0)
+        {
+            OVERLAPPED at = {};
+            at.Offset     = 0xFFFFFFFF;
+            at.OffsetHigh = 0xFFFFFFFF;
+
+            DWORD const chunk   = size > 0x40000000 ? 0x40000000 : (DWORD)size;
+            DWORD       written = 0;
+            if (!::WriteFile((HANDLE)file, src, chunk, &written, &at) || written == 0)
+                return false;
+            src += written;
+            size -= written;
+        }
+        return true;
+    }
+
+    bool gTruncateFile(s64 file, s64 size)
+    {
+        LARGE_INTEGER end;
+        end.QuadPart = size;
+        return ::SetFilePointerEx((HANDLE)file, end, nullptr, FILE_BEGIN) && ::SetEndOfFile((HANDLE)file);
+    }
+
+    void gCloseFile(s64 file)
+    {
+        if (file >= 0)
+            ::CloseHandle((HANDLE)file);
+    }
+
+} // namespace BenchMark
+
+#endif
@@ -0,0 +1,72 @@
+#include "cbenchmark/private/c_memory.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#    include <emmintrin.h>
+#    define BM_CACHE_FLUSH_X86
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+#    define BM_CACHE_FLUSH_ARM64
+#endif
+
+namespace BenchMark
+{
+    static const s64 kCacheLineSize = 64;
+
+    s64 gLastLevelCacheSize()
+    {
+        static s64 llc_size = 0;
+        if (llc_size == 0)
+        {
+            s64       sizes[8];
+            s32 const levels = gCacheSizes(sizes, 8);
+            llc_size         = (s64)32 * 1024 * 1024;
+            if (levels > 0)
+                llc_size = sizes[levels - 1];
+        }
+        return llc_size;
+    }
+
+    s64 gL2CacheSize()
+    {
+        static s64 l2_size = 0;
+        if (l2_size == 0)
+        {
+            s64       sizes[8];
+            s32 const levels = gCacheSizes(sizes, 8);
+            l2_size          = (s64)256 * 1024;
+            if (levels > 1)
+                l2_size = sizes[1];
+        }
+        return l2_size;
+    }
+
+    void gFlushCache(void const* ptr, s64 size)
+    {
+        if (ptr == nullptr || size <= 0)
+            return;
+
+        u8 const* p   = (u8 const*)((u64)ptr & ~(u64)(kCacheLineSize - 1));
+        u8 const* end = (u8 const*)ptr + size;
+#if defined(BM_CACHE_FLUSH_X86)
+        for (; p < end; p += kCacheLineSize)
+            _mm_clflush(p);
+        _mm_mfence();
+#elif defined(BM_CACHE_FLUSH_ARM64)
+        for (; p < end; p += kCacheLineSize)
+            __asm__ volatile("dc civac, %0" : : "r"(p) : "memory");
+        __asm__ volatile("dsb ish" : : : "memory");
+#endif
+    }
+
+    void gWarmCache(void const* ptr, s64 size)
+    {
+        // The sum is handed to a volatile so that the compiler cannot drop the reads
+        volatile u64    sink = 0;
+        u64             sum  = 0;
+        u8 const* const p    = (u8 const*)ptr;
+        for (s64 i = 0; i < size; i += kCacheLineSize)
+            sum += p[i];
+        sink = sum;
+        (void)sink;
+    }
+
+} // namespace BenchMark
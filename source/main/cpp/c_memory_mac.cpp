@@ -0,0 +1,291 @@
+#ifdef TARGET_MAC
+
+#    include "cbenchmark/private/c_memory.h"
+#    include "cbenchmark/private/c_benchmark_enums.h"
+
+#    include <stdio.h>
+#    include <string.h>
+#    include <unistd.h>
+#    include <sys/mman.h>
+#    if defined(__linux__)
+#        include <sys/syscall.h>
+#    else
+#        include <sys/sysctl.h>
+#    endif
+
+namespace BenchMark
+{
+    static s64 sPageSize()
+    {
+        static s64 page_size = 0;
+        if (page_size == 0)
+            page_size = (s64)sysconf(_SC_PAGESIZE);
+        return page_size;
+    }
+
+    static s64 sRoundTo(s64 size, s64 page_size) { return (size + page_size - 1) & ~(page_size - 1); }
+
+    static void* sMapPages(s64 length, int flags)
+    {
+        void* ptr = mmap(nullptr, (size_t)length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+        return ptr == MAP_FAILED ? nullptr : ptr;
+    }
+
+#    if defined(__linux__)
+    enum
+    {
+        MAP_HUGE_SHIFT_ = 26, // log2 of the huge page size is encoded in the mmap flags at this bit
+    };
+
+    static s64 sTransparentHugePageSize()
+    {
+        static s64 huge_page_size = 0;
+        if (huge_page_size == 0)
+        {
+            long  size = 0;
+            FILE* file = fopen("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "r");
+            if (file != nullptr)
+            {
+                if (fscanf(file, "%ld", &size) != 1)
+                    size = 0;
+                fclose(file);
+            }
+            huge_page_size = size > 0 ? (s64)size : (s64)2 * 1024 * 1024;
+        }
+        return huge_page_size;
+    }
+
+    // Explicit huge pages come from the hugetlbfs pool, this fails when the pool does not have enough free pages
+    static void* sMapHugeTlb(s64 size, s64 page_size, int log2_page_size) { return sMapPages(sRoundTo(size, page_size), MAP_HUGETLB | (log2_page_size << MAP_HUGE_SHIFT_)); }
+
+    // Transparent huge pages are only used for the parts of a mapping that are aligned to the huge page size,
+    // so map one huge page more than needed and trim the mapping to an aligned range.
+    static void* sMapTransparent(s64 size, s64 huge_page_size)
+    {
+        s64 const length = sRoundTo(size, huge_page_size);
+        u8*       mapped = (u8*)sMapPages(length + huge_page_size, 0);
+        if (mapped == nullptr)
+            return nullptr;
+
+        u8* begin = (u8*)(((u64)mapped + huge_page_size - 1) & ~(u64)(huge_page_size - 1));
+        u8* end   = begin + length;
+        if (begin > mapped)
+            munmap(mapped, (size_t)(begin - mapped));
+        if (mapped + length + huge_page_size > end)
+            munmap(end, (size_t)(mapped + length + huge_page_size - end));
+
+        // When transparent huge pages are disabled this fails and we just end up with normal pages
+        madvise(begin, (size_t)length, MADV_HUGEPAGE);
+        return begin;
+    }
+
+    void* gAllocatePages(s64 size, s32 pages, s64& page_size)
+    {
+        void* ptr = nullptr;
+        switch (pages)
+        {
+            case Pages::Huge1G:
+                page_size = (s64)1024 * 1024 * 1024;
+                if ((ptr = sMapHugeTlb(size, page_size, 30)) != nullptr)
+                    return ptr;
+                // fall through
+            case Pages::Huge2M:
+                page_size = (s64)2 * 1024 * 1024;
+                if ((ptr = sMapHugeTlb(size, page_size, 21)) != nullptr)
+                    return ptr;
+                // fall through
+            case Pages::Transparent:
+                page_size = sTransparentHugePageSize();
+                if ((ptr = sMapTransparent(size, page_size)) != nullptr)
+                    return ptr;
+                // fall through
+            default: break;
+        }
+        page_size = sPageSize();
+        return sMapPages(sRoundTo(size, page_size), 0);
+    }
+#    else
+    // macOS only has superpages on Intel through the mach VM interface, the arenas always use normal pages
+    void* gAllocatePages(s64 size, s32 pages, s64& page_size)
+    {
+        page_size = sPageSize();
+        return sMapPages(sRoundTo(size, page_size), 0);
+    }
+#    endif
+
+    void gReleasePages(void* ptr, s64 size, s64 page_size)
+    {
+        if (ptr != nullptr)
+            munmap(ptr, (size_t)sRoundTo(size, page_size));
+    }
+
+    void gTouchPages(void* ptr, s64 size)
+    {
+        s64 const      page_size = sPageSize();
+        volatile u8*   p         = (volatile u8*)ptr;
+        for (s64 i = 0; i < size; i += page_size)
+            p[i] = 0;
+    }
+
+#    if defined(__linux__)
+    // The memory policy system calls, used directly so that we do not depend on libnuma
+    enum
+    {
+        MPOL_PREFERRED_  = 1,
+        MPOL_BIND_       = 2,
+        MPOL_INTERLEAVE_ = 3,
+        MPOL_F_NODE_     = 1 << 0,
+        MPOL_F_ADDR_     = 1 << 1,
+    };
+
+    bool gPlacePages(void* ptr, s64 size, s32 numa_policy, s32 numa_node)
+    {
+        unsigned long nodemask = 0;
+        int           mode     = 0;
+        switch (numa_policy)
+        {
+            case NumaPolicy::Interleaved:
+                // The kernel only uses the nodes that exist (and that we are allowed to use)
+                nodemask = ~0UL;
+                mode     = MPOL_INTERLEAVE_;
+                break;
+            case NumaPolicy::Node:
+                if (numa_node < 0 || numa_node >= (s32)(sizeof(nodemask) * 8 - 1))
+                    return false;
+                nodemask = 1UL << numa_node;
+                mode     = MPOL_BIND_;
+                break;
+            default:
+                // Default and Local are first-touch, which is what the kernel does already
+                return true;
+        }
+        return syscall(SYS_mbind, ptr, (unsigned long)sRoundTo(size, sPageSize()), mode, &nodemask, (unsigned long)(sizeof(nodemask) * 8), 0) == 0;
+    }
+
+    s32 gNumaNodeOf(void const* ptr)
+    {
+        int node = -1;
+        if (syscall(SYS_get_mempolicy, &node, nullptr, 0UL, ptr, (unsigned long)(MPOL_F_NODE_ | MPOL_F_ADDR_)) != 0)
+            return -1;
+        return (s32)node;
+    }
+
+    s64 gPageSizeOf(void const* ptr)
+    {
+        FILE* file = fopen("/proc/self/smaps", "r");
+        if (file == nullptr)
+            return 0;
+
+        // Find the mapping that contains 'ptr', its fields follow the line with the address range
+        u64 const addr           = (u64)ptr;
+        bool      in_mapping     = false;
+        bool      line_start     = true;
+        long      kernel_page_kb = 0;
+        long      rss_kb         = 0;
+        long      anon_huge_kb   = 0;
+        char      line[512];
+        while (fgets(line, sizeof(line), file) != nullptr)
+        {
+            // Skip the remainder of lines that did not fit (long paths)
+            bool const is_line = line_start;
+            line_start         = strchr(line, '\n') != nullptr;
+            if (!is_line)
+                continue;
+
+            unsigned long begin = 0, end = 0;
+            if (sscanf(line, "%lx-%lx", &begin, &end) == 2)
+            {
+                if (in_mapping)
+                    break;
+                in_mapping = addr >= begin && addr < end;
+            }
+            else if (in_mapping)
+            {
+                long kb = 0;
+                if (sscanf(line, "KernelPageSize: %ld kB", &kb) == 1)
+                    kernel_page_kb = kb;
+                else if (sscanf(line, "Rss: %ld kB", &kb) == 1)
+                    rss_kb = kb;
+                else if (sscanf(line, "AnonHugePages: %ld kB", &kb) == 1)
+                    anon_huge_kb = kb;
+            }
+        }
+        fclose(file);
+
+        // Transparent huge pages do not change the kernel page size of the mapping, when most of
+        // the mapping is backed by them we report the huge page size.
+        if (anon_huge_kb > 0 && anon_huge_kb * 2 >= rss_kb)
+            return sTransparentHugePageSize();
+        return (s64)kernel_page_kb * 1024;
+    }
+
+    s32 gCacheSizes(s64* sizes, s32 max_levels)
+    {
+        // Every cache of cpu0 is described in its own 'index' directory, instruction caches are skipped
+        s32 levels = 0;
+        for (s32 i = 0; i < max_levels; ++i)
+            sizes[i] = 0;
+        for (s32 index = 0; index < 16; ++index)
+        {
+            char path[128];
+            char type[32] = {0};
+            int  level    = 0;
+            long size     = 0;
+            char unit     = 0;
+
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/type", (int)index);
+            FILE* file = fopen(path, "r");
+            if (file == nullptr)
+                break;
+            bool valid = fscanf(file, "%31s", type) == 1;
+            fclose(file);
+
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/level", (int)index);
+            if ((file = fopen(path, "r")) == nullptr)
+                break;
+            valid = valid && fscanf(file, "%d", &level) == 1;
+            fclose(file);
+
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/size", (int)index);
+            if ((file = fopen(path, "r")) == nullptr)
+                break;
+            valid = valid && fscanf(file, "%ld%c", &size, &unit) >= 1;
+            fclose(file);
+
+            if (!valid || strcmp(type, "Instruction") == 0 || level < 1 || level > max_levels)
+                continue;
+            if (unit == 'K')
+                size *= 1024;
+            else if (unit == 'M')
+                size *= 1024 * 1024;
+            sizes[level - 1] = (s64)size;
+            if (level > levels)
+                levels = level;
+        }
+        return levels;
+    }
+#    else
+    // macOS machines have a single memory node
+    bool gPlacePages(void* ptr, s64 size, s32 numa_policy, s32 numa_node) { return numa_policy == NumaPolicy::Default || numa_policy == NumaPolicy::Local; }
+    s32  gNumaNodeOf(void const* ptr) { return -1; }
+    s64  gPageSizeOf(void const* ptr) { return sPageSize(); }
+
+    s32 gCacheSizes(s64* sizes, s32 max_levels)
+    {
+        const char* names[] = {"hw.l1dcachesize", "hw.l2cachesize", "hw.l3cachesize"};
+        s32         levels  = 0;
+        while (levels < max_levels && levels < (s32)(sizeof(names) / sizeof(names[0])))
+        {
+            int64_t size   = 0;
+            size_t  length = sizeof(size);
+            if (sysctlbyname(names[levels], &size, &length, nullptr, 0) != 0 || size <= 0)
+                break;
+            sizes[levels++] = (s64)size;
+        }
+        return levels;
+    }
+#    endif
+
+} // namespace BenchMark
+
+#endif
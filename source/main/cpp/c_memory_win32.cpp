@@ -0,0 +1,118 @@
+#ifdef TARGET_PC
+
+#include "cbenchmark/private/c_memory.h"
+#include "cbenchmark/private/c_benchmark_enums.h"
+
+#include <windows.h>
+#include <psapi.h>
+
+namespace BenchMark
+{
+    static s64 sPageSize()
+    {
+        SYSTEM_INFO info;
+        ::GetSystemInfo(&info);
+        return (s64)info.dwPageSize;
+    }
+
+    // Large pages need the 'Lock pages in memory' privilege, it has to be granted to the user and enabled for the process
+    static bool sEnableLockMemoryPrivilege()
+    {
+        HANDLE token = nullptr;
+        if (!::OpenProcessToken(::GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+            return false;
+
+        TOKEN_PRIVILEGES privileges;
+        privileges.PrivilegeCount           = 1;
+        privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+        bool enabled                        = ::LookupPrivilegeValueA(nullptr, "SeLockMemoryPrivilege", &privileges.Privileges[0].Luid) != 0;
+        enabled                             = enabled && ::AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr) != 0 && ::GetLastError() == ERROR_SUCCESS;
+        ::CloseHandle(token);
+        return enabled;
+    }
+
+    // Windows has no transparent huge pages and only one large page size (usually 2 MiB), Huge1G is served
+    // with those and without the privilege we fall back to normal pages.
+    void* gAllocatePages(s64 size, s32 pages, s64& page_size)
+    {
+        if (pages == Pages::Huge2M || pages == Pages::Huge1G)
+        {
+            static bool const has_privilege = sEnableLockMemoryPrivilege();
+            s64 const         large         = (s64)::GetLargePageMinimum();
+            if (has_privilege && large != 0)
+            {
+                void* ptr = ::VirtualAlloc(nullptr, (SIZE_T)((size + large - 1) & ~(large - 1)), MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+                if (ptr != nullptr)
+                {
+                    page_size = large;
+                    return ptr;
+                }
+            }
+        }
+        page_size = sPageSize();
+        return ::VirtualAlloc(nullptr, (SIZE_T)size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    }
+
+    void gReleasePages(void* ptr, s64 size, s64 page_size)
+    {
+        if (ptr != nullptr)
+            ::VirtualFree(ptr, 0, MEM_RELEASE);
+    }
+
+    void gTouchPages(void* ptr, s64 size)
+    {
+        s64 const    page_size = sPageSize();
+        volatile u8* p         = (volatile u8*)ptr;
+        for (s64 i = 0; i < size; i += page_size)
+            p[i] = 0;
+    }
+
+    // Windows can only place memory when it is allocated (VirtualAllocExNuma), pages are first-touch
+    bool gPlacePages(void* ptr, s64 size, s32 numa_policy, s32 numa_node) { return numa_policy == NumaPolicy::Default || numa_policy == NumaPolicy::Local; }
+
+    s32 gNumaNodeOf(void const* ptr)
+    {
+        PSAPI_WORKING_SET_EX_INFORMATION info;
+        info.VirtualAddress = (PVOID)ptr;
+        if (!::QueryWorkingSetEx(::GetCurrentProcess(), &info, sizeof(info)) || !info.VirtualAttributes.Valid)
+            return -1;
+        return (s32)info.VirtualAttributes.Node;
+    }
+
+    s64 gPageSizeOf(void const* ptr)
+    {
+        PSAPI_WORKING_SET_EX_INFORMATION info;
+        info.VirtualAddress = (PVOID)ptr;
+        if (!::QueryWorkingSetEx(::GetCurrentProcess(), &info, sizeof(info)) || !info.VirtualAttributes.Valid)
+            return 0;
+        return info.VirtualAttributes.LargePage ? (s64)::GetLargePageMinimum() : sPageSize();
+    }
+
+    s32 gCacheSizes(s64* sizes, s32 max_levels)
+    {
+        SYSTEM_LOGICAL_PROCESSOR_INFORMATION infos[256];
+        DWORD                                length = sizeof(infos);
+        if (!::GetLogicalProcessorInformation(infos, &length))
+            return 0;
+
+        s32 levels = 0;
+        for (s32 i = 0; i < max_levels; ++i)
+            sizes[i] = 0;
+        for (DWORD i = 0; i < length / sizeof(infos[0]); ++i)
+        {
+            SYSTEM_LOGICAL_PROCESSOR_INFORMATION const& info = infos[i];
+            if (info.Relationship != RelationCache || info.Cache.Type == CacheInstruction)
+                continue;
+            s32 const level = (s32)info.Cache.Level;
+            if (level < 1 || level > max_levels)
+                continue;
+            sizes[level - 1] = (s64)info.Cache.Size;
+            if (level > levels)
+                levels = level;
+        }
+        return levels;
+    }
+
+} // namespace BenchMark
+
+#endif
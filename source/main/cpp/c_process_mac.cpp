@@ -0,0 +1,427 @@
+#ifdef TARGET_MAC
+
+#    include "cbenchmark/private/c_process.h"
+#    include "cbenchmark/private/c_utils.h"
+
+#    include <stdio.h>
+#    include <unistd.h>
+#    include <errno.h>
+#    include <stdlib.h>
+#    include <string.h>
+#    include <fcntl.h>
+#    include <sys/types.h>
+#    include <sys/wait.h>
+#    include <sys/utsname.h>
+#    if defined(__linux__)
+#        include <sched.h>
+#        include <link.h>
+#    elif defined(__APPLE__)
+#        include <sys/sysctl.h>
+#    endif
+
+namespace BenchMark
+{
+    bool gCanForkProcess() { return true; }
+
+    s32 gForkProcess(ChildProcess& child)
+    {
+        child.pid = -1;
+        child.fd  = -1;
+
+        int fds[2];
+        if (pipe(fds) != 0)
+            return -1;
+
+        // Anything still buffered would otherwise be printed twice
+        fflush(stdout);
+        fflush(stderr);
+
+        pid_t const pid = fork();
+        if (pid < 0)
+        {
+            close(fds[0]);
+            close(fds[1]);
+            return -1;
+        }
+
+        if (pid == 0)
+        {
+            close(fds[0]);
+            child.pid = 0;
+            child.fd  = fds[1];
+            return 0;
+        }
+
+        close(fds[1]);
+        child.pid = pid;
+        child.fd  = fds[0];
+        return 1;
+    }
+
+    bool gWriteToParent(ChildProcess& child, void const* data, s64 size)
+    {
+        u8 const* src = (u8 const*)data;
+        while (size > 0)
+        {
+            ssize_t const n = write(child.fd, src, (size_t)size);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            src += n;
+            size -= n;
+        }
+        return true;
+    }
+
+    void gExitChild(ChildProcess& child)
+    {
+        fflush(stdout);
+        fflush(stderr);
+        close(child.fd);
+        _exit(0);
+    }
+
+    bool gReadFromChild(ChildProcess& child, void* data, s64 size)
+    {
+        u8* dst = (u8*)data;
+        while (size > 0)
+        {
+            ssize_t const n = read(child.fd, dst, (size_t)size);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            dst += n;
+            size -= n;
+        }
+        return true;
+    }
+
+    bool gWaitForChild(ChildProcess& child)
+    {
+        if (child.fd >= 0)
+            close(child.fd);
+        child.fd = -1;
+
+        int status = 0;
+        pid_t const pid = (pid_t)child.pid;
+        child.pid       = -1;
+        while (waitpid(pid, &status, 0) < 0)
+        {
+            if (errno != EINTR)
+                return false;
+        }
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+#    if defined(__linux__)
+    // Reads the first integers of a (sysfs or cgroup) file, returns the number of integers read
+    static s32 sReadIntegers(const char* path, s64* values, s32 count)
+    {
+        FILE* file = fopen(path, "r");
+        if (file == nullptr)
+            return 0;
+        s32 n = 0;
+        while (n < count && fscanf(file, "%lld", (long long*)&values[n]) == 1)
+            ++n;
+        fclose(file);
+        return n;
+    }
+
+    // The number of cores a cgroup CPU quota amounts to (rounded up), 0 if there is no quota
+    static s32 sCgroupQuotaCores()
+    {
+        s64 quota[2];
+
+        // cgroup v2, "max 100000" or "<quota> <period>", 'max' does not parse as an integer
+        if (sReadIntegers("/sys/fs/cgroup/cpu.max", quota, 2) == 2 && quota[0] > 0 && quota[1] > 0)
+            return (s32)((quota[0] + quota[1] - 1) / quota[1]);
+
+        // cgroup v1, a quota of -1 means unlimited
+        s64 period = 0;
+        if (sReadIntegers("/sys/fs/cgroup/cpu/cpu.cfs_quota_us", quota, 1) == 1 && sReadIntegers("/sys/fs/cgroup/cpu/cpu.cfs_period_us", &period, 1) == 1 && quota[0] > 0 && period > 0)
+            return (s32)((quota[0] + period - 1) / period);
+        return 0;
+    }
+
+    // The cores the process can run on, read before any thread of the process is pinned and again when
+    // the process itself is pinned to some of them (a shard worker, see gPinToCores)
+    struct ProcessCores
+    {
+        ProcessCores()
+        {
+            CPU_ZERO(&set);
+            if (sched_getaffinity(0, sizeof(set), &set) != 0)
+                CPU_ZERO(&set);
+            count = CPU_COUNT(&set);
+
+            // A physical core is a distinct (package, core) pair, its hardware threads count once
+            physical = 0;
+            s64 seen[CPU_SETSIZE];
+            for (s32 cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            {
+                if (!CPU_ISSET(cpu, &set))
+                    continue;
+
+                char path[128];
+                s64  package = 0, core = 0;
+                snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+                sReadIntegers(path, &package, 1);
+                snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/core_id", cpu);
+                if (sReadIntegers(path, &core, 1) != 1)
+                    core = cpu;
+
+                s64 const id = (package << 32) | core;
+                s32       i  = 0;
+                while (i < physical && seen[i] != id)
+                    ++i;
+                if (i == physical)
+                    seen[physical++] = id;
+            }
+
+            quota = sCgroupQuotaCores();
+        }
+        cpu_set_t set;
+        s32       count;
+        s32       physical;
+        s32       quota; // 0 if the cgroup has no CPU quota
+    };
+
+    static ProcessCores& sProcessCores()
+    {
+        static ProcessCores cores;
+        return cores;
+    }
+
+    s32 gNumCores()
+    {
+        ProcessCores const& cores = sProcessCores();
+        s32                 n     = cores.count;
+        if (n <= 0)
+        {
+            long const online = sysconf(_SC_NPROCESSORS_ONLN);
+            n                 = online > 0 ? (s32)online : 1;
+        }
+        return (cores.quota > 0 && cores.quota < n) ? cores.quota : n;
+    }
+
+    s32 gNumPhysicalCores()
+    {
+        ProcessCores const& cores = sProcessCores();
+        s32 const           n     = gNumCores();
+        return (cores.physical > 0 && cores.physical < n) ? cores.physical : n;
+    }
+
+    bool gPinToCores(s32 first, s32 count)
+    {
+        ProcessCores const& cores = sProcessCores();
+        if (cores.count == 0)
+            return false;
+
+        // 'first' and 'count' index the cores the process was started with
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        s32 nth = 0;
+        for (s32 cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (!CPU_ISSET(cpu, &cores.set))
+                continue;
+            if (nth >= first && nth < first + count)
+                CPU_SET(cpu, &set);
+            ++nth;
+        }
+        if (CPU_COUNT(&set) == 0 || sched_setaffinity(0, sizeof(set), &set) != 0)
+            return false;
+
+        // From now on the thread sweeps and gPinThread resolve against the cores of this process only
+        sProcessCores() = ProcessCores();
+        return true;
+    }
+
+    bool gPinThread(s32 core)
+    {
+        ProcessCores const& cores = sProcessCores();
+        if (cores.count == 0)
+            return false;
+
+        s32 nth = core % cores.count;
+        for (s32 cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (!CPU_ISSET(cpu, &cores.set) || nth-- > 0)
+                continue;
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            return sched_setaffinity(0, sizeof(set), &set) == 0;
+        }
+        return false;
+    }
+
+    void gUnpinThread()
+    {
+        ProcessCores const& cores = sProcessCores();
+        if (cores.count > 0)
+            sched_setaffinity(0, sizeof(cores.set), &cores.set);
+    }
+#    else
+    s32 gNumCores()
+    {
+        long const n = sysconf(_SC_NPROCESSORS_ONLN);
+        return n > 0 ? (s32)n : 1;
+    }
+
+    s32 gNumPhysicalCores()
+    {
+#        if defined(__APPLE__)
+        int    physical = 0;
+        size_t size     = sizeof(physical);
+        if (sysctlbyname("hw.physicalcpu", &physical, &size, nullptr, 0) == 0 && physical > 0)
+            return (s32)physical;
+#        endif
+        return gNumCores();
+    }
+
+    // macOS has no API to pin a process to specific cores
+    bool gPinToCores(s32 first, s32 count) { return false; }
+    bool gPinThread(s32 core) { return false; }
+    void gUnpinThread() {}
+#    endif
+
+#    if defined(__linux__)
+    // The function symbols of the executable (its .symtab), read once from the file and sorted by address
+    struct ExecutableSymbols
+    {
+        ExecutableSymbols()
+            : symbols(nullptr)
+            , count(0)
+            , bias(0)
+        {
+            // The first object is the executable itself, its load bias turns a symbol value into an address
+            dl_iterate_phdr(sFirstObject, &bias);
+
+            int const fd = open("/proc/self/exe", O_RDONLY);
+            if (fd < 0)
+                return;
+
+            ElfW(Ehdr) header;
+            if (pread(fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header) && memcmp(header.e_ident, ELFMAG, SELFMAG) == 0 && header.e_shentsize == sizeof(ElfW(Shdr)))
+            {
+                for (s32 i = 0; i < header.e_shnum && symbols == nullptr; ++i)
+                {
+                    ElfW(Shdr) section;
+                    if (pread(fd, &section, sizeof(section), header.e_shoff + i * sizeof(section)) != (ssize_t)sizeof(section) || section.sh_type != SHT_SYMTAB || section.sh_entsize != sizeof(ElfW(Sym)))
+                        continue;
+
+                    symbols = (ElfW(Sym)*)malloc(section.sh_size);
+                    count   = (s64)(section.sh_size / sizeof(ElfW(Sym)));
+                    if (symbols != nullptr && pread(fd, symbols, section.sh_size, section.sh_offset) != (ssize_t)section.sh_size)
+                    {
+                        free(symbols);
+                        symbols = nullptr;
+                        count   = 0;
+                    }
+                }
+            }
+            close(fd);
+
+            // Only the functions with a size are of use, sorted by address they can be binary searched
+            s64 functions = 0;
+            for (s64 i = 0; i < count; ++i)
+            {
+                if (ELF64_ST_TYPE(symbols[i].st_info) == STT_FUNC && symbols[i].st_size != 0)
+                    symbols[functions++] = symbols[i];
+            }
+            count = functions;
+            if (count > 0)
+                qsort(symbols, (size_t)count, sizeof(ElfW(Sym)), sCompareAddress);
+        }
+
+        static int sFirstObject(struct dl_phdr_info* info, size_t, void* data)
+        {
+            *(u64*)data = (u64)info->dlpi_addr;
+            return 1;
+        }
+
+        static int sCompareAddress(void const* a, void const* b)
+        {
+            ElfW(Addr) const va = ((ElfW(Sym) const*)a)->st_value;
+            ElfW(Addr) const vb = ((ElfW(Sym) const*)b)->st_value;
+            return va < vb ? -1 : (va > vb ? 1 : 0);
+        }
+
+        ElfW(Sym)* symbols;
+        s64        count;
+        u64        bias;
+    };
+
+    bool gFunctionCode(void const* address, u8 const*& begin, u8 const*& end)
+    {
+        static ExecutableSymbols const executable;
+
+        // The last function that starts at or before the address
+        u64 const value = (u64)address - executable.bias;
+        s64       lo    = 0;
+        s64       hi    = executable.count;
+        while (lo < hi)
+        {
+            s64 const mid = lo + (hi - lo) / 2;
+            if (executable.symbols[mid].st_value <= value)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo == 0)
+            return false;
+
+        ElfW(Sym) const& symbol = executable.symbols[lo - 1];
+        if (value >= symbol.st_value + symbol.st_size)
+            return false;
+
+        begin = (u8 const*)(executable.bias + symbol.st_value);
+        end   = begin + symbol.st_size;
+        return true;
+    }
+#    else
+    // dladdr() tells where a function starts but not where it ends
+    bool gFunctionCode(void const* address, u8 const*& begin, u8 const*& end) { return false; }
+#    endif
+
+    u64 gMachineFingerprint()
+    {
+        u64 hash = kHashSeed;
+
+        struct utsname name;
+        if (uname(&name) == 0)
+        {
+            hash = gHash(hash, name.nodename, strlen(name.nodename));
+            hash = gHash(hash, name.sysname, strlen(name.sysname));
+            hash = gHash(hash, name.release, strlen(name.release));
+            hash = gHash(hash, name.machine, strlen(name.machine));
+        }
+
+        char cpu[256] = {0};
+#    if defined(__linux__)
+        if (FILE* file = fopen("/proc/cpuinfo", "r"))
+        {
+            char line[256];
+            while (cpu[0] == '\0' && fgets(line, sizeof(line), file) != nullptr)
+            {
+                if (strncmp(line, "model name", 10) == 0)
+                    snprintf(cpu, sizeof(cpu), "%s", line);
+            }
+            fclose(file);
+        }
+#    elif defined(__APPLE__)
+        size_t size = sizeof(cpu) - 1;
+        sysctlbyname("machdep.cpu.brand_string", cpu, &size, nullptr, 0);
+#    endif
+        hash = gHash(hash, cpu, strlen(cpu));
+
+        s32 const cores = gNumCores();
+        return gHash(hash, &cores, sizeof(cores));
+    }
+
+} // namespace BenchMark
+
+#endif
@@ -0,0 +1,171 @@
+#ifdef TARGET_PC
+
+#include "cbenchmark/private/c_process.h"
+#include "cbenchmark/private/c_utils.h"
+
+#include <windows.h>
+#include <intrin.h>
+
+namespace BenchMark
+{
+    // There is no fork() on Windows, benchmarks always run in the process itself
+    bool gCanForkProcess() { return false; }
+
+    s32 gForkProcess(ChildProcess& child)
+    {
+        child.pid = -1;
+        child.fd  = -1;
+        return -1;
+    }
+
+    bool gWriteToParent(ChildProcess& child, void const* data, s64 size) { return false; }
+    void gExitChild(ChildProcess& child) {}
+    bool gReadFromChild(ChildProcess& child, void* data, s64 size) { return false; }
+    bool gWaitForChild(ChildProcess& child) { return false; }
+
+    // The cores the process can run on, read before any thread of the process is pinned and updated when
+    // the process itself is pinned to some of them (a shard worker, see gPinToCores)
+    static DWORD_PTR& sProcessCores()
+    {
+        struct ProcessCores
+        {
+            ProcessCores()
+                : mask(0)
+            {
+                DWORD_PTR system_mask = 0;
+                if (!::GetProcessAffinityMask(::GetCurrentProcess(), &mask, &system_mask))
+                    mask = 0;
+            }
+            DWORD_PTR mask;
+        };
+        static ProcessCores cores;
+        return cores.mask;
+    }
+
+    s32 gNumCores()
+    {
+        s32 count = 0;
+        for (DWORD_PTR m = sProcessCores(); m != 0; m &= m - 1)
+            ++count;
+        if (count > 0)
+            return count;
+
+        SYSTEM_INFO info;
+        ::GetSystemInfo(&info);
+        return info.dwNumberOfProcessors > 0 ? (s32)info.dwNumberOfProcessors : 1;
+    }
+
+    s32 gNumPhysicalCores()
+    {
+        SYSTEM_LOGICAL_PROCESSOR_INFORMATION info[256];
+        DWORD                                size = sizeof(info);
+        if (!::GetLogicalProcessorInformation(info, &size))
+            return gNumCores();
+
+        // A core counts if any of its hardware threads is in the affinity mask of the process
+        DWORD_PTR const mask     = sProcessCores();
+        s32             physical = 0;
+        for (DWORD i = 0; i < size / sizeof(info[0]); ++i)
+        {
+            if (info[i].Relationship == RelationProcessorCore && (mask == 0 || (info[i].ProcessorMask & mask) != 0))
+                ++physical;
+        }
+        return physical > 0 ? physical : gNumCores();
+    }
+
+    bool gPinToCores(s32 first, s32 count)
+    {
+        // 'first' and 'count' index the cores the process was started with
+        DWORD_PTR const cores = sProcessCores();
+        DWORD_PTR       mask  = 0;
+        s32             nth   = 0;
+        for (s32 cpu = 0; cpu < (s32)(sizeof(DWORD_PTR) * 8); ++cpu)
+        {
+            if ((cores & ((DWORD_PTR)1 << cpu)) == 0)
+                continue;
+            if (nth >= first && nth < first + count)
+                mask |= (DWORD_PTR)1 << cpu;
+            ++nth;
+        }
+        if (mask == 0 || ::SetProcessAffinityMask(::GetCurrentProcess(), mask) == 0)
+            return false;
+
+        // From now on the thread sweeps and gPinThread resolve against the cores of this process only
+        sProcessCores() = mask;
+        return true;
+    }
+
+    bool gPinThread(s32 core)
+    {
+        DWORD_PTR const mask  = sProcessCores();
+        s32             count = 0;
+        for (DWORD_PTR m = mask; m != 0; m &= m - 1)
+            ++count;
+        if (count == 0)
+            return false;
+
+        s32 nth = core % count;
+        for (s32 cpu = 0; cpu < (s32)(sizeof(DWORD_PTR) * 8); ++cpu)
+        {
+            if ((mask & ((DWORD_PTR)1 << cpu)) == 0 || nth-- > 0)
+                continue;
+            return ::SetThreadAffinityMask(::GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+        }
+        return false;
+    }
+
+    void gUnpinThread()
+    {
+        DWORD_PTR const mask = sProcessCores();
+        if (mask != 0)
+            ::SetThreadAffinityMask(::GetCurrentThread(), mask);
+    }
+
+    bool gFunctionCode(void const* address, u8 const*& begin, u8 const*& end)
+    {
+#if defined(_M_X64)
+        // The unwind entry of the function, an incremental linking thunk or a leaf function does not have one
+        DWORD64                 image_base = 0;
+        PRUNTIME_FUNCTION const function   = ::RtlLookupFunctionEntry((DWORD64)address, &image_base, nullptr);
+        if (function == nullptr)
+            return false;
+        begin = (u8 const*)(image_base + function->BeginAddress);
+        end   = (u8 const*)(image_base + function->EndAddress);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    u64 gMachineFingerprint()
+    {
+        u64 hash = kHashSeed;
+
+        char  name[MAX_COMPUTERNAME_LENGTH + 1] = {0};
+        DWORD size                              = sizeof(name);
+        if (::GetComputerNameA(name, &size))
+            hash = gHash(hash, name, size);
+
+        // The CPU brand string, e.g. "Intel(R) Core(TM) i9-9900K CPU @ 3.60GHz"
+        int regs[4] = {0};
+        __cpuid(regs, 0x80000000);
+        if ((unsigned)regs[0] >= 0x80000004)
+        {
+            for (int leaf = 0x80000002; leaf <= 0x80000004; ++leaf)
+            {
+                __cpuid(regs, leaf);
+                hash = gHash(hash, regs, sizeof(regs));
+            }
+        }
+
+        SYSTEM_INFO info;
+        ::GetSystemInfo(&info);
+        hash = gHash(hash, &info.wProcessorArchitecture, sizeof(info.wProcessorArchitecture));
+
+        s32 const cores = gNumCores();
+        return gHash(hash, &cores, sizeof(cores));
+    }
+
+} // namespace BenchMark
+
+#endif
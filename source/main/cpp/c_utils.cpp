@@ -290,4 +290,15 @@ namespace BenchMark
         return src;
     }
 
+    u64 gHash(u64 seed, void const* data, s64 size)
+    {
+        u64 hash = seed;
+        for (s64 i = 0; i < size; ++i)
+        {
+            hash ^= ((u8 const*)data)[i];
+            hash *= 0x100000001B3ULL;
+        }
+        return hash;
+    }
+
 } // namespace BenchMark
@@ -81,6 +81,9 @@ int main(int argc, char** argv)
     BenchMark::BenchMarkGlobals globals;
     forward_allocator.Initialize(&main_allocator, 16 * 1024);
 
+    if (!BenchMark::gParseArguments(&globals, argc, argv))
+        return -1;
+
     StdOut                     stdoutput;
     BenchMark::ConsoleReporter reporter;
     reporter.Initialize(&forward_allocator, &stdoutput);
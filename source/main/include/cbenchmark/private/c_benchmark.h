@@ -13,6 +13,20 @@ namespace BenchMark
 
     bool gRunBenchMark(MainAllocator* allocator, BenchMarkGlobals* globals, BenchMarkReporter& reporter);
 
+    // Apply the command line arguments to 'globals', returns false if an argument is malformed or
+    // arguments do not combine.
+    //   --shard=i/N          Only run the instances of shard 'i' (0 <= i < N)
+    //   --shard_workers=N    Run N worker processes, one per shard, and report their merged results
+    //   --interleave=unit    Run the repetitions of the instances of every unit in a random order
+    //   --interleave=global  Run the repetitions of the instances of all units in a random order
+    //   --isolation=unit     Run every unit in a child process, a crash is reported as a skipped run
+    //   --isolation=instance Run every instance in a child process of its own
+    //   --cache=path         Reuse the fresh runs of this result cache and add the new runs to it (no shards, no checkpoint)
+    //   --checkpoint=path    Write every repetition that completes to this file (no shards)
+    //   --resume             Continue the session of --checkpoint, its repetitions do not run again
+    //   --builtin=a,b        Also run the built-in suites 'a' and 'b' (memory, concurrency)
+    bool gParseArguments(BenchMarkGlobals* globals, int argc, char** argv);
+
 } // namespace BenchMark
 
 #endif // __CBENCHMARK_RUN_BENCHMARK_H__
@@ -62,6 +62,16 @@ namespace BenchMark
         void Reset();
         void Release();
 
+        // Touch every page of the memory block, so that a benchmark does not take the page faults while it is timed
+        void Prefault();
+
+        // Returns the largest size that a single allocation with 'alignment' can still get
+        s64 Available(unsigned int alignment = sizeof(void*)) const;
+
+        // The memory block this allocator hands out from
+        void const* Buffer() const { return buffer_begin_; }
+        s64         Size() const { return buffer_end_ - buffer_begin_; }
+
         template <typename T> T* Checkout(unsigned int count, unsigned int alignment = sizeof(void*)) { return (T*)v_Checkout(count * sizeof(T), alignment); }
         void                     Commit(void* ptr) { v_Commit(ptr); }
 
@@ -132,6 +142,29 @@ namespace BenchMark
 
 #define USE_SCRATCH(allocator_name) ScopedScratchAllocator allocator_name##_scope(allocator_name)
 
+    // Takes memory directly from the OS and places it on the NUMA node(s) given by 'numa_policy' (see NumaPolicy),
+    // backed by the kind of pages given by 'pages' (see Pages). Every allocation is touched (prefaulted) by the
+    // calling thread, so with NumaPolicy::Local the memory ends up on the node of the thread that allocates it.
+    // This is the source of the per-thread arenas of a benchmark.
+    class PageAllocator : public Allocator
+    {
+    public:
+        PageAllocator(s32 numa_policy, s32 numa_node, s32 pages)
+            : numa_policy_(numa_policy)
+            , numa_node_(numa_node)
+            , pages_(pages)
+        {
+        }
+
+    protected:
+        virtual void* v_Allocate(s64 size, unsigned int alignment);
+        virtual void  v_Deallocate(void* ptr);
+
+        s32 numa_policy_;
+        s32 numa_node_;
+        s32 pages_;
+    };
+
     class NullAllocator : public Allocator
     {
     public:
@@ -0,0 +1,60 @@
+#ifndef __CBENCHMARK_BENCHMARK_CACHE_H__
+#define __CBENCHMARK_BENCHMARK_CACHE_H__
+
+#include "cbenchmark/private/c_benchmark_allocators.h"
+#include "cbenchmark/private/c_benchmark_array.h"
+
+namespace BenchMark
+{
+    class BenchMarkRun;
+    class BenchMarkInstance;
+    class BenchMarkGlobals;
+
+    // A persistent cache of the runs of instances (see 'benchmark_cache_file'). An instance is keyed by its full name,
+    // the settings it runs with, a hash of the machine code of its benchmark function and the fingerprint of the
+    // machine, so a change to the benchmark or a run on another machine does not find the runs of before.
+    // NOTE: Only the code of the benchmark function itself is hashed, not the code of the functions it calls.
+    //
+    // The file is only ever appended to, a record holds the key, the time it was written and the runs of all the
+    // repetitions of an instance. Opening the cache reads the headers of the records into an index (open addressing
+    // on the key), so a lookup is O(1). A later record of a key replaces an earlier one.
+    class ResultCache
+    {
+    public:
+        ResultCache();
+
+        // Opens (or creates) the file and indexes its records, returns false if the file cannot be opened or when
+        // the code of the benchmark functions cannot be found (a stripped executable, this prints a warning).
+        // A record older than 'max_age' (seconds) is not used.
+        bool Open(Allocator* allocator, const char* path, double max_age);
+        void Close();
+
+        // The key of an instance, 0 if it cannot be cached (the code of its benchmark function is not known)
+        u64 KeyOf(ScratchAllocator* scratch, BenchMarkGlobals const* globals, BenchMarkInstance const* instance) const;
+
+        // Decodes the runs of the record of 'key' and adds them to 'runs', the runs are marked as cached.
+        // Returns false, and adds nothing, if there is no fresh record or it does not hold 'count' runs.
+        bool Load(u64 key, ForwardAllocator* allocator, ScratchAllocator* scratch, s32 count, Array<BenchMarkRun*>& runs);
+
+        // Appends a record with 'runs' (the repetitions of an instance) to the file
+        void Store(u64 key, ScratchAllocator* scratch, Array<BenchMarkRun*> const& runs);
+
+    private:
+        s32  Find(u64 key) const;
+        void Insert(u64 key, s64 offset, s64 time);
+
+        Allocator* allocator_;
+        s64        file_;
+        s64        file_size_;
+        u64        machine_;
+        double     max_age_;
+        u64*       keys_;    // Index, 0 is an empty slot
+        s64*       offsets_; // Index, the offset of the record in the file
+        s64*       times_;   // Index, when the record was written (seconds since the epoch)
+        s32        capacity_;
+        s32        count_;
+    };
+
+} // namespace BenchMark
+
+#endif // __CBENCHMARK_BENCHMARK_CACHE_H__
@@ -0,0 +1,52 @@
+#ifndef __CBENCHMARK_BENCHMARK_CHECKPOINT_H__
+#define __CBENCHMARK_BENCHMARK_CHECKPOINT_H__
+
+#include "cbenchmark/private/c_benchmark_allocators.h"
+
+namespace BenchMark
+{
+    class BenchMarkRun;
+    class BenchMarkInstance;
+
+    // A checkpoint of a session (see 'benchmark_checkpoint_file'), so that a session that is killed can continue
+    // where it stopped instead of starting from zero.
+    // The schedule of a session, the order in which the repetitions of all the instances run, only depends on the
+    // benchmarks, the settings and the interleaving seed. The position in the schedule is the number of repetitions
+    // that completed, every repetition that completes is appended to the file together with its run.
+    //
+    // A resumed session takes the seed from the checkpoint so it has the same schedule, the repetitions up to the
+    // position of the checkpoint are replayed from their runs instead of run. The report is the one of a session
+    // that was not interrupted.
+    class Checkpoint
+    {
+    public:
+        Checkpoint();
+
+        // Starts a new checkpoint, or with 'resume' continues the one in the file and restores 'seed' from it.
+        // Returns false if the file cannot be opened.
+        bool Open(Allocator* allocator, const char* path, bool resume, u64& seed);
+        void Close();
+
+        s64 Position() const { return position_; }
+
+        // The run of the repetition at the position, when the checkpoint has it and it is of 'instance', and moves
+        // to the next position. Otherwise returns false, the checkpoint is cut at the position.
+        bool Replay(ForwardAllocator* allocator, ScratchAllocator* scratch, BenchMarkInstance const* instance, BenchMarkRun* run);
+
+        // Appends the run of the repetition at the position and moves to the next position
+        void Record(ScratchAllocator* scratch, BenchMarkInstance const* instance, BenchMarkRun const* run);
+
+    private:
+        bool Truncate(s64 size);
+
+        Allocator* allocator_;
+        s64        file_;
+        s64        file_size_;
+        s64*       offsets_; // The offset of the record of every position that can be replayed
+        s64        count_;   // The number of positions that can be replayed
+        s64        position_;
+    };
+
+} // namespace BenchMark
+
+#endif // __CBENCHMARK_BENCHMARK_CHECKPOINT_H__
@@ -0,0 +1,21 @@
+#ifndef __CBENCHMARK_BENCHMARK_COMPARE_H__
+#define __CBENCHMARK_BENCHMARK_COMPARE_H__
+
+#include "cbenchmark/private/c_benchmark_allocators.h"
+#include "cbenchmark/private/c_benchmark_array.h"
+
+namespace BenchMark
+{
+    class BenchMarkRun;
+    struct BenchmarkName;
+
+    // A/B comparison (see BM_COMPARE), 'baseline' and 'candidate' hold the time per iteration of every repetition
+    // of two instances that were run interleaved, repetition i of both ran back-to-back and forms a pair.
+    // The ratio candidate/baseline is the geometric mean of the ratios of the pairs, its 95% confidence interval
+    // follows from Student's t on the log ratios. The difference is significant when the interval excludes 1.
+    // Nothing is added when there are no pairs.
+    void ComputeComparison(Allocator* alloc, BenchmarkName const& name, double const* baseline, s32 baseline_size, double const* candidate, s32 candidate_size, Array<BenchMarkRun*>& comparison);
+
+} // namespace BenchMark
+
+#endif // __CBENCHMARK_BENCHMARK_COMPARE_H__
@@ -127,6 +127,12 @@ namespace BenchMark
             O_N_Cubed,
             O_N_Log_N,
             O_Exponential,
+            O_Sqrt_N,
+            O_N_Power,   // N^k, k is fitted
+            O_N_M,       // The two-variable models, see BenchMarkState::SetComplexityN(n, m)
+            O_N_Log_M,
+            O_N_Plus_M,
+            O_N_M_Power, // N^a * M^b, a and b are fitted
             O_Lambda,
             O_Auto,
             O_None
@@ -148,11 +154,18 @@ namespace BenchMark
                 case BigO::O_N_Cubed: return "O(N^3)";
                 case BigO::O_N_Log_N: return "O(NlogN)";
                 case BigO::O_Exponential: return "O(2^N)";
+                case BigO::O_Sqrt_N: return "O(sqrtN)";
+                case BigO::O_N_Power: return "O(N^k)";
+                case BigO::O_N_M: return "O(NM)";
+                case BigO::O_N_Log_M: return "O(NlogM)";
+                case BigO::O_N_Plus_M: return "O(N+M)";
+                case BigO::O_N_M_Power: return "O(N^a*M^b)";
             }
             return "O(?)";
         }
 
         inline bool Is(EEnum e) const { return bigo == e; }
+        inline bool IsTwoVariable() const { return bigo >= O_N_M && bigo <= O_N_M_Power; }
 
         typedef double(Func)(IterationCount);
 
@@ -226,6 +239,75 @@ namespace BenchMark
 
         u32 type;
     };
+
+    // Placement of the per-thread arenas (see BM_MEMORY_REQUIRED) on the NUMA nodes of the machine
+    struct NumaPolicy
+    {
+        enum
+        {
+            Default     = 0, // The arenas are allocated by the thread that starts the benchmark
+            Local       = 1, // Every thread allocates and first-touches its own arena, so it is on the node of that thread
+            Interleaved = 2, // The pages of every arena are interleaved over all nodes
+            Node        = 3, // All arenas are on one explicit node
+        };
+    };
+
+    // The pages backing the per-thread arenas (see BM_MEMORY_REQUIRED), when the requested pages are
+    // not available this falls back to the next smaller ones (Huge1G -> Huge2M -> Transparent -> Default).
+    struct Pages
+    {
+        enum
+        {
+            Default     = 0, // The arenas come from the main allocator
+            Transparent = 1, // Ask for transparent huge pages (madvise), the kernel may or may not give them
+            Huge2M      = 2, // Explicit 2 MiB huge pages (hugetlbfs, large pages on Windows)
+            Huge1G      = 3, // Explicit 1 GiB huge pages (hugetlbfs)
+        };
+    };
+
+    // The state of the caches at the start of every run of a benchmark
+    struct Cache
+    {
+        enum
+        {
+            Default = 0, // Whatever the previous run (or the runner) left behind
+            Warm    = 1, // Every thread reads its arena and the shared data, so they are cached as far as they fit
+            Flush   = 2, // The arenas and the shared data are flushed and the last level cache is swept
+            Cold    = 3, // Like Flush but also between batches of BM_ITERATE (timer stopped), reports the cold and warm time, single threaded only
+        };
+    };
+
+    // The thread counts of a unit derived from the cores the process can run on (see BM_THREAD_SWEEP), the
+    // steps and the limit can be combined, e.g. ThreadSweep::Linear(4) | ThreadSweep::PhysicalCores.
+    // The sweep always starts at 1 thread and ends at the limit.
+    struct ThreadSweep
+    {
+        enum
+        {
+            None          = 0,
+            Powers2       = 1 << 0, // 1, 2, 4, 8, ... (the default step)
+            LinearSteps   = 1 << 1, // 1, step, 2 * step, 3 * step, ... (see Linear)
+            AllLogical    = 1 << 2, // Up to all the hardware threads (the default limit)
+            PhysicalCores = 1 << 3, // Up to one thread per physical core
+            StepShift     = 16,
+        };
+
+        static inline s32 Linear(s32 step) { return LinearSteps | ((step > 0 ? step : 1) << StepShift); }
+    };
+
+    // How BM_ITERATE starts the operations of a unit (see BM_ARRIVAL). A closed loop starts an operation when
+    // the previous one is done, an open loop starts them on a timeline at the arrival rate of the instance
+    // (see BM_ARRIVAL_RATES) whether or not the previous one is done. The latency of an operation is measured
+    // from the time it should have started, so queueing delay is not hidden (coordinated omission).
+    struct Arrival
+    {
+        enum
+        {
+            Closed   = 0,
+            Constant = 1, // The operations start at fixed intervals
+            Poisson  = 2, // The intervals are exponentially distributed (a Poisson process)
+        };
+    };
 } // namespace BenchMark
 
 #endif //__CBENCHMARK_BENCHMARK_ENUMS_H__
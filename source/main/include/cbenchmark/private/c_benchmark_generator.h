@@ -0,0 +1,79 @@
+#ifndef __CBENCHMARK_BENCHMARK_GENERATOR_H__
+#define __CBENCHMARK_BENCHMARK_GENERATOR_H__
+
+#include "cbenchmark/private/c_types.h"
+#include "cbenchmark/private/c_benchmark_allocators.h"
+
+namespace BenchMark
+{
+    // Deterministic generator of benchmark inputs, the same seed gives the same data on
+    // every run and every machine. Use state.Seed() to get the seed of the running unit
+    // (see BM_SEED), by default this is 'benchmark_random_interleaving_seed'.
+    //
+    // The generator runs a number of independent xorshift128+ streams side by side (lanes),
+    // the loops over the lanes only use shift/xor/add/mul and are vectorized by the compiler
+    // (SSE2/AVX2 and NEON). Uniform, sorted and few-unique keys and strings are generated at
+    // GB/s rates, Zipfian keys are an (alias) table lookup per key.
+    //
+    // Intended usage:
+    //   Generator gen(state.Seed());
+    //   u32* keys = allocator->Alloc<u32>(sizeof(u32) * state.Range(0));
+    //   gen.Zipfian(allocator, keys, state.Range(0), 1000, 0.99);
+    class Generator
+    {
+    public:
+        enum
+        {
+            Lanes = 8,
+        };
+
+        explicit Generator(u64 seed);
+
+        // Raw random values
+        void Random(u64* values, s64 count);
+        void Random(u32* values, s64 count);
+
+        // Keys uniformly distributed in [lo, hi]
+        void Uniform(u32* keys, s64 count, u32 lo, u32 hi);
+
+        // Keys in [0, n) where key k has a probability proportional to 1 / (k + 1)^s, key 0 is the
+        // most frequent. 'allocator' is used for a temporary table (about 1 MB at most).
+        // NOTE: Keys beyond the first 65536 come from a continuous approximation and cost a pow() each.
+        void Zipfian(Allocator* allocator, u32* keys, s64 count, u32 n, double s);
+
+        // Keys in [lo, hi] in ascending order (duplicates are possible)
+        void Sorted(u32* keys, s64 count, u32 lo, u32 hi);
+
+        // Keys in [lo, hi] in descending order (duplicates are possible)
+        void ReverseSorted(u32* keys, s64 count, u32 lo, u32 hi);
+
+        // Keys that only take 'unique' different values, the values themselves are uniform in [lo, hi].
+        // 'allocator' is used for a temporary table of 'unique' entries.
+        void FewUnique(Allocator* allocator, u32* keys, s64 count, u32 unique, u32 lo, u32 hi);
+
+        // Zero terminated strings of lowercase letters laid out back-to-back in 'buffer', the length of
+        // each string is uniform in [min_length, max_length]. Writes as many strings as fit into 'size'
+        // bytes and returns the number of strings written.
+        s64 Strings(char* buffer, s64 size, s32 min_length, s32 max_length);
+
+        // A random permutation that forms a single cycle, starting at any index and following
+        // 'next[index]' visits all 'count' entries before returning to the start. This defeats
+        // hardware prefetchers and is the input for pointer-chasing (latency) benchmarks.
+        // NOTE: This one is sequential and dominated by cache misses for large counts.
+        void PointerChase(u32* next, s64 count);
+
+    private:
+        void Load(u64* s0, u64* s1) const;
+        void Store(u64 const* s0, u64 const* s1);
+        void NextBlock(u64* values);
+        u32  Next32();
+
+        u64 s0_[Lanes];
+        u64 s1_[Lanes];
+        u64 block_[Lanes];
+        s32 cursor_; // Next unused 32-bit value in block_
+    };
+
+} // namespace BenchMark
+
+#endif // __CBENCHMARK_BENCHMARK_GENERATOR_H__
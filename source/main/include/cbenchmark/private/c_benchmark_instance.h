@@ -8,6 +8,7 @@
 #include "cbenchmark/private/c_benchmark_name.h"
 #include "cbenchmark/private/c_benchmark_unit.h"
 #include "cbenchmark/private/c_benchmark_statistics.h"
+#include "cbenchmark/private/c_benchmark_openloop.h"
 
 namespace BenchMark
 {
@@ -18,18 +19,52 @@ namespace BenchMark
     class ThreadManager;
     class PerfCountersMeasurement;
 
+    // Run benchmarks in a forked child process, a crash of a benchmark is then reported as a
+    // skipped-with-error run instead of taking down the whole suite.
+    struct BenchMarkIsolation
+    {
+        enum
+        {
+            None     = 0, // Run everything in this process
+            Unit     = 1, // Run all instances of a unit in one child process
+            Instance = 2, // Run every instance in its own child process (disables random interleaving)
+        };
+    };
+
+    // The suites that come with the library, they only run when asked for (see --builtin=).
+    struct BuiltinSuite
+    {
+        enum
+        {
+            None        = 0,
+            Memory      = 1 << 0, // Memory hierarchy, latency over the working set size and bandwidth (STREAM)
+            Concurrency = 1 << 1, // Atomics, locks and queues under contention
+        };
+    };
+
     class BenchMarkGlobals
     {
     public:
         BenchMarkGlobals();
 
-        double benchmark_min_time;
-        double benchmark_min_warmup_time;
-        bool   benchmark_report_aggregates_only;
-        bool   benchmark_display_aggregates_only;
-        s32    benchmark_repetitions;
-        bool   benchmark_enable_random_interleaving;
-        u64    benchmark_random_interleaving_seed;
+        double      benchmark_min_time;
+        double      benchmark_min_warmup_time;
+        bool        benchmark_report_aggregates_only;
+        bool        benchmark_display_aggregates_only;
+        s32         benchmark_repetitions;
+        bool        benchmark_enable_random_interleaving;
+        u64         benchmark_random_interleaving_seed;
+        bool        benchmark_global_interleaving; // Random interleaving over all the units of all suites, not per unit
+        s64         benchmark_interleaving_memory; // Global interleaving, what the runners of the units interleaved together may hold
+        const char* benchmark_cache_file;          // Result cache, instances with a fresh result in this file are not run again (nullptr = no cache)
+        double      benchmark_cache_max_age;       // Result cache, a result older than this (seconds) is not used
+        const char* benchmark_checkpoint_file;     // Every repetition that completes is written to this file (nullptr = no checkpoint)
+        bool        benchmark_resume;              // Continue the session of the checkpoint file, the repetitions in it do not run again
+        s32         benchmark_isolation;           // See BenchMarkIsolation
+        s32         benchmark_shard_index;         // Only run the instances of this shard (by a hash of their full name)
+        s32         benchmark_shard_count;         // Number of shards, 1 runs all instances
+        s32         benchmark_shard_workers;       // When > 1, run every shard in its own worker process pinned to its own cores
+        u32         benchmark_builtin_suites;      // The built-in suites to run (see BuiltinSuite)
     };
 
     static BenchMarkGlobals g_benchmark_globals;
@@ -42,17 +77,23 @@ namespace BenchMark
         void Initialize(Allocator* alloc, BenchMarkInstance const* instance);
         void Shutdown();
 
-        Allocator*     allocator;
-        IterationCount iterations;
-        double         real_time_used;
-        double         cpu_time_used;
-        double         manual_time_used;
-        s64            complexity_n;
-        Counters       counters;
-        Skipped        skipped_;
-        const char*    report_format_;
-        double         report_value_;
-        const char*    skip_message_;
+        Allocator*       allocator;
+        IterationCount   iterations;
+        double           real_time_used;
+        double           cpu_time_used;
+        double           manual_time_used;
+        s64              complexity_n;
+        s64              complexity_m;
+        double           cold_time_used;  // Cache::Cold, real time of the first iteration of every batch
+        IterationCount   cold_iterations; //
+        double           warm_time_used;  // Cache::Cold, real time of the other iterations of every batch
+        IterationCount   warm_iterations; //
+        Counters         counters;
+        LatencyHistogram latency; // Open loop or asynchronous, the latency of every operation (see BM_ARRIVAL, BM_INFLIGHT)
+        Skipped          skipped_;
+        const char*      report_format_;
+        double           report_value_;
+        const char*      skip_message_;
 
         void Merge(const BenchMarkRunResult& other);
     };
@@ -63,14 +104,17 @@ namespace BenchMark
     public:
         BenchMarkInstance();
 
-        void initialize(ForwardAllocator* allocator, BenchMarkUnit* benchmark, Array<s32> const& args, int thread_count);
+        void initialize(ForwardAllocator* allocator, BenchMarkUnit* benchmark, Array<s64> const& args, int thread_count, double arrival_rate, s32 inflight, void const* suite_data, void const* fixture_data);
         void release(ForwardAllocator* allocator);
 
         void run(BenchMarkState& state, Allocator* allocator) const;
 
         const BenchmarkName& name() const { return name_; }
-        Array<s32> const*    args() const { return &args_; }
+        Array<s64> const*    args() const { return &args_; }
+        char const* const*   arg_names() const { return arg_names_; }
         int                  threads() const { return threads_; }
+        double               arrival_rate() const { return arrival_rate_; }
+        s32                  inflight() const { return inflight_; }
 
         AggregationReportMode   aggregation_report_mode() const { return benchmark_->aggregation_report_mode_; }
         TimeUnit                time_unit() const { return benchmark_->time_unit_; }
@@ -85,15 +129,30 @@ namespace BenchMark
         double                  min_time() const { return benchmark_->min_time_; }
         double                  min_warmup_time() const { return benchmark_->min_warmup_time_; }
         s64                     memory_required() const { return benchmark_->memory_required_; }
+        s64                     shared_memory_required() const { return benchmark_->shared_memory_required_; }
+        u64                     seed() const { return benchmark_->seed_; }
+        s32                     numa_policy() const { return benchmark_->numa_policy_; }
+        s32                     numa_node() const { return benchmark_->numa_node_; }
+        s32                     pages() const { return benchmark_->pages_; }
+        s32                     cache() const { return benchmark_->cache_; }
+        s32                     arrival() const { return (arrival_rate_ > 0.0 && benchmark_->arrival_ == Arrival::Closed) ? (s32)Arrival::Constant : benchmark_->arrival_; }
         IterationCount          iterations() const { return benchmark_->iterations_; }
         setup_function          setup() const { return benchmark_->setup_; }
         teardown_function       teardown() const { return benchmark_->teardown_; }
+        void const*             code() const { return (void const*)benchmark_->run_; } // The benchmark function (see ResultCache)
+        void const*             suite_data() const { return suite_data_; }
+        void const*             fixture_data() const { return fixture_data_; }
 
     private:
         BenchMarkUnit* benchmark_;
         BenchmarkName  name_;
-        Array<s32>     args_;
-        int            threads_; // Number of concurrent threads to us
+        Array<s64>     args_;
+        char const*    arg_names_[BenchMarkUnit::Max_Args]; // Name of every arg (or nullptr), indexed like args_
+        int            threads_;      // Number of concurrent threads to us
+        double         arrival_rate_; // Open loop, operations per second of all threads together (0 = closed loop)
+        s32            inflight_;     // Asynchronous, operations kept in flight per thread (0 = synchronous)
+        void const*    suite_data_;   // Data built by the suite setup
+        void const*    fixture_data_; // Data built by the fixture setup
     };
 
 } // namespace BenchMark
@@ -0,0 +1,41 @@
+#ifndef __CBENCHMARK_BENCHMARK_KERNELS_H__
+#define __CBENCHMARK_BENCHMARK_KERNELS_H__
+
+#include "cbenchmark/private/c_types.h"
+#include "cbenchmark/private/c_benchmark_allocators.h"
+
+namespace BenchMark
+{
+    // The kernels of the statistics over (large) arrays of samples. There is a scalar version of every kernel and
+    // SIMD versions (AVX2, AVX-512 and NEON), the best one the CPU supports is picked at runtime.
+    // NOTE: The SIMD sums add in a different order than the scalar ones, the results can differ in the last bits.
+    struct StatisticsKernels
+    {
+        const char* name;
+
+        double (*sum)(double const* data, s64 count);
+        double (*sum_squares)(double const* data, s64 count);
+
+        // A NaN is skipped, only NaNs give +infinity and -infinity and no values give 0 and 0
+        void (*min_max)(double const* data, s64 count, double& min, double& max);
+
+        // Adds every value to one of 'num_buckets' linear buckets, the bucket is (value - lo) * scale clamped to
+        // [0, num_buckets - 1]
+        void (*histogram)(double const* data, s64 count, double lo, double scale, u64* counts, s32 num_buckets);
+    };
+
+    // The kernels for this CPU, determined on first use
+    StatisticsKernels const& gStatisticsKernels();
+
+    // The scalar kernels, the reference for the SIMD ones
+    StatisticsKernels const& gScalarStatisticsKernels();
+
+    // The k-th smallest (0 based) of 'count' values. A large array is narrowed down with histograms (min/max and
+    // bucketing kernels) to the values in the bucket of the k-th, a small one is copied and partially sorted (and so is
+    // one with a NaN or an infinity, the buckets cannot narrow those down).
+    // The values of a bucket are copied to 'allocator', if it cannot hold them the middle of the bucket is returned.
+    double gStatisticsSelect(Allocator* allocator, StatisticsKernels const& kernels, double const* data, s64 count, s64 k);
+
+} // namespace BenchMark
+
+#endif // __CBENCHMARK_BENCHMARK_KERNELS_H__
@@ -0,0 +1,92 @@
+#ifndef __CBENCHMARK_BENCHMARK_OPENLOOP_H__
+#define __CBENCHMARK_BENCHMARK_OPENLOOP_H__
+
+#include "cbenchmark/private/c_types.h"
+#include "cbenchmark/private/c_benchmark_allocators.h"
+#include "cbenchmark/private/c_benchmark_generator.h"
+
+namespace BenchMark
+{
+    // Latencies in nanoseconds in log-linear buckets (like HdrHistogram), every power of two is split
+    // into 32 linear sub-buckets so a recorded value is off by at most 1/32. Values up to 2^40 ns (about
+    // 18 minutes) have their own bucket, larger ones end up in the last bucket.
+    struct LatencyHistogram
+    {
+        enum
+        {
+            SubBits    = 5,
+            SubBuckets = 1 << SubBits,
+            MaxBits    = 40,
+            Buckets    = (MaxBits - SubBits + 2) * SubBuckets,
+        };
+
+        LatencyHistogram()
+            : allocator(nullptr)
+            , counts(nullptr)
+            , count(0)
+            , max(0)
+        {
+        }
+
+        void Initialize(Allocator* alloc);
+        void Release();
+        void Reset();
+        void Merge(LatencyHistogram const& other);
+
+        inline void Record(u64 ns)
+        {
+            if (counts == nullptr)
+                return;
+            counts[IndexOf(ns)] += 1;
+            count += 1;
+            if (ns > max)
+                max = ns;
+        }
+
+        // The latency (seconds) below which a fraction 'p' of the recorded latencies are, 0 if nothing was recorded
+        double Percentile(double p) const;
+
+        static s32 IndexOf(u64 ns);
+        static u64 ValueOf(s32 index); // The middle of the bucket
+
+        Allocator* allocator;
+        u64*       counts;
+        u64        count;
+        u64        max;
+    };
+
+    // The intended start times (seconds, relative to the start of the run) of the operations of one thread
+    // in an open loop (see BM_ARRIVAL). They are precomputed a block at a time so the timed loop only has
+    // to read them, a refill happens once every BlockSize operations.
+    struct ArrivalTimeline
+    {
+        enum
+        {
+            BlockSize = 256,
+        };
+
+        // 'interval' is the mean time between two operations of this thread, 'phase' the start of the
+        // first one (Arrival::Constant spreads the threads over one interval).
+        ArrivalTimeline(s32 arrival, double interval, double phase, u64 seed);
+
+        inline double Next()
+        {
+            if (cursor_ == BlockSize)
+                Refill();
+            return times_[cursor_++];
+        }
+
+    private:
+        void Refill();
+
+        Generator gen_;
+        s32       arrival_;
+        double    interval_;
+        double    last_;
+        s32       cursor_;
+        double    times_[BlockSize];
+    };
+
+} // namespace BenchMark
+
+#endif // __CBENCHMARK_BENCHMARK_OPENLOOP_H__
@@ -14,7 +14,7 @@ namespace BenchMark
     public:
         struct Context
         {
-            Context() : name_field_width(0), executable_name(nullptr) {}
+            Context() : name_field_width(0), executable_name(nullptr), continue_table(false) {}
 
             // CPUInfo const&    cpu_info;
             // SystemInfo const& sys_info;
@@ -22,6 +22,9 @@ namespace BenchMark
             // The number of chars in the longest benchmark name.
             s32                name_field_width;
             const char*         executable_name;
+
+            // The runs continue the table of the previous unit, they are instantiations of the same BM_UNIT_TEMPLATE
+            bool continue_table;
         };
 
         struct PerFamilyRunReports
@@ -48,6 +51,10 @@ namespace BenchMark
         // to skip runs based on the context information.
         virtual bool ReportBegin(const Context& context, ForwardAllocator* allocator, ScratchAllocator* scratch) = 0;
 
+        // Called once after the setup of a suite or fixture has run, 'seconds' is the (real) time
+        // the setup took. This time is not part of any of the benchmark runs.
+        virtual void ReportSetup(const char* name, double seconds, ForwardAllocator* allocator, ScratchAllocator* scratch) = 0;
+
         // Called once for each group of benchmark runs, gives information about the configurations of the runs.
         virtual void ReportRunsConfig(double min_time, bool has_explicit_iters, IterationCount iters, ForwardAllocator* allocator, ScratchAllocator* scratch) = 0;
 
@@ -33,6 +33,7 @@ namespace BenchMark
         void Shutdown(Allocator* allocator);
 
         virtual bool ReportBegin(const Context& context, ForwardAllocator* allocator, ScratchAllocator* scratch);
+        virtual void ReportSetup(const char* name, double seconds, ForwardAllocator* allocator, ScratchAllocator* scratch);
         virtual void ReportRuns(Array<BenchMarkRun*> const& reports, ForwardAllocator* allocator, ScratchAllocator* scratch);
         virtual void ReportRunsConfig(double min_time, bool has_explicit_iters, IterationCount iters, ForwardAllocator* allocator, ScratchAllocator* scratch);
         virtual void ReportEnd(ForwardAllocator* allocator);
@@ -24,16 +24,37 @@ namespace BenchMark
 #define BM_THREAD_COUNTS(...)             \
     const s32 tcvector[] = {__VA_ARGS__}; \
     settings->SetThreadCounts(tcvector, (s32)(sizeof(tcvector) / sizeof(tcvector[0])))
+#define BM_THREAD_SWEEP settings->SetThreadSweep
+
+#define BM_ARRIVAL_RATES(...)                \
+    const double arvector[] = {__VA_ARGS__}; \
+    settings->SetArrivalRates(arvector, (s32)(sizeof(arvector) / sizeof(arvector[0])))
+#define BM_ARRIVAL_SWEEP settings->SetArrivalSweep
+#define BM_ARRIVAL settings->SetArrival
+
+#define BM_COMPARE settings->SetCompare
+
+#define BM_INFLIGHT(...)                  \
+    const s32 ifvector[] = {__VA_ARGS__}; \
+    settings->SetInFlight(ifvector, (s32)(sizeof(ifvector) / sizeof(ifvector[0])))
 
 #define BM_COUNTER settings->AddCounter
 #define BM_TIMEUNIT settings->SetTimeUnit
 #define BM_MINTIME settings->SetMinTime
 #define BM_MEMORY_REQUIRED settings->SetMemoryRequired
+#define BM_SHARED_MEMORY_REQUIRED settings->SetSharedMemoryRequired
+#define BM_SEED settings->SetSeed
+#define BM_NUMA settings->SetNuma
+#define BM_PAGES settings->SetPages
+#define BM_CACHE settings->SetCache
 #define BM_MINWARMUPTIME settings->SetMinWarmupTime
 #define BM_ITERATIONS settings->SetIterations
 #define BM_REPETITIONS settings->SetRepetitions
+#define BM_COMPLEXITY settings->SetComplexity
 
 #define BM_ITERATE BenchMarkState::Iterator iter(&state); while (iter.Next())
+#define BM_ITERATE_BATCHED(input, input_size, prepare) BenchMarkState::BatchIterator iter(&state, input_size, prepare); while (u8* input = iter.Next())
+#define BM_ITERATE_ASYNC(op, poll) BenchMarkState::AsyncIterator iter(&state); for (BenchMarkState::AsyncOp op; iter.Next(op);) if (!op) { poll; } else
 
     class BenchMarkFixture
     {
@@ -46,16 +67,16 @@ namespace BenchMark
                 tail->next = bmu;
             tail = bmu;
         }
-        BenchMarkUnit*    head;
-        BenchMarkUnit*    tail;
-        BenchMarkFixture* next;
-        settings_function settings;
-        setup_function    setup;
-        teardown_function teardown;
-        const char*       name;
-        const char*       filename;
-        int               disabled;
-        int               lineNumber;
+        BenchMarkUnit*           head;
+        BenchMarkUnit*           tail;
+        BenchMarkFixture*        next;
+        settings_function        settings;
+        shared_setup_function    setup;
+        shared_teardown_function teardown;
+        const char*              name;
+        const char*              filename;
+        int                      disabled;
+        int                      lineNumber;
     };
 
     class BenchMarkSuite
@@ -69,16 +90,16 @@ namespace BenchMark
                 tail->next = bm;
             tail = bm;
         }
-        BenchMarkFixture* head;
-        BenchMarkFixture* tail;
-        BenchMarkSuite*   next;
-        settings_function settings;
-        setup_function    setup;
-        teardown_function teardown;
-        const char*       name;
-        const char*       filename;
-        int               disabled;
-        int               lineNumber;
+        BenchMarkFixture*        head;
+        BenchMarkFixture*        tail;
+        BenchMarkSuite*          next;
+        settings_function        settings;
+        shared_setup_function    setup;
+        shared_teardown_function teardown;
+        const char*              name;
+        const char*              filename;
+        int                      disabled;
+        int                      lineNumber;
     };
 
 #define BM_UNIT(bmname)                                                                      \
@@ -108,6 +129,59 @@ namespace BenchMark
     }                                                                                        \
     void BM_Run_##bmname(BenchMarkState& state, Allocator* allocator)
 
+// A unit per type of the list, the body is a template on 'T'. The instantiations are named "bmname<Type>",
+// BM_SETTINGS(bmname) and BM_UNIT_DISABLE(bmname) apply to all of them.
+//
+// Intended usage:
+//   BM_UNIT_TEMPLATE(insert, Map, StdMap, HashMap, FlatMap)
+//   {
+//       Map map;
+//       ...
+//   }
+#define BM_UNIT_TEMPLATE(bmname, T, ...)                                                                          \
+    template <typename T> void BM_Run_##bmname(BenchMarkState& state, Allocator* allocator);                      \
+    namespace nsBMU##bmname                                                                                       \
+    {                                                                                                             \
+        BenchMarkUnit __unit;                                                                                     \
+        template <typename... Types> class BMRegisterUnits                                                        \
+        {                                                                                                         \
+            enum                                                                                                  \
+            {                                                                                                     \
+                Count    = sizeof...(Types),                                                                      \
+                NameSize = 128,                                                                                   \
+            };                                                                                                    \
+            BenchMarkUnit units_[Count];                                                                          \
+            char          names_[Count][NameSize];                                                                \
+                                                                                                                  \
+        public:                                                                                                   \
+            inline BMRegisterUnits(const char* _name, const char* _types, const char* _filename, int _lineNumber) \
+            {                                                                                                     \
+                if (__unit.settings_ == nullptr)                                                                  \
+                    __unit.settings_ = BMSettings_Nil;                                                            \
+                __unit.name                   = _name;                                                            \
+                __unit.filename               = _filename;                                                        \
+                __unit.lineNumber             = _lineNumber;                                                      \
+                const run_function runs[Count] = {BM_Run_##bmname<Types>...};                                     \
+                for (s32 i = 0; i < Count; ++i)                                                                   \
+                {                                                                                                 \
+                    gTemplateUnitName(names_[i], NameSize, _name, _types, i);                                     \
+                    units_[i].setup_      = BMSetup_Nil;                                                          \
+                    units_[i].teardown_   = BMTeardown_Nil;                                                       \
+                    units_[i].settings_   = BMSettings_Family;                                                    \
+                    units_[i].run_        = runs[i];                                                              \
+                    units_[i].family      = &__unit;                                                              \
+                    units_[i].name        = names_[i];                                                            \
+                    units_[i].filename    = _filename;                                                            \
+                    units_[i].lineNumber  = _lineNumber;                                                          \
+                    __fixture.AddUnit(&units_[i]);                                                                \
+                }                                                                                                 \
+            }                                                                                                     \
+            static void BMSettings_Family(BenchMarkUnit* settings) { __unit.settings_(settings); }                \
+        };                                                                                                        \
+        BMRegisterUnits<__VA_ARGS__> __register(#bmname, #__VA_ARGS__, __FILE__, __LINE__ + 2);                   \
+    }                                                                                                             \
+    template <typename T> void BM_Run_##bmname(BenchMarkState& state, Allocator* allocator)
+
 #define BM_UNIT_DISABLE(name)                                                    \
     namespace nsBMU##name { extern BenchMarkUnit __unit; }                       \
     class SetBMUnitDisable##name                                                 \
@@ -139,10 +213,6 @@ namespace BenchMark
         public:                                                                                 \
             inline BMRegisterFixture(const char* _name, const char* _filename, int _lineNumber) \
             {                                                                                   \
-                if (__fixture.setup == nullptr)                                                 \
-                    __fixture.setup = BMSetup_Nil;                                              \
-                if (__fixture.teardown == nullptr)                                              \
-                    __fixture.teardown = BMTeardown_Nil;                                        \
                 if (__fixture.settings == nullptr)                                              \
                     __fixture.settings = BMSettings_Nil;                                        \
                 __fixture.name       = _name;                                                   \
@@ -163,23 +233,28 @@ namespace BenchMark
         inline SetBMFixtureDisable##name() { nsBMF##name::__fixture.disabled = true; } \
     }
 
+// Runs once after the last unit of the fixture, 'data' is what BM_FIXTURE_SETUP has set
 #define BM_FIXTURE_TEARDOWN                                                       \
-    void BMFixtureTeardown(const BenchMarkState&);                                \
+    void BMFixtureTeardown(Allocator* allocator, void* data);                     \
     class SetBMFixtureTeardown                                                    \
     {                                                                             \
     public:                                                                       \
         inline SetBMFixtureTeardown() { __fixture.teardown = BMFixtureTeardown; } \
     };                                                                            \
-    void BMFixtureTeardown(const BenchMarkState&)
+    SetBMFixtureTeardown gSetBMFixtureTeardown;                                   \
+    void                 BMFixtureTeardown(Allocator* allocator, void* data)
 
+// Runs once before the first unit of the fixture, set 'data' to what the units can
+// access through state.FixtureData<T>().
 #define BM_FIXTURE_SETUP                                                 \
-    void BMFixtureSetup(const BenchMarkState&);                          \
+    void BMFixtureSetup(Allocator* allocator, void*& data);              \
     class SetBMFixtureSetup                                              \
     {                                                                    \
     public:                                                              \
         inline SetBMFixtureSetup() { __fixture.setup = BMFixtureSetup; } \
     };                                                                   \
-    void BMFixtureSetup(const BenchMarkState&)
+    SetBMFixtureSetup gSetBMFixtureSetup;                                \
+    void              BMFixtureSetup(Allocator* allocator, void*& data)
 
 #define BM_FIXTURE_SETTINGS                                                       \
     void BMFixtureSettings(BenchMarkUnit* settings);                              \
@@ -204,10 +279,6 @@ namespace BenchMark
         public:                                                                           \
             inline BMSRegister(const char* _name, const char* _filename, int _lineNumber) \
             {                                                                             \
-                if (__suite.setup == nullptr)                                             \
-                    __suite.setup = BMSetup_Nil;                                          \
-                if (__suite.teardown == nullptr)                                          \
-                    __suite.teardown = BMTeardown_Nil;                                    \
                 if (__suite.settings == nullptr)                                          \
                     __suite.settings = BMSettings_Nil;                                    \
                 __suite.name       = _name;                                               \
@@ -228,23 +299,28 @@ namespace BenchMark
         inline SetBMSuiteDisable##name() { nsBMS##name::__suite.disabled = true; } \
     }
 
+// Runs once after the last fixture of the suite, 'data' is what BM_SUITE_SETUP has set
 #define BM_SUITE_TEARDOWN                                                   \
-    void BMSuiteTeardown(const BenchMarkState&);                            \
+    void BMSuiteTeardown(Allocator* allocator, void* data);                 \
     class SetBMSuiteTeardown                                                \
     {                                                                       \
     public:                                                                 \
         inline SetBMSuiteTeardown() { __suite.teardown = BMSuiteTeardown; } \
     };                                                                      \
-    void BMSuiteTeardown(const BenchMarkState&)
+    SetBMSuiteTeardown gSetBMSuiteTeardown;                                 \
+    void               BMSuiteTeardown(Allocator* allocator, void* data)
 
+// Runs once before the first fixture of the suite, set 'data' to what the units can
+// access through state.SuiteData<T>().
 #define BM_SUITE_SETUP                                             \
-    void BMSuiteSetup(const BenchMarkState&);                      \
+    void BMSuiteSetup(Allocator* allocator, void*& data);          \
     class SetBMSuiteSetup                                          \
     {                                                              \
     public:                                                        \
         inline SetBMSuiteSetup() { __suite.setup = BMSuiteSetup; } \
     };                                                             \
-    void BMSuiteSetup(const BenchMarkState&)
+    SetBMSuiteSetup gSetBMSuiteSetup;                              \
+    void            BMSuiteSetup(Allocator* allocator, void*& data)
 
 #define BM_SUITE_SETTINGS                                                   \
     void BMSuiteSettings(BenchMarkUnit* settings);                          \
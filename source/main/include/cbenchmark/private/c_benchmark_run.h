@@ -42,11 +42,30 @@ namespace BenchMark
             , complexity(BigO::O_None)
             , complexity_lambda(nullptr)
             , complexity_n(0)
+            , complexity_m(0)
             , statistics()
             , report_big_o(false)
             , report_rms(false)
+            , report_scaling(false)
+            , report_curve(false)
+            , report_compare(false)
+            , cached(false)
             , counters()
             , allocs_per_iter(0.0)
+            , numa_nodes()
+            , page_size(0)
+            , cold_accumulated_time(0)
+            , cold_iterations(0)
+            , warm_accumulated_time(0)
+            , warm_iterations(0)
+            , arrival_rate(0.0)
+            , latency_p50(0.0)
+            , latency_p90(0.0)
+            , latency_p99(0.0)
+            , latency_p999(0.0)
+            , latency_max(0.0)
+            , inflight(0)
+            , strings()
         {
         }
 
@@ -71,15 +90,42 @@ namespace BenchMark
             complexity = BigO::O_None;
             complexity_lambda = nullptr;
             complexity_n = 0;
+            complexity_m = 0;
             statistics.Release();
             report_big_o = false;
             report_rms = false;
+            report_scaling = false;
+            report_curve = false;
+            report_compare = false;
+            cached = false;
             counters.Release();
             allocs_per_iter = 0.0;
+            numa_nodes.Release();
+            page_size = 0;
+            cold_accumulated_time = 0;
+            cold_iterations = 0;
+            warm_accumulated_time = 0;
+            warm_iterations = 0;
+            arrival_rate = 0.0;
+            latency_p50 = 0.0;
+            latency_p90 = 0.0;
+            latency_p99 = 0.0;
+            latency_p999 = 0.0;
+            latency_max = 0.0;
+            inflight = 0;
+            strings.Release();
         }
 
         const char* BenchMarkName(Allocator* alloc);
 
+        // Binary encoding of the results of a run with its strings by value, used to send a run from a child process
+        // to the parent (see SendRepetition) and for a run that outlives the process that ran it (see ResultCache and
+        // Checkpoint). 'run_name', 'statistics' and 'complexity_lambda' are not written, the receiver takes them from
+        // the instance. Restore returns the end of the run in 'src', nullptr on error.
+        s64       PersistedSize() const;
+        u8*       Persist(u8* dst, u8 const* dstEnd) const;
+        u8 const* Restore(Allocator* alloc, u8 const* src, u8 const* srcEnd);
+
         BenchmarkName run_name;
         RunType       run_type;
         const char*   aggregate_name;
@@ -116,6 +162,7 @@ namespace BenchMark
         BigO        complexity;
         BigO::Func* complexity_lambda;
         s64         complexity_n;
+        s64         complexity_m; // The second size of the two-variable models
 
         // what statistics to compute from the measurements
         Array<Statistic> statistics;
@@ -124,11 +171,54 @@ namespace BenchMark
         bool report_big_o;
         bool report_rms;
 
+        // Inform print function whether the current run is a scaling report (speedup and efficiency
+        // of a thread count instead of times, see ComputeScaling)
+        bool report_scaling;
+
+        // Inform print function whether the current run is a point of a latency curve (see BM_ARRIVAL), it only has counters
+        bool report_curve;
+
+        // Inform print function whether the current run is an A/B comparison (the ratio to the baseline and its
+        // relative difference instead of times, see ComputeComparison)
+        bool report_compare;
+
+        // The run was not measured now, it comes from the result cache (see ResultCache)
+        bool cached;
+
         Counters counters;
 
         // Memory metrics.
         // const MemoryManager::Result* memory_result;
         double allocs_per_iter;
+
+        // The NUMA node of the arena of every thread, empty unless the unit has a NUMA policy (see BM_NUMA)
+        Array<s32> numa_nodes;
+
+        // The size of the pages backing the arenas, 0 unless the unit asks for specific pages (see BM_PAGES)
+        s64 page_size;
+
+        // Cache::Cold, the (real) time of the iterations that started with evicted caches and of those
+        // that followed them in the same batch (see BM_CACHE)
+        double         cold_accumulated_time;
+        IterationCount cold_iterations;
+        double         warm_accumulated_time;
+        IterationCount warm_iterations;
+
+        // Open loop (see BM_ARRIVAL), the offered rate (operations per second) and the percentiles of the
+        // latency of the operations (seconds), measured from their intended start. 0 for a closed loop.
+        double arrival_rate;
+        double latency_p50;
+        double latency_p90;
+        double latency_p99;
+        double latency_p999;
+        double latency_max;
+
+        // Asynchronous (see BM_INFLIGHT), the operations every thread kept in flight, 0 for a synchronous unit.
+        // The latency percentiles above are then measured from the launch of every operation.
+        s64 inflight;
+
+        // The characters of the strings of a restored run (see Restore), released with the run
+        Array<char> strings;
     };
 
 } // namespace BenchMark
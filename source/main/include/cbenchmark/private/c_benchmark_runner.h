@@ -19,6 +19,7 @@ namespace BenchMark
     class PerfCountersMeasurement;
     class ThreadManager;
     class ThreadTimer;
+    struct ChildProcess;
 
     struct RunResults
     {
@@ -36,15 +37,21 @@ namespace BenchMark
     int              GetNumRepeats(const BenchMarkRunner* r);
     bool             HasRepeatsRemaining(const BenchMarkRunner* r);
     void             DoOneRepetition(BenchMarkRunner* r, ForwardAllocator* allocator, ScratchAllocator* scratch, BenchMarkRun* report, BenchMarkReporter::PerFamilyRunReports* reports_for_family);
+    void             SendRepetition(ChildProcess& child, ScratchAllocator* scratch, const BenchMarkRun* report);
+    bool             ReceiveRepetition(BenchMarkRunner* r, ChildProcess& child, ForwardAllocator* allocator, ScratchAllocator* scratch, BenchMarkRun* report, BenchMarkReporter::PerFamilyRunReports* reports_for_family);
+    void             ReplayRepetition(BenchMarkRunner* r, ForwardAllocator* allocator, BenchMarkRun* report, BenchMarkReporter::PerFamilyRunReports* reports_for_family);
     void             AggregateResults(BenchMarkRunner* r, ForwardAllocator* allocator, ScratchAllocator* scratch, const Array<BenchMarkRun*>& non_aggregates, Array<BenchMarkRun*>& aggregates_only);
     double           GetMinTime(const BenchMarkRunner* r);
     bool             HasExplicitIters(const BenchMarkRunner* r);
     IterationCount   GetIters(const BenchMarkRunner* r);
+    s64              GetMemoryHeld(const BenchMarkInstance* b); // Held by a runner until its last repetition (shared data, cache sweep buffer)
     void             StartStopBarrier(ThreadManager* tm);
     void             ThreadTimerStart(ThreadTimer* timer);
     void             ThreadTimerStop(ThreadTimer* timer);
     bool             ThreadTimerIsRunning(ThreadTimer* timer);
     void             ThreadTimerSetIterationTime(ThreadTimer* timer, double seconds);
+    double           ThreadTimerRealTimeUsed(ThreadTimer* timer);
+    double           RealTimeNow();
 
 } // namespace BenchMark
 
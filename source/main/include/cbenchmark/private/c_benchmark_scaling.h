@@ -0,0 +1,22 @@
+#ifndef __CBENCHMARK_BENCHMARK_SCALING_H__
+#define __CBENCHMARK_BENCHMARK_SCALING_H__
+
+#include "cbenchmark/private/c_benchmark_allocators.h"
+#include "cbenchmark/private/c_benchmark_array.h"
+
+namespace BenchMark
+{
+    class BenchMarkRun;
+    struct BenchmarkName;
+
+    // A family is the set of instances of a unit that only differ in their number of threads, 'names',
+    // 'threads' and 'throughput' (iterations per second of real time) hold one entry per instance of the family.
+    // A row is added for every thread count with the speedup and parallel efficiency relative to the 1-thread
+    // instance, followed by a row for the family with the serial fraction of Amdahl's law and the contention
+    // and coherency of the Universal Scalability Law fitted on the speedups of all the thread counts.
+    // Nothing is added when the family has no 1-thread instance.
+    void ComputeScaling(Allocator* alloc, ScratchAllocator* scratch, const Array<BenchmarkName const*>& names, const Array<s64>& threads, const Array<double>& throughput, Array<BenchMarkRun*>& scaling);
+
+} // namespace BenchMark
+
+#endif // __CBENCHMARK_BENCHMARK_SCALING_H__
@@ -8,13 +8,45 @@
 #include "cbenchmark/private/c_benchmark_statistics.h"
 #include "cbenchmark/private/c_benchmark_check.h"
 #include "cbenchmark/private/c_benchmark_allocators.h"
+#include "cbenchmark/private/c_benchmark_openloop.h"
 
 namespace BenchMark
 {
     class ThreadTimer;
     class ThreadManager;
+    class BenchMarkState;
     struct BenchMarkRunResult;
 
+    // Fills 'count' inputs of 'input_size' bytes, laid out back-to-back at 'inputs'.
+    // Called by the batched iterator while the timer is stopped.
+    typedef void (*batch_prepare_function)(BenchMarkState& state, u8* inputs, s64 input_size, s32 count);
+
+    // Builds the data that all threads of a benchmark instance share, 'allocator' is the
+    // dedicated arena of the instance (see BM_SHARED_MEMORY_REQUIRED).
+    typedef void (*shared_data_build_function)(BenchMarkState& state, Allocator* allocator, void*& data);
+
+    // Data shared by the threads of one benchmark instance, built once by the first thread and
+    // kept for all runs (warmup and repetitions) of the instance.
+    struct BenchMarkSharedData
+    {
+        BenchMarkSharedData()
+            : allocator(nullptr)
+            , size(0)
+            , data(nullptr)
+            , built(false)
+        {
+        }
+
+        void Initialize(Allocator* alloc, s64 arena_size);
+        void Release();
+
+        ForwardAllocator arena;     // Dedicated arena, released after the last run of the instance
+        Allocator*       allocator; // Provides the memory of the arena
+        s64              size;      // Size of the arena
+        void*            data;      // What the build function has set
+        bool             built;
+    };
+
     // BenchMarkState is passed to a running Benchmark and contains state for the benchmark to use.
     class BenchMarkState
     {
@@ -151,6 +183,15 @@ namespace BenchMark
         inline void SetComplexityN(s64 complexity_n) { complexity_n_ = complexity_n; }
         inline s64  GetComplexityLengthN() const { return complexity_n_; }
 
+        // Like SetComplexityN, for the two-variable complexity models (e.g. O(NM) or O(NlogM)) that need a
+        // second size, 'complexity_m'.
+        inline void SetComplexityN(s64 complexity_n, s64 complexity_m)
+        {
+            complexity_n_ = complexity_n;
+            complexity_m_ = complexity_m;
+        }
+        inline s64 GetComplexityLengthM() const { return complexity_m_; }
+
         // If this routine is called with items > 0, then an items/s
         // label is printed on the benchmark report line for the currently
         // executing benchmark. It is typically called at the end of a processing
@@ -173,6 +214,25 @@ namespace BenchMark
             return 0;
         }
 
+        // Set the value and the flags of a counter, e.g. SetCounter("hits", {CounterFlags::IsRate}, hits).
+        // The counter has to be reserved in the settings with BM_COUNTER(name, flags), the flags given
+        // here replace the ones given there.
+        //
+        // REQUIRES: a benchmark has exited its benchmarking loop.
+        inline void SetCounter(const char* name, CounterFlags flags, double value)
+        {
+            s32 const index = Counters::FindByName(counters_, name);
+            if (index >= 0)
+            {
+                counters_.counters[index].flags = flags;
+                counters_.counters[index].value = value;
+            }
+            else
+            {
+                counters_.counters.PushBack({name, flags, value});
+            }
+        }
+
         // If this routine is called, the specified label is printed at the
         // end of the benchmark report line for the currently executing
         // benchmark.  Example:
@@ -188,7 +248,27 @@ namespace BenchMark
         void SetLabel(const char* format, double value);
 
         // Range arguments for this run. CHECKs if the argument has been set.
-        inline s32 Range(s32 pos = 0) const { return (*range_)[pos & 0x3]; }
+        inline s64 Range(s32 pos = 0) const
+        {
+            BM_CHECK(pos >= 0 && pos < range_->Size());
+            return (*range_)[pos];
+        }
+
+        // Arguments by index (same as Range) or by the name given with BM_ARG_NAME, e.g. state.Arg("size").
+        // CHECKs if there is no argument with that name. A name is compared once, the index it resolves to is
+        // kept for the next call with the same string. Resolve several names used inside the timed loop with
+        // ArgIndex() before it.
+        inline s64 Arg(s32 pos) const { return Range(pos); }
+        inline s64 Arg(const char* name) const
+        {
+            if (name != arg_name_)
+            {
+                arg_index_ = ArgIndex(name);
+                arg_name_  = name;
+            }
+            return arg_index_ >= 0 ? (*range_)[arg_index_] : 0;
+        }
+        s32 ArgIndex(const char* name) const; // -1 if there is no argument with that name
 
         // Number of threads concurrently executing the benchmark.
         inline int Threads() const { return threads_; }
@@ -208,6 +288,23 @@ namespace BenchMark
 
         inline const char* Name() const { return name_; }
 
+        // Data built by BM_SUITE_SETUP / BM_FIXTURE_SETUP, shared by all units and threads
+        // and only to be read. Returns nullptr if the suite or fixture has no setup.
+        template <typename T> inline const T* SuiteData() const { return (const T*)suite_data_; }
+        template <typename T> inline const T* FixtureData() const { return (const T*)fixture_data_; }
+
+        // REQUIRES: called by every thread, before the benchmark loop.
+        // The first thread builds the data (timer stopped) the first time this instance runs, the other
+        // threads wait on the start barrier. All threads receive the same pointer which is only to be read.
+        //
+        // Intended usage:
+        //   const s32* table = state.SharedData<s32>(build_table);
+        template <typename T> inline const T* SharedData(shared_data_build_function build) { return (const T*)GetSharedData(build); }
+
+        // Seed for generating the inputs of this run (see Generator), this is the seed set with BM_SEED
+        // or otherwise 'benchmark_random_interleaving_seed'. Every thread gets the same seed.
+        inline u64 Seed() const { return seed_; }
+
     private:
         // items we expect on the first cache line (ie 64 bytes of the struct)
         // When total_iterations_ is 0, KeepRunning() and friends will return false.
@@ -229,33 +326,45 @@ namespace BenchMark
         Skipped skipped_;
 
         // items we don't need on the first cache line
-        Array<s32> const* range_;
-        s64               complexity_n_;
+        Array<s64> const*    range_;
+        char const* const*   arg_names_;
+        mutable char const*  arg_name_;  // The last name passed to Arg(name) and its index
+        mutable s32          arg_index_;
+        s64                  complexity_n_;
+        s64                  complexity_m_;
+        void const*          suite_data_;
+        void const*          fixture_data_;
+        BenchMarkSharedData* shared_data_;
+        u64                  seed_;
 
     public:
         BenchMarkState();
 
-        void Init(const char* name, IterationCount max_iters, Array<s32> const* range, s32 thread_index, s32 threads);
-        void InitRun(Allocator* alloc, const char* name, IterationCount max_iters, Array<s32> const* range, s32 counters, s32 thread_index, s32 threads, ThreadTimer* timer, ThreadManager* manager, BenchMarkRunResult* results);
+        void Init(const char* name, IterationCount max_iters, Array<s64> const* range, char const* const* arg_names, s32 thread_index, s32 threads);
+        void InitData(void const* suite_data, void const* fixture_data, BenchMarkSharedData* shared_data, u64 seed);
+        void InitCache(s32 cache, u8 const* sweep, s64 sweep_size);
+        void InitArrival(ArrivalTimeline* timeline);
+        void InitAsync(s32 inflight, u8* slots);
+        void InitRun(ForwardAllocator* alloc, const char* name, IterationCount max_iters, Array<s64> const* range, char const* const* arg_names, s32 counters, s32 thread_index, s32 threads, ThreadTimer* timer, ThreadManager* manager, BenchMarkRunResult* results);
         void Shutdown();
 
+        // With Cache::Cold the iterations are handed out in batches, the caches are evicted before
+        // every batch with the timer stopped (see BM_CACHE).
+        // In an open loop (see BM_ARRIVAL) the iterations are handed out one by one, each one when its
+        // time on the timeline has come. The timer keeps running while waiting.
         struct Iterator
         {
             explicit Iterator(BenchMarkState* st)
-                : cached_(st->IsSkipped() ? 0 : st->max_iterations)
+                : cached_(st->StartIterating())
                 , parent_(st)
             {
-                st->StartKeepRunning();
             }
 
         public:
             inline bool Next()
             {
-                if (cached_ == 0)
-                {
-                    parent_->FinishKeepRunning();
+                if (cached_ == 0 && (cached_ = parent_->NextIterations()) == 0)
                     return false;
-                }
                 --cached_;
                 return true;
             }
@@ -265,14 +374,131 @@ namespace BenchMark
             BenchMarkState* const parent_;
         };
 
+        // Iterator that gives every iteration its own freshly prepared input without
+        // calling PauseTiming()/ResumeTiming() per iteration. As many inputs as fit in
+        // half of L2, within the arena of this thread (see memory_required()), are prepared
+        // in one go with the timer stopped, the timed loop then consumes them one by one.
+        //
+        // Intended usage:
+        //   BM_ITERATE_BATCHED(input, sizeof(s32) * state.Range(0), prepare_unsorted)
+        //   {
+        //       std::sort((s32*)input, (s32*)input + state.Range(0));
+        //   }
+        struct BatchIterator
+        {
+            BatchIterator(BenchMarkState* st, s64 input_size, batch_prepare_function prepare);
+            ~BatchIterator();
+
+        public:
+            inline u8* Next()
+            {
+                if (cached_ == 0 && !NextBatch())
+                    return nullptr;
+                --cached_;
+                u8* input = cursor_;
+                cursor_ += input_size_;
+                return input;
+            }
+
+            // Number of inputs that are prepared per batch
+            inline s32 BatchSize() const { return batch_size_; }
+
+        private:
+            void Prepare();
+            bool NextBatch();
+
+            IterationCount         cached_;
+            IterationCount         remaining_;
+            u8*                    cursor_;
+            u8*                    inputs_;
+            s64                    input_size_;
+            s32                    batch_size_;
+            batch_prepare_function prepare_;
+            BenchMarkState* const  parent_;
+        };
+
+        struct AsyncIterator;
+
+        // Completion token of one asynchronous operation, handed out by the AsyncIterator.
+        // Done() is called exactly once, when the operation has completed.
+        struct AsyncOp
+        {
+            AsyncOp()
+                : iter_(nullptr)
+                , slot_(0)
+            {
+            }
+            AsyncOp(AsyncIterator* iter, s32 slot)
+                : iter_(iter)
+                , slot_(slot)
+            {
+            }
+
+            inline explicit operator bool() const { return iter_ != nullptr; }
+            inline void     Done() const;
+
+        private:
+            AsyncIterator* iter_;
+            s32            slot_;
+        };
+
+        // Iterator for operations that complete asynchronously, an iteration is one operation. Up to the in-flight
+        // depth of the instance (see BM_INFLIGHT) operations of this thread are in flight at the same time. Next()
+        // hands out an AsyncOp for every operation to launch and an empty one when the event loop has to be polled,
+        // the loop ends when the last operation is done. The timer keeps running while polling.
+        // In an open loop (see BM_ARRIVAL) an operation is launched when its time on the timeline has come.
+        // The latency of an operation is measured from its (intended) start to the call to Done().
+        //
+        // NOTE: Done() is to be called by the thread running the benchmark, either directly from the body
+        //       or from a completion callback (or resumed coroutine) that is run by polling the event loop.
+        //
+        // Intended usage:
+        //   BM_ITERATE_ASYNC(op, loop.RunOnce())
+        //   {
+        //       client.Send(request, [op]() { op.Done(); });
+        //   }
+        struct AsyncIterator
+        {
+            explicit AsyncIterator(BenchMarkState* st);
+            ~AsyncIterator();
+
+        public:
+            // Returns false when all operations are done, otherwise 'op' is the operation to launch or
+            // empty when nothing can be launched right now.
+            bool Next(AsyncOp& op);
+            void Done(s32 slot);
+
+            // Number of operations that can be in flight
+            inline s32 Depth() const { return depth_; }
+
+        private:
+            double*               started_;    // Start of the operation in every slot, relative to start_
+            s32*                  free_;       // Slots that are not in flight
+            s32                   free_count_; //
+            s32                   depth_;      //
+            IterationCount        remaining_;  // Operations that were not launched yet
+            IterationCount        pending_;    // Operations in flight
+            double                start_;      // Real time the first operation could be launched
+            double                next_;       // Open loop, intended start of the next operation
+            BenchMarkState* const parent_;
+        };
+
     private:
-        void StartKeepRunning();
+        void        StartKeepRunning();
+        void const* GetSharedData(shared_data_build_function build);
+
+        // Used by Iterator, returns the number of iterations to run next (0 = done)
+        IterationCount StartIterating();
+        IterationCount NextIterations();
+        IterationCount NextArrival();
+        void           WaitForArrival();
+        void           EvictCaches();
 
         // Implementation of KeepRunning() and KeepRunningBatch().
         bool KeepRunningInternal(IterationCount n, bool is_batch); // is_batch must be true unless n is 1.
         void FinishKeepRunning();
 
-        Allocator*          alloc_;
+        ForwardAllocator*   alloc_;
         const char*         name_;
         BenchMarkRunResult* results_;
 
@@ -281,11 +507,41 @@ namespace BenchMark
         ThreadTimer*   timer_;
         ThreadManager* manager_;
 
+        // Cache::Cold, every batch starts with a cold iteration followed by the warm ones
+        s32            cache_;
+        u8 const*      sweep_;           // Buffer larger than the last level cache
+        s64            sweep_size_;      //
+        IterationCount cold_batch_;      // Iterations per batch
+        IterationCount cold_remaining_;  // Iterations in the batches that did not start yet
+        IterationCount cold_pending_;    // Warm iterations of the current batch
+        IterationCount cold_running_;    // Iterations handed out last
+        double         cold_mark_;       // Real time used when they were handed out
+        bool           cold_first_;      // They are the cold iteration of a batch
+
+        // Open loop, the operations start on the timeline of this thread
+        ArrivalTimeline* timeline_;
+        double           arrival_start_;     // Real time the timeline started
+        double           arrival_intended_;  // Intended start of the running operation, relative to arrival_start_
+        IterationCount   arrival_remaining_; // Operations that did not finish yet
+
+        // Asynchronous, the operations that AsyncIterator keeps in flight and the memory for the bookkeeping
+        // of its slots, this comes from the runner so that it does not take from the arena of the benchmark
+        s32 inflight_;
+        u8* async_slots_;
+
+    public:
+        // The memory the bookkeeping of the slots of AsyncIterator needs (see InitAsync), a synchronous
+        // benchmark (inflight is 0) has one slot
+        static s64 AsyncSlotsSize(s32 inflight) { return (s64)(inflight > 0 ? inflight : 1) * (sizeof(double) + sizeof(s32)); }
+
+    private:
+
         friend class BenchMarkInstance;
     };
 
     inline bool BenchMarkState::KeepRunning() { return KeepRunningInternal(1, false); }
     inline bool BenchMarkState::KeepRunningBatch(IterationCount n) { return KeepRunningInternal(n, true); }
+    inline void BenchMarkState::AsyncOp::Done() const { iter_->Done(slot_); }
 
     inline bool BenchMarkState::KeepRunningInternal(IterationCount n, bool is_batch)
     {
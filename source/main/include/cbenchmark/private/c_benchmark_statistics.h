@@ -5,6 +5,7 @@
 #include "cbenchmark/private/c_benchmark_enums.h"
 #include "cbenchmark/private/c_benchmark_array.h"
 #include "cbenchmark/private/c_benchmark_allocators.h"
+#include "cbenchmark/private/c_benchmark_types.h"
 
 namespace BenchMark
 {
@@ -15,13 +16,86 @@ namespace BenchMark
     double StatisticsStdDev(ScratchAllocator* scratch, const Array<double>& data);
     double StatisticsCV(ScratchAllocator* scratch, const Array<double>& data);
 
+    // Single pass statistics of a metric, a value is added as it becomes known (e.g. when a repetition finishes) and
+    // whatever the number of values this takes the same memory.
+    // The mean and the variance are those of Welford. The median is exact up to 'kExactValues' values, beyond that
+    // it is the P² estimate (Jain and Chlamtac) with 5 markers that follow the quantiles 0, 1/4, 1/2, 3/4 and 1.
+    class StreamingStatistics
+    {
+    public:
+        StreamingStatistics() { Reset(); }
+
+        void Reset();
+        void Add(double value);
+
+        s64    Count() const { return count_; }
+        double Mean() const { return mean_; }
+        double Variance() const { return count_ > 1 ? m2_ / (double)(count_ - 1) : 0.0; } // Of the sample
+        double Min() const { return min_; }
+        double Max() const { return max_; }
+        double Median() const;
+
+        static const s32 kExactValues = 32;
+
+    private:
+        void StartEstimate();
+        void UpdateEstimate(double value);
+
+        s64    count_;
+        double mean_;
+        double m2_; // Sum of the squared differences from the mean
+        double min_;
+        double max_;
+        double values_[kExactValues]; // The first values (sorted), until there are more
+        double heights_[5];           // P², the markers
+        double positions_[5];         // P², where the markers are
+        double desired_[5];           // P², where the markers should be
+    };
+
+    // The streaming statistics of the repetitions of an instance, a repetition is added when it completes (see
+    // BenchMarkRunner::CompleteRepetition), a skipped one is not. ComputeStats takes the statistics from these.
+    class RepetitionStatistics
+    {
+    public:
+        RepetitionStatistics();
+        ~RepetitionStatistics() { Release(); }
+
+        void Release();
+        void Add(Allocator* allocator, BenchMarkRun const* run);
+
+        // A user counter with the statistics of its values, 'counter.value' is not used
+        struct CounterStatistics
+        {
+            Counter             counter;
+            StreamingStatistics stream;
+        };
+
+        StreamingStatistics real_time;
+        StreamingStatistics cpu_time;
+        CounterStatistics*  counters; // In the order they first appeared
+        s32                 num_counters;
+
+    private:
+        Allocator* allocator_;
+        s32        max_counters_;
+    };
+
+    double StreamingMean(const StreamingStatistics& stats);
+    double StreamingMedian(const StreamingStatistics& stats);
+    double StreamingStdDev(const StreamingStatistics& stats);
+    double StreamingCV(const StreamingStatistics& stats);
+
+    // A statistic over the repetitions of an instance, 'stream_' computes it from the streaming statistics of the
+    // repetitions. A statistic without 'stream_' (user defined) is computed by 'compute_' from all the values.
     struct Statistic
     {
         typedef double (*Func)(ScratchAllocator* scratch, const Array<double>& values);
+        typedef double (*StreamFunc)(const StreamingStatistics& stats);
 
         Statistic()
             : name_(nullptr)
             , compute_(nullptr)
+            , stream_(nullptr)
             , unit_({StatisticUnit::Time})
         {
         }
@@ -29,12 +103,22 @@ namespace BenchMark
         Statistic(const char* name, Func compute, StatisticUnit unit = {StatisticUnit::Time})
             : name_(name)
             , compute_(compute)
+            , stream_(nullptr)
+            , unit_(unit)
+        {
+        }
+
+        Statistic(const char* name, Func compute, StreamFunc stream, StatisticUnit unit)
+            : name_(name)
+            , compute_(compute)
+            , stream_(stream)
             , unit_(unit)
         {
         }
 
         const char*   name_;
         Func          compute_;
+        StreamFunc    stream_;
         StatisticUnit unit_;
     };
 
@@ -64,8 +148,9 @@ namespace BenchMark
         u32 mode;
     };
 
-    // Returns the number of reports that were aggregated into the result.
-    void ComputeStats(ForwardAllocator* alloc, ScratchAllocator* scratch, const Array<BenchMarkRun*>& reports, Array<BenchMarkRun*>& result);
+    // The aggregates of the repetitions 'reports', 'stream' holds their streaming statistics. The values of the reports
+    // are only gathered for the statistics without a streaming version.
+    void ComputeStats(ForwardAllocator* alloc, ScratchAllocator* scratch, const Array<BenchMarkRun*>& reports, RepetitionStatistics const& stream, Array<BenchMarkRun*>& result);
 
 } // namespace BenchMark
 
@@ -23,6 +23,11 @@ namespace BenchMark
     typedef void (*run_function)(BenchMarkState&, Allocator* alloc);
     typedef void (*settings_function)(BenchMarkUnit* settings);
 
+    // Suite and fixture setup/teardown run once, the data that the setup builds is
+    // shared (read-only) by all the units of that suite or fixture.
+    typedef void (*shared_setup_function)(Allocator* alloc, void*& data);
+    typedef void (*shared_teardown_function)(Allocator* alloc, void* data);
+
     struct Arg_t
     {
         Arg_t();
@@ -45,8 +50,8 @@ namespace BenchMark
 
         void SetName(char const* name);
         void AddValue(s64 value);
-        void Range(s32 lo, s32 hi, s32 multiplier = 8);
-        void DenseRange(s32 start, s32 limit, s32 step = 32);
+        void Range(s64 lo, s64 hi, s32 multiplier = 8);
+        void DenseRange(s64 start, s64 limit, s32 step = 32);
 
         char const* name_;
         s8          count_only_;
@@ -60,7 +65,8 @@ namespace BenchMark
     public:
         enum ESettings
         {
-            Max_Args = 8,
+            Max_Args            = 8,
+            Compare_Repetitions = 10, // Default repetitions of a unit in an A/B group, a pair per repetition (see BM_COMPARE)
         };
 
         TimeUnit              time_unit_;               // time unit to use for output
@@ -71,11 +77,24 @@ namespace BenchMark
         Arg_t                 args_[Max_Args];
         int                   thread_counts_size_;
         Array<s32>            thread_counts_;
+        s32                   thread_sweep_; // See ThreadSweep, replaces thread_counts_ when set
+        s32                   arrival_;      // See Arrival
+        int                   arrival_rates_size_;
+        Array<double>         arrival_rates_; // Operations per second (all threads together), an instance per rate
+        int                   inflight_size_;
+        Array<s32>            inflight_;      // Asynchronous, operations kept in flight per thread, an instance per depth
+        const char*           compare_;       // A/B group, the units of a fixture with the same group are run interleaved
         int                   range_multiplier_;
         int                   repetitions_;
         double                min_time_;
         double                min_warmup_time_;
         s64                   memory_required_;
+        s64                   shared_memory_required_;
+        u64                   seed_;        // 0 = use 'benchmark_random_interleaving_seed'
+        s32                   numa_policy_; // See NumaPolicy
+        s32                   numa_node_;   // Node for NumaPolicy::Node
+        s32                   pages_;       // See Pages
+        s32                   cache_;       // See Cache
         IterationCount        iterations_;
         s32                   counters_size_;
         Counters              counters_;
@@ -89,12 +108,13 @@ namespace BenchMark
         run_function          run_;
         // -----------------------------------------------------------------
         BenchMarkUnit* next;       // the fixture has a singly-linked list of benchmarks
+        BenchMarkUnit* family;     // BM_UNIT_TEMPLATE, the unit holding the settings of all the instantiations
         const char*    name;       // the name of the benchmark
         const char*    filename;   // the source file this benchmark was declared
         int            disabled;   // 0 = enabled, 1 = disabled, should this benchmark be run?
         int            lineNumber; // the line number in the source file
 
-        s32    BuildArgs(Allocator* alloc, Array<Array<s32>>& args);
+        s32    BuildArgs(Allocator* alloc, Array<Array<s64>>& args);
         Arg_t* Arg(s32 index);
         Arg_t* Arg(s32 index, const char* name);
 
@@ -110,9 +130,15 @@ namespace BenchMark
         void ReleaseSettings();
 
         void SetEnabled(bool enabled);
-        bool IsDisabled() const { return disabled != 0; }
+        bool IsDisabled() const { return disabled != 0 || (family != nullptr && family->disabled != 0); }
 
         void SetThreadCounts(s32 const* thread_counts, s32 thread_counts_size);
+        void SetThreadSweep(s32 sweep);
+        void SetArrival(s32 arrival);
+        void SetArrivalRates(double const* rates, s32 rates_size);
+        void SetArrivalSweep(double lo, double hi, double multi);
+        void SetInFlight(s32 const* depths, s32 depths_size);
+        void SetCompare(const char* group);
         void SetComplexity(BigO complexity);
         void SetComplexity(BigO::Func* complexity_lambda_);
         void AddCounter(const char* name, CounterFlags flags, double value = 0.0);
@@ -123,12 +149,22 @@ namespace BenchMark
         void SetMinTime(double min_time);
         void SetMinWarmupTime(double min_warmup_time);
         void SetMemoryRequired(s64 required);
+        void SetSharedMemoryRequired(s64 required);
+        void SetSeed(u64 seed);
+        void SetNuma(s32 policy, s32 node = 0);
+        void SetPages(s32 pages);
+        void SetCache(s32 cache);
         void SetIterations(IterationCount iters);
         void SetRepetitions(int repetitions);
         void SetFuncRun(run_function func);
         void SetFuncSettings(settings_function func);
 
     }; // namespace BenchMark
+
+    // BM_UNIT_TEMPLATE, writes the name of instantiation 'index' into 'name', "family<Type>" with 'types' being
+    // the type list as it was written (e.g. "u32, u64, std::string").
+    void gTemplateUnitName(char* name, s32 name_size, const char* family_name, const char* types, s32 index);
+
 } // namespace BenchMark
 
 #endif // __CBENCHMARK_BENCHMARK_UNIT_H__
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef __CBENCHMARK_FILE_H__
+#define __CBENCHMARK_FILE_H__
+
+#include "cbenchmark/private/c_types.h"
+
+namespace BenchMark
+{
+    // A file that is read at any offset and appended to, or cut back (see ResultCache and Checkpoint).
+    // A handle is -1 when the file could not be opened.
+
+    // Open (or create) the file for reading and appending
+    s64 gOpenFile(const char* path);
+
+    // Create the file for reading and appending, an existing file is truncated
+    s64 gCreateFile(const char* path);
+
+    // The size of the file in bytes, -1 on error
+    s64 gFileSize(s64 file);
+
+    // Read 'size' bytes at 'offset', returns false if the file is shorter or on error
+    bool gReadFile(s64 file, s64 offset, void* data, s64 size);
+
+    // Append 'size' bytes to the end of the file
+    bool gAppendFile(s64 file, void const* data, s64 size);
+
+    // Cut the file back to its first 'size' bytes in place, the next append goes after them
+    bool gTruncateFile(s64 file, s64 size);
+
+    void gCloseFile(s64 file);
+
+} // namespace BenchMark
+
+#endif ///< __CBENCHMARK_FILE_H__
@@ -0,0 +1,51 @@
+#ifndef __CBENCHMARK_MEMORY_H__
+#define __CBENCHMARK_MEMORY_H__
+
+#include "cbenchmark/private/c_types.h"
+
+namespace BenchMark
+{
+    // Memory for the benchmark arenas taken directly from the OS (whole pages), this gives control
+    // over the NUMA node(s) the memory is placed on and over the size of the pages.
+
+    // Returns nullptr on failure, 'size' is rounded up to whole pages. 'pages' asks for huge pages (see Pages),
+    // when those cannot be had this falls back to smaller pages. 'page_size' receives the size of the pages
+    // that were mapped, pass it back to gReleasePages.
+    // NOTE: With Pages::Transparent the kernel decides when the pages are touched, use gPageSizeOf to find out.
+    void* gAllocatePages(s64 size, s32 pages, s64& page_size);
+    void  gReleasePages(void* ptr, s64 size, s64 page_size);
+
+    // Place the pages on the NUMA node(s) given by 'numa_policy' (see NumaPolicy), this has to be done
+    // before the pages are touched. Returns false if this is not supported on this platform.
+    bool gPlacePages(void* ptr, s64 size, s32 numa_policy, s32 numa_node);
+
+    // Touch every page so that it is mapped (and placed) on the NUMA node of the calling thread
+    void gTouchPages(void* ptr, s64 size);
+
+    // The NUMA node the page at 'ptr' is on, -1 if unknown
+    s32 gNumaNodeOf(void const* ptr);
+
+    // The size of the (touched) page at 'ptr' as backed by the OS, 0 if unknown
+    s64 gPageSizeOf(void const* ptr);
+
+    // The size of the data caches of the machine, sizes[0] = L1D, sizes[1] = L2, ...
+    // Returns the number of levels that were found (0 if unknown).
+    s32 gCacheSizes(s64* sizes, s32 max_levels);
+
+    // The size of the largest cache of the machine, 32 MiB if it cannot be found
+    s64 gLastLevelCacheSize();
+
+    // The size of the L2 cache of the machine, 256 KiB if it cannot be found
+    s64 gL2CacheSize();
+
+    // Evict the cache lines of [ptr, ptr + size) from all cache levels (written back when dirty).
+    // NOTE: On architectures without a user mode flush instruction this does nothing, sweep a buffer
+    //       larger than the last level cache (gWarmCache) to push the range out instead.
+    void gFlushCache(void const* ptr, s64 size);
+
+    // Read every cache line of [ptr, ptr + size), as much of the range as fits ends up in the caches
+    void gWarmCache(void const* ptr, s64 size);
+
+} // namespace BenchMark
+
+#endif ///< __CBENCHMARK_MEMORY_H__
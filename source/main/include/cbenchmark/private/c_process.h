@@ -0,0 +1,63 @@
+#ifndef __CBENCHMARK_PROCESS_H__
+#define __CBENCHMARK_PROCESS_H__
+
+#include "cbenchmark/private/c_types.h"
+
+namespace BenchMark
+{
+    // A forked child process that runs benchmarks and sends the results to the parent over a pipe.
+    // The child is a copy of the parent, so it can use everything that was set up before the fork.
+    struct ChildProcess
+    {
+        s64 pid;
+        s32 fd; // Read end of the pipe in the parent, write end in the child
+    };
+
+    // Returns false if benchmarks cannot be run in a child process on this platform
+    bool gCanForkProcess();
+
+    // Returns 1 in the parent, 0 in the child and -1 if the child could not be created
+    s32 gForkProcess(ChildProcess& child);
+
+    // Child: write 'size' bytes to the parent, returns false if the parent is gone
+    bool gWriteToParent(ChildProcess& child, void const* data, s64 size);
+
+    // Child: close the pipe and exit the process (does not return)
+    void gExitChild(ChildProcess& child);
+
+    // Parent: read 'size' bytes from the child, returns false if the child exited or crashed
+    bool gReadFromChild(ChildProcess& child, void* data, s64 size);
+
+    // Parent: close the pipe and wait for the child, returns true if it exited normally
+    bool gWaitForChild(ChildProcess& child);
+
+    // Number of cores this process can run on, this respects the affinity mask the process was started
+    // with (e.g. taskset, cpusets) and a cgroup CPU quota.
+    s32 gNumCores();
+
+    // Number of physical cores this process can run on, the hardware threads (SMT) of a core count as one
+    s32 gNumPhysicalCores();
+
+    // Restrict this process (and the threads it creates) to the cores [first, first + count), these index
+    // the cores this process can run on. Afterwards gNumCores, gNumPhysicalCores and gPinThread only see
+    // these cores. Returns false if the platform does not support this.
+    bool gPinToCores(s32 first, s32 count);
+
+    // Restrict the calling thread to one core, 'core' indexes the cores this process can run on (and
+    // wraps around). Returns false if the platform does not support this.
+    bool gPinThread(s32 core);
+
+    // Let the calling thread run on all the cores this process can run on again
+    void gUnpinThread();
+
+    // The machine code of the function at 'address', the range of the symbol (or unwind entry) it starts.
+    // Returns false if the platform cannot tell where the function ends (e.g. a stripped executable).
+    bool gFunctionCode(void const* address, u8 const*& begin, u8 const*& end);
+
+    // A hash of what identifies the machine (host name, CPU model, number of cores, operating system),
+    // results measured on a machine with another fingerprint are not comparable.
+    u64 gMachineFingerprint();
+
+} // namespace BenchMark
+
+#endif ///< __CBENCHMARK_PROCESS_H__
@@ -37,6 +37,10 @@ namespace BenchMark
     extern void  gSetWidthFormat(char* format, int width);
     extern char* gFormatTime(double time, char* str, const char* str_end);
     extern bool  gIsZero(double n);
+
+    // FNV-1a of 'size' bytes, chained from 'seed' (kHashSeed for a new hash)
+    const u64  kHashSeed = 0xCBF29CE484222325ULL;
+    extern u64 gHash(u64 seed, void const* data, s64 size);
 } // namespace BenchMark
 
 #endif // __CBENCHMARK_UTILS_H__
@@ -5,11 +5,13 @@
 #include "cbenchmark/private/c_benchmark_unit.h"
 #include "cbenchmark/private/c_benchmark_reporter.h"
 #include "cbenchmark/private/c_benchmark_allocators.h"
+#include "cbenchmark/private/c_benchmark_generator.h"
 #include "cbenchmark/private/c_time_helpers.h"
 
 #include "cunittest/cunittest.h"
 
 #include <string>
+#include <algorithm>
 
 using namespace ncore;
 
@@ -19,8 +21,19 @@ namespace BenchMark
     {
         BM_FIXTURE(test_fixture)
         {
-            BM_FIXTURE_SETUP {}
-            BM_FIXTURE_TEARDOWN {}
+            static const s32 kMaxValues = 128;
+
+            // Called once before the first unit of this fixture, the data is read-only for the units
+            BM_FIXTURE_SETUP
+            {
+                s32* values = (s32*)allocator->Allocate(sizeof(s32) * kMaxValues);
+                for (s32 i = 0; i < kMaxValues; ++i)
+                    values[i] = (s32)((i * 2654435761u) & 0xffff);
+                data = values;
+            }
+
+            // Called once after the last unit of this fixture
+            BM_FIXTURE_TEARDOWN { allocator->Deallocate(data); }
 
             BM_FIXTURE_SETTINGS
             {
@@ -90,16 +103,24 @@ namespace BenchMark
 
             // BM_UNIT_DISABLE(memcpy);
 
+            static void BuildSource(BenchMarkState& state, Allocator* allocator, void*& data)
+            {
+                // Called once per instance by the first thread, 'allocator' is the shared arena
+                char* src = allocator->Alloc<char>(state.Range(0));
+                memset(src, 'x', state.Range(0));
+                data = src;
+            }
+
             BM_UNIT(memcpy)
             {
                 // here we have our benchmark code, for example
                 // to benchmark memcpy we can do something like this:
-                char* src = allocator->Alloc<char>(state.Range(0));
                 char* dst = allocator->Alloc<char>(state.Range(0));
 
                 // 'allocator' is available in each benchmark (thread-safe)
 
-                memset(src, 'x', state.Range(0));
+                // The source is read-only, so all threads can share the same one
+                const char* src = state.SharedData<char>(BuildSource);
 
                 // timing starts here at 'BM_ITERATE'
                 BM_ITERATE
@@ -115,9 +136,66 @@ namespace BenchMark
 
                 state.SetBytesProcessed(s64(state.Iterations()) * s64(state.Range(0)));
 
-                allocator->Dealloc(src);
                 allocator->Dealloc(dst);
             }
+
+            static void PrepareUnsorted(BenchMarkState& state, u8* inputs, s64 input_size, s32 count)
+            {
+                // 'count' inputs of state.Range(0) integers each, called with the timer stopped
+                s32 const* values = state.FixtureData<s32>();
+                for (s32 i = 0; i < count; ++i)
+                    memcpy(inputs + (i * input_size), values, input_size);
+            }
+
+            BM_UNIT(sort)
+            {
+                // Every iteration needs an unsorted array, instead of using PauseTiming/ResumeTiming
+                // in every iteration the inputs are prepared in batches.
+                BM_ITERATE_BATCHED(input, sizeof(s32) * state.Range(0), PrepareUnsorted)
+                {
+                    std::sort((s32*)input, (s32*)input + state.Range(0));
+                }
+
+                state.SetItemsProcessed(s64(state.Iterations()) * s64(state.Range(0)));
+            }
+
+            static void BuildZipfianKeys(BenchMarkState& state, Allocator* allocator, void*& data)
+            {
+                // Same keys on every run, the seed comes from BM_SEED or 'benchmark_random_interleaving_seed'
+                Generator gen(state.Seed());
+                u32*      keys = allocator->Alloc<u32>(sizeof(u32) * state.Range(1));
+                gen.Zipfian(allocator, keys, state.Range(1), state.Range(0), 0.99);
+                data = keys;
+            }
+
+            BM_UNIT(histogram)
+            {
+                // Arguments can also be accessed by their name
+                const s64 num_values = state.Arg("x");
+                const s64 num_keys   = state.Arg("y");
+
+                u32 const* keys   = state.SharedData<u32>(BuildZipfianKeys);
+                u32*       counts = allocator->Alloc<u32>(sizeof(u32) * num_values);
+
+                BM_ITERATE
+                {
+                    memset(counts, 0, sizeof(u32) * num_values);
+                    for (s64 i = 0; i < num_keys; ++i)
+                        counts[keys[i]] += 1;
+                }
+
+                state.SetItemsProcessed(s64(state.Iterations()) * num_keys);
+                state.SetComplexityN(num_values, num_keys);
+                allocator->Dealloc(counts);
+            }
+
+            BM_SETTINGS(histogram)
+            {
+                // The complexity is fitted over both arguments, the exponents show how the time scales with each of them.
+                // The arguments are summed over the threads, so the fit is done on a single thread.
+                BM_THREAD_COUNTS(1);
+                BM_COMPLEXITY(BigO::O_Auto);
+            }
         }
     }
 } // namespace BenchMark
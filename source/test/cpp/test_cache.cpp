@@ -0,0 +1,201 @@
+#include "ccore/c_target.h"
+#include "cbenchmark/private/c_benchmark_allocators.h"
+#include "cbenchmark/private/c_benchmark_array.h"
+#include "cbenchmark/private/c_benchmark_cache.h"
+#include "cbenchmark/private/c_benchmark_run.h"
+#include "cbenchmark/private/c_utils.h"
+
+#include "cunittest/cunittest.h"
+
+#include <cstdio>
+
+using namespace ncore;
+
+namespace BenchMark
+{
+    static const char* const kCacheFile = "test_cache.tmp";
+
+    // A run with every kind of field set, its strings are not owned by the run
+    static void sMakeRun(Allocator* allocator, BenchMarkRun& run, s64 repetition)
+    {
+        run.run_type              = BenchMarkRun::RT_Aggregate;
+        run.aggregate_name        = "median";
+        run.report_format         = "";
+        run.skip_message          = nullptr;
+        run.iterations            = 1000 + repetition;
+        run.threads               = 2;
+        run.repetition_index      = repetition;
+        run.repetitions           = 3;
+        run.real_accumulated_time = 0.5 + repetition;
+        run.cpu_accumulated_time  = 0.25 + repetition;
+        run.complexity_n          = 64;
+        run.complexity_m          = 8;
+        run.report_big_o          = true;
+        run.latency_p99           = 1.5e-6;
+        run.inflight              = 4;
+        run.counters.Initialize(allocator, 2);
+        run.counters.counters.PushBack({"items", {CounterFlags::IsRate}, 3.0 * repetition});
+        run.counters.counters.PushBack({"bytes", {CounterFlags::Defaults}, 7.0});
+        run.numa_nodes.Init(allocator, 0, 2);
+        run.numa_nodes.PushBack(0);
+        run.numa_nodes.PushBack(1);
+    }
+
+    static bool sSameString(const char* a, const char* b) { return (a == nullptr && b == nullptr) || (a != nullptr && b != nullptr && gAreStringsEqual(a, b)); }
+
+    static bool sSameRun(BenchMarkRun const& a, BenchMarkRun const& b)
+    {
+        bool ok = a.run_type == b.run_type && a.iterations == b.iterations && a.threads == b.threads;
+        ok      = ok && a.repetition_index == b.repetition_index && a.repetitions == b.repetitions;
+        ok      = ok && a.real_accumulated_time == b.real_accumulated_time && a.cpu_accumulated_time == b.cpu_accumulated_time;
+        ok      = ok && a.complexity_n == b.complexity_n && a.complexity_m == b.complexity_m && a.report_big_o == b.report_big_o;
+        ok      = ok && a.latency_p99 == b.latency_p99 && a.inflight == b.inflight;
+        ok      = ok && sSameString(a.aggregate_name, b.aggregate_name) && sSameString(a.report_format, b.report_format) && sSameString(a.skip_message, b.skip_message);
+        ok      = ok && a.counters.Size() == b.counters.Size() && a.numa_nodes.Size() == b.numa_nodes.Size();
+        for (s32 i = 0; ok && i < a.counters.Size(); ++i)
+        {
+            Counter const& ca = a.counters.counters[i];
+            Counter const& cb = b.counters.counters[i];
+            ok                = sSameString(ca.name, cb.name) && ca.flags == cb.flags && ca.value == cb.value;
+        }
+        for (s32 i = 0; ok && i < a.numa_nodes.Size(); ++i)
+            ok = a.numa_nodes[i] == b.numa_nodes[i];
+        return ok;
+    }
+
+    // A run persisted and restored is the same run with strings of its own, a record that is cut short is not restored
+    static bool sRoundTrip(ForwardAllocator* forward, ScratchAllocator* scratch)
+    {
+        USE_SCRATCH(scratch);
+
+        BenchMarkRun run;
+        sMakeRun(scratch, run, 1);
+
+        const s64 size   = run.PersistedSize();
+        u8*       buffer = scratch->Alloc<u8>(size);
+        bool      ok     = run.Persist(buffer, buffer + size) == buffer + size;
+        ok               = ok && run.Persist(buffer, buffer + size - 1) == nullptr;
+
+        BenchMarkRun restored;
+        ok = ok && restored.Restore(forward, buffer, buffer + size) == buffer + size;
+        ok = ok && sSameRun(run, restored) && restored.complexity_lambda == nullptr;
+        ok = ok && restored.aggregate_name != run.aggregate_name && restored.counters.counters[0].name != run.counters.counters[0].name;
+        restored.Reset();
+
+        BenchMarkRun cut;
+        ok = ok && cut.Restore(forward, buffer, buffer + size - 1) == nullptr;
+        cut.Reset();
+
+        scratch->Deallocate(buffer);
+        run.counters.Release();
+        run.numa_nodes.Release();
+        return ok;
+    }
+
+    static void sReleaseRuns(ForwardAllocator* forward, Array<BenchMarkRun*>& runs)
+    {
+        for (s32 i = 0; i < runs.Size(); ++i)
+        {
+            runs[i]->Reset();
+            forward->Destruct(runs[i]);
+        }
+        runs.Clear();
+    }
+
+    // Load the runs of 'key' from the cache in the file, they have to be the 'count' runs that were stored
+    static bool sLoads(Allocator* main, ForwardAllocator* forward, ScratchAllocator* scratch, double max_age, u64 key, s32 count)
+    {
+        ResultCache cache;
+        if (!cache.Open(main, kCacheFile, max_age))
+            return false;
+
+        Array<BenchMarkRun*> runs;
+        runs.Init(main, 0, 8);
+        bool ok = cache.Load(key, forward, scratch, count, runs) && runs.Size() == count;
+        for (s32 i = 0; ok && i < runs.Size(); ++i)
+        {
+            BenchMarkRun expected;
+            sMakeRun(main, expected, i);
+            ok = runs[i]->cached && sSameRun(expected, *runs[i]);
+            expected.counters.Release();
+            expected.numa_nodes.Release();
+        }
+        sReleaseRuns(forward, runs);
+        runs.Release();
+        cache.Close();
+        return ok;
+    }
+
+    static bool sStores(Allocator* main, ScratchAllocator* scratch, u64 key, s32 count)
+    {
+        std::remove(kCacheFile);
+
+        ResultCache cache;
+        if (!cache.Open(main, kCacheFile, 3600.0))
+            return false;
+
+        Array<BenchMarkRun*> runs;
+        runs.Init(main, 0, count);
+        for (s32 i = 0; i < count; ++i)
+        {
+            runs.PushBack(main->Construct<BenchMarkRun>());
+            sMakeRun(main, *runs[i], i);
+        }
+        cache.Store(key, scratch, runs);
+        cache.Close();
+
+        for (s32 i = 0; i < count; ++i)
+        {
+            runs[i]->Reset();
+            main->Destruct(runs[i]);
+        }
+        runs.Release();
+        return true;
+    }
+
+} // namespace BenchMark
+
+UNITTEST_SUITE_BEGIN(test_cache)
+{
+    UNITTEST_FIXTURE(persisted_runs)
+    {
+        static BenchMark::MainAllocator    sMain;
+        static BenchMark::ForwardAllocator sForward;
+        static BenchMark::ScratchAllocator sScratch;
+
+        UNITTEST_FIXTURE_SETUP()
+        {
+            sForward.Initialize(&sMain, 1024 * 1024);
+            sScratch.Initialize(&sMain, 1024 * 1024);
+        }
+        UNITTEST_FIXTURE_TEARDOWN()
+        {
+            std::remove(BenchMark::kCacheFile);
+            sScratch.Release();
+            sForward.Release();
+        }
+
+        UNITTEST_TEST(persist_restore)
+        {
+            CHECK_TRUE(BenchMark::sRoundTrip(&sForward, &sScratch));
+        }
+
+        UNITTEST_TEST(fresh_record)
+        {
+            CHECK_TRUE(BenchMark::sStores(&sMain, &sScratch, 0x5eed, 3));
+            CHECK_TRUE(BenchMark::sLoads(&sMain, &sForward, &sScratch, 3600.0, 0x5eed, 3));
+        }
+
+        UNITTEST_TEST(stale_record)
+        {
+            CHECK_TRUE(BenchMark::sStores(&sMain, &sScratch, 0x5eed, 3));
+
+            // The key of an instance whose code or settings changed, a different number of repetitions, a record
+            // that is older than the maximum age
+            CHECK_TRUE(!BenchMark::sLoads(&sMain, &sForward, &sScratch, 3600.0, 0x5eee, 3));
+            CHECK_TRUE(!BenchMark::sLoads(&sMain, &sForward, &sScratch, 3600.0, 0x5eed, 4));
+            CHECK_TRUE(!BenchMark::sLoads(&sMain, &sForward, &sScratch, -1.0, 0x5eed, 3));
+        }
+    }
+}
+UNITTEST_SUITE_END
@@ -0,0 +1,151 @@
+#include "ccore/c_target.h"
+#include "cbenchmark/private/c_benchmark_allocators.h"
+#include "cbenchmark/private/c_benchmark_array.h"
+#include "cbenchmark/private/c_benchmark_checkpoint.h"
+#include "cbenchmark/private/c_benchmark_instance.h"
+#include "cbenchmark/private/c_benchmark_run.h"
+#include "cbenchmark/private/c_benchmark_unit.h"
+#include "cbenchmark/private/c_file.h"
+
+#include "cunittest/cunittest.h"
+
+#include <cstdio>
+
+using namespace ncore;
+
+namespace BenchMark
+{
+    static const char* const kCheckpointFile = "test_checkpoint.tmp";
+
+    static BenchMarkUnit sUnitA;
+    static BenchMarkUnit sUnitB;
+
+    static void sInitInstance(ForwardAllocator* forward, BenchMarkUnit* unit, const char* name, BenchMarkInstance& instance)
+    {
+        unit->name = name;
+        Array<s64> args;
+        instance.initialize(forward, unit, args, 1, 0.0, 0, nullptr, nullptr);
+    }
+
+    static s64 sFileSize()
+    {
+        const s64 file = gOpenFile(kCheckpointFile);
+        const s64 size = gFileSize(file);
+        gCloseFile(file);
+        return size;
+    }
+
+    static bool sCutFile(s64 size)
+    {
+        const s64  file = gOpenFile(kCheckpointFile);
+        const bool ok   = gTruncateFile(file, size);
+        gCloseFile(file);
+        return ok;
+    }
+
+    // A new session with 'seed' that records 'count' repetitions of 'instance', repetition 'i' ran 100 + i iterations
+    static bool sRecord(Allocator* main, ScratchAllocator* scratch, BenchMarkInstance const* instance, s32 count, u64 seed)
+    {
+        Checkpoint checkpoint;
+        if (!checkpoint.Open(main, kCheckpointFile, false, seed))
+            return false;
+        for (s32 i = 0; i < count; ++i)
+        {
+            BenchMarkRun run;
+            run.iterations       = 100 + i;
+            run.repetition_index = i;
+            checkpoint.Record(scratch, instance, &run);
+        }
+        checkpoint.Close();
+        return true;
+    }
+
+    // Resumes the session and replays the repetitions of 'instances' in order, returns how many were replayed
+    static s32 sReplay(Allocator* main, ForwardAllocator* forward, ScratchAllocator* scratch, BenchMarkInstance const* const* instances, s32 count, u64& seed)
+    {
+        Checkpoint checkpoint;
+        if (!checkpoint.Open(main, kCheckpointFile, true, seed))
+            return -1;
+
+        s32 replayed = 0;
+        while (replayed < count)
+        {
+            BenchMarkRun run;
+            if (!checkpoint.Replay(forward, scratch, instances[replayed], &run))
+                break;
+            const bool same = run.iterations == 100 + replayed && run.repetition_index == replayed;
+            run.Reset();
+            if (!same)
+                break;
+            ++replayed;
+        }
+        checkpoint.Close();
+        return replayed;
+    }
+
+} // namespace BenchMark
+
+UNITTEST_SUITE_BEGIN(test_checkpoint)
+{
+    UNITTEST_FIXTURE(resume)
+    {
+        static BenchMark::MainAllocator     sMain;
+        static BenchMark::ForwardAllocator  sForward;
+        static BenchMark::ScratchAllocator  sScratch;
+        static BenchMark::BenchMarkInstance sA;
+        static BenchMark::BenchMarkInstance sB;
+
+        UNITTEST_FIXTURE_SETUP()
+        {
+            sForward.Initialize(&sMain, 1024 * 1024);
+            sScratch.Initialize(&sMain, 1024 * 1024);
+            BenchMark::sInitInstance(&sForward, &BenchMark::sUnitA, "a", sA);
+            BenchMark::sInitInstance(&sForward, &BenchMark::sUnitB, "b", sB);
+        }
+        UNITTEST_FIXTURE_TEARDOWN()
+        {
+            std::remove(BenchMark::kCheckpointFile);
+            sB.release(&sForward);
+            sA.release(&sForward);
+            sScratch.Release();
+            sForward.Release();
+        }
+
+        UNITTEST_TEST(truncated_record)
+        {
+            CHECK_TRUE(BenchMark::sRecord(&sMain, &sScratch, &sA, 2, 0xabcd));
+            const BenchMark::s64 two_records = BenchMark::sFileSize();
+            CHECK_TRUE(BenchMark::sRecord(&sMain, &sScratch, &sA, 3, 0xabcd));
+            const BenchMark::s64 three_records = BenchMark::sFileSize();
+            CHECK_TRUE(three_records > two_records);
+
+            // Killed while appending the last record, the resume replays the records before it, cuts the file back
+            // to them and restores the seed of the session
+            CHECK_TRUE(BenchMark::sCutFile(three_records - 5));
+
+            BenchMark::BenchMarkInstance const* instances[] = {&sA, &sA, &sA};
+            BenchMark::u64                      seed        = 0;
+            CHECK_EQUAL(2, BenchMark::sReplay(&sMain, &sForward, &sScratch, instances, 3, seed));
+            CHECK_TRUE(seed == 0xabcd);
+            CHECK_TRUE(BenchMark::sFileSize() == two_records);
+        }
+
+        UNITTEST_TEST(name_mismatch)
+        {
+            CHECK_TRUE(BenchMark::sRecord(&sMain, &sScratch, &sA, 1, 7));
+            const BenchMark::s64 one_record = BenchMark::sFileSize();
+            CHECK_TRUE(BenchMark::sRecord(&sMain, &sScratch, &sA, 3, 7));
+
+            // The schedule changed at the second repetition, the checkpoint is cut there
+            BenchMark::BenchMarkInstance const* changed[] = {&sA, &sB, &sA};
+            BenchMark::u64                      seed      = 0;
+            CHECK_EQUAL(1, BenchMark::sReplay(&sMain, &sForward, &sScratch, changed, 3, seed));
+            CHECK_TRUE(seed == 7);
+            CHECK_TRUE(BenchMark::sFileSize() == one_record);
+
+            BenchMark::BenchMarkInstance const* same[] = {&sA, &sA, &sA};
+            CHECK_EQUAL(1, BenchMark::sReplay(&sMain, &sForward, &sScratch, same, 3, seed));
+        }
+    }
+}
+UNITTEST_SUITE_END
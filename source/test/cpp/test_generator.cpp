@@ -0,0 +1,193 @@
+#include "ccore/c_target.h"
+#include "cbenchmark/private/c_benchmark_allocators.h"
+#include "cbenchmark/private/c_benchmark_generator.h"
+
+#include "cunittest/cunittest.h"
+
+#include <cmath>
+#include <cstring>
+
+using namespace ncore;
+
+namespace BenchMark
+{
+    // The requests of a session, the first of them does not end on a block of the lanes
+    static void sSession(ScratchAllocator* scratch, u64 seed, u64* values, u32* keys, s64 count)
+    {
+        Generator gen(seed);
+        const s64 split = count / 3 + 1;
+        gen.Random(values, split);
+        gen.Random(values + split, count - split);
+        gen.Uniform(keys, count, 10, 1000);
+        gen.Zipfian(scratch, keys + count, count, 1000, 0.99);
+    }
+
+    // Two generators with the same seed that get the same requests give the same values
+    static bool sSameSequence(ScratchAllocator* scratch, u64 seed, s64 count)
+    {
+        USE_SCRATCH(scratch);
+
+        u64* values_a = scratch->Alloc<u64>(sizeof(u64) * count);
+        u64* values_b = scratch->Alloc<u64>(sizeof(u64) * count);
+        u32* keys_a   = scratch->Alloc<u32>(sizeof(u32) * 2 * count);
+        u32* keys_b   = scratch->Alloc<u32>(sizeof(u32) * 2 * count);
+
+        sSession(scratch, seed, values_a, keys_a, count);
+        sSession(scratch, seed, values_b, keys_b, count);
+
+        const bool same = memcmp(values_a, values_b, sizeof(u64) * count) == 0 && memcmp(keys_a, keys_b, sizeof(u32) * 2 * count) == 0;
+        scratch->Deallocate(keys_b);
+        scratch->Deallocate(keys_a);
+        scratch->Deallocate(values_b);
+        scratch->Deallocate(values_a);
+        return same;
+    }
+
+    static bool sDifferentSeeds(ScratchAllocator* scratch, s64 count)
+    {
+        USE_SCRATCH(scratch);
+
+        u32* a = scratch->Alloc<u32>(sizeof(u32) * count);
+        u32* b = scratch->Alloc<u32>(sizeof(u32) * count);
+
+        Generator first(1);
+        first.Uniform(a, count, 0, 0xffffffff);
+        Generator second(2);
+        second.Uniform(b, count, 0, 0xffffffff);
+
+        s64 equal = 0;
+        for (s64 i = 0; i < count; ++i)
+            equal += a[i] == b[i] ? 1 : 0;
+
+        scratch->Deallocate(b);
+        scratch->Deallocate(a);
+        return equal < count / 100;
+    }
+
+    // Uniform keys stay in [lo, hi], reach both ends and their mean is the middle of the range (within a few
+    // standard errors)
+    static bool sUniformMatches(ScratchAllocator* scratch, u64 seed, s64 count, u32 lo, u32 hi)
+    {
+        USE_SCRATCH(scratch);
+
+        u32* keys = scratch->Alloc<u32>(sizeof(u32) * count);
+        Generator gen(seed);
+        gen.Uniform(keys, count, lo, hi);
+
+        bool   ok  = true;
+        u32    min = hi;
+        u32    max = lo;
+        double sum = 0.0;
+        for (s64 i = 0; i < count; ++i)
+        {
+            ok  = ok && keys[i] >= lo && keys[i] <= hi;
+            min = keys[i] < min ? keys[i] : min;
+            max = keys[i] > max ? keys[i] : max;
+            sum += keys[i];
+        }
+        scratch->Deallocate(keys);
+
+        const double range     = (double)hi - (double)lo + 1.0;
+        const double mean      = sum / (double)count;
+        const double std_error = std::sqrt((range * range - 1.0) / 12.0 / (double)count);
+        ok                     = ok && std::fabs(mean - ((double)lo + (double)hi) / 2.0) <= 5.0 * std_error;
+        ok                     = ok && (double)(min - lo) <= range / 100.0 && (double)(hi - max) <= range / 100.0;
+        return ok;
+    }
+
+    // Zipfian keys stay in [0, n), key 0 is drawn with a probability of 1 / H(n, s) and more often than key 1
+    static bool sZipfianMatches(ScratchAllocator* scratch, u64 seed, s64 count, u32 n, double s)
+    {
+        USE_SCRATCH(scratch);
+
+        u32* keys = scratch->Alloc<u32>(sizeof(u32) * count);
+        Generator gen(seed);
+        gen.Zipfian(scratch, keys, count, n, s);
+
+        bool ok    = true;
+        s64  zeros = 0;
+        s64  ones  = 0;
+        for (s64 i = 0; i < count; ++i)
+        {
+            ok = ok && keys[i] < n;
+            zeros += keys[i] == 0 ? 1 : 0;
+            ones += keys[i] == 1 ? 1 : 0;
+        }
+        scratch->Deallocate(keys);
+
+        double harmonic = 0.0;
+        for (u32 k = 0; k < n; ++k)
+            harmonic += 1.0 / std::pow((double)(k + 1), s);
+
+        const double p = 1.0 / harmonic;
+        ok             = ok && zeros > ones;
+        ok             = ok && std::fabs((double)zeros / (double)count - p) <= 5.0 * std::sqrt(p * (1.0 - p) / (double)count);
+        return ok;
+    }
+
+    static bool sSortedMatches(ScratchAllocator* scratch, u64 seed, s64 count, u32 lo, u32 hi)
+    {
+        USE_SCRATCH(scratch);
+
+        u32* keys = scratch->Alloc<u32>(sizeof(u32) * count);
+        Generator gen(seed);
+        gen.Sorted(keys, count, lo, hi);
+
+        bool ok = keys[0] >= lo && keys[count - 1] <= hi;
+        for (s64 i = 1; i < count; ++i)
+            ok = ok && keys[i - 1] <= keys[i];
+        scratch->Deallocate(keys);
+        return ok;
+    }
+
+    // Following 'next' from index 0 visits every index once before it returns to 0
+    static bool sSingleCycle(ScratchAllocator* scratch, u64 seed, s64 count)
+    {
+        USE_SCRATCH(scratch);
+
+        u32* next = scratch->Alloc<u32>(sizeof(u32) * count);
+        Generator gen(seed);
+        gen.PointerChase(next, count);
+
+        s64 steps = 0;
+        u32 index = 0;
+        do
+        {
+            index = next[index];
+            ++steps;
+        } while (index != 0 && steps <= count);
+        scratch->Deallocate(next);
+        return steps == count;
+    }
+
+} // namespace BenchMark
+
+UNITTEST_SUITE_BEGIN(test_generator)
+{
+    UNITTEST_FIXTURE(generator)
+    {
+        static BenchMark::MainAllocator    sMain;
+        static BenchMark::ScratchAllocator sScratch;
+
+        UNITTEST_FIXTURE_SETUP() { sScratch.Initialize(&sMain, 16 * 1024 * 1024); }
+        UNITTEST_FIXTURE_TEARDOWN() { sScratch.Release(); }
+
+        UNITTEST_TEST(determinism)
+        {
+            CHECK_TRUE(BenchMark::sSameSequence(&sScratch, 0x5eed, 1000));
+            CHECK_TRUE(BenchMark::sSameSequence(&sScratch, 1, 37));
+            CHECK_TRUE(BenchMark::sDifferentSeeds(&sScratch, 10000));
+        }
+
+        UNITTEST_TEST(distribution)
+        {
+            CHECK_TRUE(BenchMark::sUniformMatches(&sScratch, 0x5eed, 100000, 0, 999));
+            CHECK_TRUE(BenchMark::sUniformMatches(&sScratch, 7, 100000, 1000000, 0xffffffff));
+            CHECK_TRUE(BenchMark::sZipfianMatches(&sScratch, 0x5eed, 100000, 1000, 0.99));
+            CHECK_TRUE(BenchMark::sZipfianMatches(&sScratch, 7, 100000, 100000, 1.2));
+            CHECK_TRUE(BenchMark::sSortedMatches(&sScratch, 0x5eed, 10000, 10, 5000));
+            CHECK_TRUE(BenchMark::sSingleCycle(&sScratch, 0x5eed, 10000));
+        }
+    }
+}
+UNITTEST_SUITE_END
@@ -0,0 +1,130 @@
+#include "ccore/c_target.h"
+#include "cbenchmark/private/c_benchmark_allocators.h"
+#include "cbenchmark/private/c_benchmark_array.h"
+#include "cbenchmark/private/c_benchmark_generator.h"
+#include "cbenchmark/private/c_benchmark_run.h"
+#include "cbenchmark/private/c_benchmark_statistics.h"
+
+#include "cunittest/cunittest.h"
+
+#include <cmath>
+
+using namespace ncore;
+
+namespace BenchMark
+{
+    // Durations like samples, a floor with an exponential tail
+    static void sDurations(Allocator* allocator, Array<double>& values, s32 count, u64 seed)
+    {
+        u64* bits = allocator->Alloc<u64>(sizeof(u64) * count);
+        Generator gen(seed);
+        gen.Random(bits, count);
+        values.Init(allocator, 0, count);
+        for (s32 i = 0; i < count; ++i)
+            values.PushBack(1000.0 - 100.0 * std::log(((bits[i] >> 11) + 1) * (1.0 / 9007199254740992.0)));
+        allocator->Deallocate(bits);
+    }
+
+    // The streaming statistics of 'count' values against the exact ones, the median is exact up to 'kExactValues'
+    // values and within 'median_tolerance' (relative) of the exact one beyond that.
+    static bool sStreamingMatches(ScratchAllocator* scratch, s32 count, double median_tolerance)
+    {
+        USE_SCRATCH(scratch);
+
+        Array<double> values;
+        sDurations(scratch, values, count, 0x5eed + count);
+
+        StreamingStatistics stream;
+        for (s32 i = 0; i < values.Size(); ++i)
+            stream.Add(values[i]);
+
+        const double mean   = StatisticsMean(scratch, values);
+        const double stddev = StatisticsStdDev(scratch, values);
+        const double median = StatisticsMedian(scratch, values);
+        values.Release();
+
+        bool ok = stream.Count() == count;
+        ok      = ok && std::fabs(StreamingMean(stream) - mean) <= 1e-9 * mean;
+        ok      = ok && std::fabs(StreamingStdDev(stream) - stddev) <= 1e-6 * stddev + 1e-9;
+        if (count <= StreamingStatistics::kExactValues)
+            ok = ok && StreamingMedian(stream) == median;
+        else
+            ok = ok && std::fabs(StreamingMedian(stream) - median) <= median_tolerance * median;
+        return ok;
+    }
+
+    // The statistics of the repetitions as they complete, every repetition has a counter and one of them is skipped
+    static bool sRepetitionsMatch(ScratchAllocator* scratch, s32 count)
+    {
+        USE_SCRATCH(scratch);
+
+        Array<double> values;
+        sDurations(scratch, values, count, 0x7e9 + count);
+
+        RepetitionStatistics statistics;
+        for (s32 i = 0; i < values.Size(); ++i)
+        {
+            BenchMarkRun run;
+            run.real_accumulated_time = values[i];
+            run.cpu_accumulated_time  = values[i] / 2.0;
+            run.counters.Initialize(scratch, 1);
+            run.counters.counters.PushBack({"items", {CounterFlags::Defaults}, values[i] * 3.0});
+            if (i == count / 2)
+                run.skipped = Skipped::SkippedWithError;
+            statistics.Add(scratch, &run);
+            run.counters.Release();
+        }
+
+        // The values of the repetitions that were not skipped
+        for (s32 i = count / 2; i < count - 1; ++i)
+            values[i] = values[i + 1];
+        values.PopBack();
+
+        bool ok = statistics.real_time.Count() == count - 1 && statistics.cpu_time.Count() == count - 1;
+        ok      = ok && statistics.num_counters == 1 && statistics.counters[0].stream.Count() == count - 1;
+        ok      = ok && std::fabs(StreamingMean(statistics.real_time) - StatisticsMean(scratch, values)) <= 1e-9 * StatisticsMean(scratch, values);
+        ok      = ok && std::fabs(StreamingMean(statistics.counters[0].stream) - 3.0 * StatisticsMean(scratch, values)) <= 3e-9 * StatisticsMean(scratch, values);
+        ok      = ok && statistics.real_time.Max() == 2.0 * statistics.cpu_time.Max();
+        statistics.Release();
+        values.Release();
+        return ok;
+    }
+
+} // namespace BenchMark
+
+UNITTEST_SUITE_BEGIN(test_statistics)
+{
+    UNITTEST_FIXTURE(streaming)
+    {
+        static BenchMark::MainAllocator    sMain;
+        static BenchMark::ScratchAllocator sScratch;
+
+        UNITTEST_FIXTURE_SETUP() { sScratch.Initialize(&sMain, 16 * 1024 * 1024); }
+        UNITTEST_FIXTURE_TEARDOWN() { sScratch.Release(); }
+
+        UNITTEST_TEST(exact_values)
+        {
+            CHECK_TRUE(BenchMark::sStreamingMatches(&sScratch, 1, 0.0));
+            CHECK_TRUE(BenchMark::sStreamingMatches(&sScratch, 2, 0.0));
+            CHECK_TRUE(BenchMark::sStreamingMatches(&sScratch, 3, 0.0));
+            CHECK_TRUE(BenchMark::sStreamingMatches(&sScratch, 8, 0.0));
+            CHECK_TRUE(BenchMark::sStreamingMatches(&sScratch, BenchMark::StreamingStatistics::kExactValues - 1, 0.0));
+            CHECK_TRUE(BenchMark::sStreamingMatches(&sScratch, BenchMark::StreamingStatistics::kExactValues, 0.0));
+        }
+
+        UNITTEST_TEST(estimated_median)
+        {
+            CHECK_TRUE(BenchMark::sStreamingMatches(&sScratch, BenchMark::StreamingStatistics::kExactValues + 1, 0.02));
+            CHECK_TRUE(BenchMark::sStreamingMatches(&sScratch, 100, 0.02));
+            CHECK_TRUE(BenchMark::sStreamingMatches(&sScratch, 1000, 0.01));
+            CHECK_TRUE(BenchMark::sStreamingMatches(&sScratch, 100000, 0.005));
+        }
+
+        UNITTEST_TEST(repetitions)
+        {
+            CHECK_TRUE(BenchMark::sRepetitionsMatch(&sScratch, 5));
+            CHECK_TRUE(BenchMark::sRepetitionsMatch(&sScratch, 1000));
+        }
+    }
+}
+UNITTEST_SUITE_END
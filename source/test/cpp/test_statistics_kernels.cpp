@@ -0,0 +1,270 @@
+#include "ccore/c_target.h"
+#include "cbenchmark/cbenchmark.h"
+#include "cbenchmark/private/c_benchmark_results.h"
+#include "cbenchmark/private/c_benchmark_state.h"
+#include "cbenchmark/private/c_benchmark_unit.h"
+#include "cbenchmark/private/c_benchmark_allocators.h"
+#include "cbenchmark/private/c_benchmark_generator.h"
+#include "cbenchmark/private/c_benchmark_kernels.h"
+
+#include "cunittest/cunittest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using namespace ncore;
+
+namespace BenchMark
+{
+    // The scalar statistics kernels against the ones picked for this CPU, every unit is in an A/B group
+    // (see BM_COMPARE) so that the report shows the speed-up of the SIMD kernels.
+    struct Scalar
+    {
+        static StatisticsKernels const& Kernels() { return gScalarStatisticsKernels(); }
+
+        // The way a median was taken before, copy and partially sort
+        static double Select(Allocator* allocator, double const* data, s64 count, s64 k)
+        {
+            double* copy = allocator->Alloc<double>(sizeof(double) * count);
+            memcpy(copy, data, sizeof(double) * count);
+            std::nth_element(copy, copy + k, copy + count);
+            const double value = copy[k];
+            allocator->Deallocate(copy);
+            return value;
+        }
+    };
+
+    struct Dispatched
+    {
+        static StatisticsKernels const& Kernels() { return gStatisticsKernels(); }
+
+        static double Select(Allocator* allocator, double const* data, s64 count, s64 k) { return gStatisticsSelect(allocator, Kernels(), data, count, k); }
+    };
+
+    static volatile double sSink;
+
+    BM_SUITE(statistics_kernels)
+    {
+        BM_FIXTURE(kernels)
+        {
+            static const s64 kMaxValues = 1 << 20;
+
+            // Durations like samples, a floor with an exponential tail
+            BM_FIXTURE_SETUP
+            {
+                u64*      bits   = allocator->Alloc<u64>(sizeof(u64) * kMaxValues);
+                double*   values = (double*)bits;
+                Generator gen(0x5eed);
+                gen.Random(bits, kMaxValues);
+                for (s64 i = 0; i < kMaxValues; ++i)
+                {
+                    const double u = ((bits[i] >> 11) + 1) * (1.0 / 9007199254740992.0);
+                    values[i]      = 1000.0 - 100.0 * std::log(u);
+                }
+                data = values;
+            }
+
+            BM_FIXTURE_TEARDOWN { allocator->Deallocate(data); }
+
+            BM_FIXTURE_SETTINGS
+            {
+                BM_ARG_NAME(0, "n")->SEQUENCE(4096, 65536, 1 << 20);
+                BM_TIMEUNIT(TimeUnit::Microsecond);
+                BM_MINTIME(0.05);
+            }
+
+            BM_UNIT_TEMPLATE(sum, K, Scalar, Dispatched)
+            {
+                double const* values = state.FixtureData<double>();
+                BM_ITERATE { sSink = K::Kernels().sum(values, state.Range(0)); }
+                state.SetItemsProcessed(s64(state.Iterations()) * state.Range(0));
+            }
+            BM_SETTINGS(sum) { BM_COMPARE("sum"); }
+
+            BM_UNIT_TEMPLATE(sum_squares, K, Scalar, Dispatched)
+            {
+                double const* values = state.FixtureData<double>();
+                BM_ITERATE { sSink = K::Kernels().sum_squares(values, state.Range(0)); }
+                state.SetItemsProcessed(s64(state.Iterations()) * state.Range(0));
+            }
+            BM_SETTINGS(sum_squares) { BM_COMPARE("sum_squares"); }
+
+            BM_UNIT_TEMPLATE(min_max, K, Scalar, Dispatched)
+            {
+                double const* values = state.FixtureData<double>();
+                BM_ITERATE
+                {
+                    double lo, hi;
+                    K::Kernels().min_max(values, state.Range(0), lo, hi);
+                    sSink = hi - lo;
+                }
+                state.SetItemsProcessed(s64(state.Iterations()) * state.Range(0));
+            }
+            BM_SETTINGS(min_max) { BM_COMPARE("min_max"); }
+
+            BM_UNIT_TEMPLATE(histogram, K, Scalar, Dispatched)
+            {
+                static const s32 kBuckets = 256;
+
+                double const* values = state.FixtureData<double>();
+                u64*          counts = allocator->Alloc<u64>(sizeof(u64) * kBuckets);
+                BM_ITERATE
+                {
+                    memset(counts, 0, sizeof(u64) * kBuckets);
+                    K::Kernels().histogram(values, state.Range(0), 1000.0, kBuckets / 1000.0, counts, kBuckets);
+                }
+                state.SetItemsProcessed(s64(state.Iterations()) * state.Range(0));
+                allocator->Deallocate(counts);
+            }
+            BM_SETTINGS(histogram) { BM_COMPARE("histogram"); }
+
+            // The median, copy + nth_element against the histogram narrowing
+            BM_UNIT_TEMPLATE(select, K, Scalar, Dispatched)
+            {
+                double const*    values = state.FixtureData<double>();
+                ScratchAllocator scratch;
+                scratch.Initialize(allocator, 2 * sizeof(double) * state.Range(0));
+                BM_ITERATE
+                {
+                    ScratchAllocator* iteration = &scratch;
+                    USE_SCRATCH(iteration);
+                    sSink = K::Select(iteration, values, state.Range(0), state.Range(0) / 2);
+                }
+                state.SetItemsProcessed(s64(state.Iterations()) * state.Range(0));
+                scratch.Release();
+            }
+            BM_SETTINGS(select)
+            {
+                BM_MEMORY_REQUIRED(4 * sizeof(double) * (1 << 20));
+                BM_COMPARE("select");
+            }
+        }
+    }
+
+    // Both NaN, or the same but for the last bits
+    static bool sClose(double simd, double scalar) { return (std::isnan(simd) && std::isnan(scalar)) || std::fabs(simd - scalar) <= 1e-12 * std::fabs(scalar); }
+
+    // The kernels picked for this CPU against the scalar ones, on 'count' durations like samples with a NaN at
+    // every 'nan_every' (0 is none). The sums differ in the last bits, the rest has to be the same.
+    static bool sKernelsMatch(Allocator* allocator, s64 count, s64 nan_every)
+    {
+        u64*      bits   = allocator->Alloc<u64>(sizeof(u64) * count);
+        double*   values = (double*)bits;
+        Generator gen(0x5eed + count);
+        gen.Random(bits, count);
+        for (s64 i = 0; i < count; ++i)
+            values[i] = 1000.0 - 100.0 * std::log(((bits[i] >> 11) + 1) * (1.0 / 9007199254740992.0));
+        for (s64 i = nan_every / 2; nan_every > 0 && i < count; i += nan_every)
+            values[i] = std::nan("");
+
+        StatisticsKernels const& scalar = gScalarStatisticsKernels();
+        StatisticsKernels const& simd   = gStatisticsKernels();
+
+        bool ok = sClose(simd.sum(values, count), scalar.sum(values, count));
+        ok      = ok && sClose(simd.sum_squares(values, count), scalar.sum_squares(values, count));
+
+        double lo_scalar, hi_scalar, lo_simd, hi_simd;
+        scalar.min_max(values, count, lo_scalar, hi_scalar);
+        simd.min_max(values, count, lo_simd, hi_simd);
+        ok = ok && lo_scalar == lo_simd && hi_scalar == hi_simd;
+
+        static const s32 kBuckets = 61;
+        u64              counts_scalar[kBuckets];
+        u64              counts_simd[kBuckets];
+        memset(counts_scalar, 0, sizeof(counts_scalar));
+        memset(counts_simd, 0, sizeof(counts_simd));
+        const double scale = lo_scalar < hi_scalar ? kBuckets / (hi_scalar - lo_scalar) : 1.0;
+        scalar.histogram(values, count, lo_scalar, scale, counts_scalar, kBuckets);
+        simd.histogram(values, count, lo_scalar, scale, counts_simd, kBuckets);
+        ok = ok && memcmp(counts_scalar, counts_simd, sizeof(counts_scalar)) == 0;
+
+        allocator->Deallocate(bits);
+        return ok;
+    }
+
+    // gStatisticsSelect against nth_element on 'count' values with 'unique' different values (0 is all different),
+    // with 'special' (e.g. an infinity or a NaN) at every 'special_every' (0 is none)
+    static bool sSelectMatches(Allocator* allocator, s64 count, s64 unique, double special = 0.0, s64 special_every = 0)
+    {
+        u64*      bits   = allocator->Alloc<u64>(sizeof(u64) * count);
+        double*   values = (double*)bits;
+        Generator gen(0x5e1ec7 + count);
+        gen.Random(bits, count);
+        for (s64 i = 0; i < count; ++i)
+        {
+            const double value = 1000.0 - 100.0 * std::log(((bits[i] >> 11) + 1) * (1.0 / 9007199254740992.0));
+            values[i]          = unique > 0 ? (double)((s64)value % unique) : value;
+        }
+        for (s64 i = special_every / 2; special_every > 0 && i < count; i += special_every)
+            values[i] = special;
+
+        ScratchAllocator scratch;
+        scratch.Initialize(allocator, 2 * sizeof(double) * count + (1 << 16));
+
+        bool      ok   = true;
+        s64 const ks[] = {0, 1, count / 3, count / 2, count - 2, count - 1};
+        for (s32 i = 0; i < (s32)(sizeof(ks) / sizeof(ks[0])); ++i)
+        {
+            ScratchAllocator* select = &scratch;
+            USE_SCRATCH(select);
+            ok = ok && Dispatched::Select(select, values, count, ks[i]) == Scalar::Select(select, values, count, ks[i]);
+        }
+
+        scratch.Release();
+        allocator->Deallocate(bits);
+        return ok;
+    }
+} // namespace BenchMark
+
+UNITTEST_SUITE_BEGIN(test_statistics_kernels)
+{
+    UNITTEST_FIXTURE(simd_versus_scalar)
+    {
+        static BenchMark::MainAllocator sAllocator;
+
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        // Counts with a tail (count % 8 != 0) that the kernels finish in scalar code
+        UNITTEST_TEST(kernels)
+        {
+            CHECK_TRUE(BenchMark::sKernelsMatch(&sAllocator, 1, 0));
+            CHECK_TRUE(BenchMark::sKernelsMatch(&sAllocator, 7, 0));
+            CHECK_TRUE(BenchMark::sKernelsMatch(&sAllocator, 15, 0));
+            CHECK_TRUE(BenchMark::sKernelsMatch(&sAllocator, 37, 0));
+            CHECK_TRUE(BenchMark::sKernelsMatch(&sAllocator, 1021, 0));
+            CHECK_TRUE(BenchMark::sKernelsMatch(&sAllocator, 65539, 0));
+        }
+
+        UNITTEST_TEST(kernels_with_nan)
+        {
+            CHECK_TRUE(BenchMark::sKernelsMatch(&sAllocator, 1, 1));
+            CHECK_TRUE(BenchMark::sKernelsMatch(&sAllocator, 7, 3));
+            CHECK_TRUE(BenchMark::sKernelsMatch(&sAllocator, 37, 5));
+            CHECK_TRUE(BenchMark::sKernelsMatch(&sAllocator, 1021, 1021));
+            CHECK_TRUE(BenchMark::sKernelsMatch(&sAllocator, 65539, 97));
+        }
+
+        UNITTEST_TEST(select)
+        {
+            CHECK_TRUE(BenchMark::sSelectMatches(&sAllocator, 13, 0));
+            CHECK_TRUE(BenchMark::sSelectMatches(&sAllocator, 4097, 0));
+            CHECK_TRUE(BenchMark::sSelectMatches(&sAllocator, 65539, 0));
+            CHECK_TRUE(BenchMark::sSelectMatches(&sAllocator, 65539, 7));
+            CHECK_TRUE(BenchMark::sSelectMatches(&sAllocator, 1000003, 0));
+        }
+
+        // The histograms cannot narrow these down
+        UNITTEST_TEST(select_inf_nan)
+        {
+            const double inf = std::numeric_limits<double>::infinity();
+            CHECK_TRUE(BenchMark::sSelectMatches(&sAllocator, 5000, 0, inf, 5000));
+            CHECK_TRUE(BenchMark::sSelectMatches(&sAllocator, 65539, 0, -inf, 101));
+            CHECK_TRUE(BenchMark::sSelectMatches(&sAllocator, 5000, 0, std::nan(""), 5000));
+            CHECK_TRUE(BenchMark::sSelectMatches(&sAllocator, 65539, 7, std::nan(""), 13));
+        }
+    }
+}
+UNITTEST_SUITE_END